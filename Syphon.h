@@ -28,11 +28,17 @@
  */
 
 #import <Syphon/SyphonServerDirectory.h>
+#import <Syphon/SyphonPixelFormat.h>
+#import <Syphon/SyphonFrameMetadata.h>
 #import <Syphon/SyphonMetalServer.h>
+#import <Syphon/SyphonCPUServer.h>
+#import <Syphon/SyphonServerPublishGroup.h>
 #import <Syphon/SyphonMetalClient.h>
 #import <Syphon/SyphonOpenGLServer.h>
 #import <Syphon/SyphonOpenGLClient.h>
 #import <Syphon/SyphonOpenGLImage.h>
+#import <Syphon/SyphonCPUClient.h>
+#import <Syphon/SyphonCPUImage.h>
 
 /*
  Deprecated headers
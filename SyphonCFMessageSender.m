@@ -99,17 +99,8 @@
     SyphonDispatchSourceRelease(_dispatch);
 }
 
-- (void)send:(id <NSCoding>)payload ofType:(uint32_t)type
+- (void)sendEncodedPayload:(NSData *)encoded ofType:(uint32_t)type
 {
-	NSData *encoded;
-	if (payload)
-	{
-		encoded = [NSKeyedArchiver archivedDataWithRootObject:payload requiringSecureCoding:YES error:nil];
-	}
-	else
-	{
-		encoded = nil;
-	}
 	[_queue queue:encoded ofType:type];
 	SyphonDispatchSourceFire(_dispatch);
 }
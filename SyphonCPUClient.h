@@ -0,0 +1,82 @@
+/*
+    SyphonCPUClient.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <Foundation/Foundation.h>
+#import <Syphon/SyphonClientBase.h>
+#import <Syphon/SyphonCPUImage.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ A client which gives access to frames from a server as pixels in memory, for applications which encode, analyze or otherwise process frames on the CPU. Every ``SyphonPixelFormat`` is supported, and frames are not converted: check the ``SyphonCPUImage/pixelFormat`` of each image.
+ */
+@interface SyphonCPUClient : SyphonClientBase
+
+/*!
+ Returns a new client instance for the described server. You should check the isValid property after initialization to ensure a connection was made to the server.
+ @param description Typically acquired from the shared SyphonServerDirectory, or one of Syphon's notifications.
+ @param options A dictionary containing key-value pairs to specify options for the client. Currently supported options are SyphonClientOptionPixelFormats, SyphonClientOptionFrameHistoryLength, SyphonClientOptionPresentationDelay and SyphonClientOptionReleasesFrames. May be nil.
+ @param handler A block which is invoked when a new frame becomes available. handler may be nil. This block may be invoked on a thread other than that on which the client was created.
+ @returns A newly initialized SyphonCPUClient object, or nil if a client could not be created.
+*/
+- (instancetype)initWithServerDescription:(NSDictionary<NSString *, id> *)description
+                                  options:(nullable NSDictionary<NSString *, id> *)options
+                          newFrameHandler:(nullable void (^)(SyphonCPUClient *client))handler;
+
+/*!
+ Returns a ``SyphonCPUImage`` giving access to the current output from the server. The image's pixels may continue to update, but you should not depend on that behaviour: call this method every time you wish to access the current server frame, and see ``SyphonCPUImage`` for how to detect a frame changing while you read it.
+
+ @returns A ``SyphonCPUImage`` representing the live output from the server. YOU ARE RESPONSIBLE FOR RELEASING THIS OBJECT when you are finished with it.
+ */
+- (nullable SyphonCPUImage *)newFrameImage;
+
+/*!
+ Returns a ``SyphonCPUImage`` for the frame to present at the given time, chosen from the client's frame history (see ``SyphonClientOptionFrameHistoryLength``). Frames are chosen so that playout is smooth when the server publishes at a different or irregular rate: the newest frame due by the time is returned, and a frame may be returned for several calls until the next is due. Without a history, this returns the current frame. ``SyphonClientBase/frameMetadata`` describes the frame returned.
+
+ @param time The time the frame will be presented, on the clock used by ``SyphonFrameTimestampNow()``, for instance the time a display link will show your next frame.
+ @returns A ``SyphonCPUImage``, or `nil` if no frame is available. YOU ARE RESPONSIBLE FOR RELEASING THIS OBJECT when you are finished with it.
+ */
+- (nullable SyphonCPUImage *)newFrameImageForPresentationTime:(uint64_t)time;
+
+/*!
+ Returns a ``SyphonCPUImage`` for the current output of each of the server's streams (see ``SyphonClientBase/streamNames``), in order. The server publishes a frame for every stream together, and the images belong to the same set of frames. For a server with a single stream, the array contains the same frame as ``newFrameImage``.
+
+ @returns An array of ``SyphonCPUImage``, one for each stream, or `nil` if a frame isn't available for every stream. YOU ARE RESPONSIBLE FOR RELEASING THIS OBJECT when you are finished with it.
+ */
+- (nullable NSArray<SyphonCPUImage *> *)newFrameImagesForStreams;
+
+/*!
+ Stops the client from receiving any further frames from the server. Use of this method is optional and releasing all references to the client has the same effect.
+ */
+- (void)stop;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,147 @@
+/*
+    SyphonCPUClient.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SyphonCPUClient.h"
+#import "SyphonSubclassing.h"
+#import <os/lock.h>
+#import <stdatomic.h>
+
+@implementation SyphonCPUClient
+{
+    os_unfair_lock  _threadLock;
+    SyphonCPUImage  *_frame;
+    atomic_bool     _frameValid;
+}
+
+@dynamic isValid, serverDescription, hasNewFrame;
+
++ (NSArray<NSNumber *> *)supportedPixelFormats
+{
+    return @[@(SyphonPixelFormatBGRA8), @(SyphonPixelFormatRGBA16Float), @(SyphonPixelFormatRGB10A2), @(SyphonPixelFormatYCbCr420)];
+}
+
+- (instancetype)initWithServerDescription:(NSDictionary<NSString *, id> *)description
+                                  options:(NSDictionary<NSString *, id> *)options
+                          newFrameHandler:(void (^)(SyphonCPUClient *client))handler
+{
+    self = [super initWithServerDescription:description options:options newFrameHandler:handler];
+    if (self)
+    {
+        _threadLock = OS_UNFAIR_LOCK_INIT;
+        atomic_store(&_frameValid, false);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+}
+
+- (void)stop
+{
+    os_unfair_lock_lock(&_threadLock);
+    atomic_store(&_frameValid, false);
+    _frame = nil;
+    os_unfair_lock_unlock(&_threadLock);
+    [super stop];
+}
+
+- (void)invalidateFrame
+{
+    /*
+     DO NOT take the lock here, it may already be locked and waiting for the SyphonClientConnectionManager lock
+     */
+    atomic_store(&_frameValid, false);
+}
+
+- (SyphonCPUImage *)newFrameImage
+{
+    [self updateFrameID];
+
+    os_unfair_lock_lock(&_threadLock);
+    if (atomic_load(&_frameValid) == false)
+    {
+        _frame = nil;
+
+        IOSurfaceRef surface = [self newSurface];
+        if (surface != nil)
+        {
+            _frame = [[SyphonCPUImage alloc] initWithSurface:surface];
+            CFRelease(surface);
+        }
+
+        atomic_store(&_frameValid, true);
+    }
+
+    SyphonCPUImage *image = _frame;
+
+    os_unfair_lock_unlock(&_threadLock);
+
+    return image;
+}
+
+- (SyphonCPUImage *)newFrameImageForPresentationTime:(uint64_t)time
+{
+    // Frames from the history are often not the current frame, so aren't cached
+    IOSurfaceRef surface = [self newSurfaceForPresentationTime:time];
+    if (surface == NULL)
+    {
+        return nil;
+    }
+    SyphonCPUImage *image = [[SyphonCPUImage alloc] initWithSurface:surface];
+    CFRelease(surface);
+    return image;
+}
+
+- (NSArray<SyphonCPUImage *> *)newFrameImagesForStreams
+{
+    NSUInteger count = MAX(self.streamNames.count, 1U);
+    IOSurfaceRef *surfaces = calloc(count, sizeof(IOSurfaceRef));
+    NSUInteger available = [self getRetainedSurfaces:surfaces count:count];
+    NSMutableArray<SyphonCPUImage *> *images = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        if (surfaces[i])
+        {
+            [images addObject:[[SyphonCPUImage alloc] initWithSurface:surfaces[i]]];
+            CFRelease(surfaces[i]);
+        }
+    }
+    free(surfaces);
+    // A partial set would pair frames which don't belong together
+    if (available != count || images.count != count)
+    {
+        return nil;
+    }
+    return images;
+}
+
+@end
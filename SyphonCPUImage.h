@@ -0,0 +1,81 @@
+/*
+    SyphonCPUImage.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <Foundation/Foundation.h>
+#import <Syphon/SyphonImageBase.h>
+#import <Syphon/SyphonPixelFormat.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ SyphonCPUImage gives read-only access to the pixels of a frame in memory.
+
+ The image's memory is shared with the server, which may publish a new frame into it at any time, including while you are reading. To read pixels, call ``lockForReading``, read them using the addresses returned by ``baseAddressOfPlane:bytesPerRow:``, then call ``unlock``. If ``unlock`` returns `NO` the server wrote to the image while you were reading and you should discard what you read, and if you wish, try again.
+ */
+@interface SyphonCPUImage : SyphonImageBase
+
+/**
+ A NSSize representing the dimensions of the image in pixels.
+ */
+@property (readonly) NSSize size;
+
+/**
+ The format of the image's pixels.
+ */
+@property (readonly) SyphonPixelFormat pixelFormat;
+
+/**
+ The number of planes in the image: 2 for ``SyphonPixelFormatYCbCr420``, which has a luma plane followed by an interleaved chroma plane, and 1 for other formats.
+ */
+@property (readonly) NSUInteger planeCount;
+
+/**
+ Makes the image's pixels available for reading. You must pair this with a call to ``unlock``.
+ @returns `YES` if the pixels may be read, `NO` otherwise, in which case you should not read pixels or call ``unlock``.
+ */
+- (BOOL)lockForReading;
+
+/**
+ Returns the address of a plane of the image. Only valid between calls to ``lockForReading`` and ``unlock``.
+ @param plane The index of the plane.
+ @param bytesPerRow On return, the distance in bytes between the start of each row. Rows are ordered top to bottom.
+ @returns The address of the first row of the plane, or `NULL` if the image isn't locked or there is no such plane.
+ */
+- (nullable const void *)baseAddressOfPlane:(NSUInteger)plane bytesPerRow:(size_t *)bytesPerRow;
+
+/**
+ Ends reading the image's pixels.
+ @returns `YES` if the pixels were unchanged while the image was locked, `NO` if the server wrote to the image in that time.
+ */
+- (BOOL)unlock;
+
+@end
+
+NS_ASSUME_NONNULL_END
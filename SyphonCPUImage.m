@@ -0,0 +1,136 @@
+/*
+    SyphonCPUImage.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SyphonCPUImage.h"
+#import <IOSurface/IOSurface.h>
+#import <os/lock.h>
+
+@implementation SyphonCPUImage
+{
+    IOSurfaceRef _surface;
+    os_unfair_lock _lock;
+    NSUInteger _lockCount;
+    uint32_t _lockSeed;
+}
+
+- (id)initWithSurface:(IOSurfaceRef)surfaceRef
+{
+    self = [super initWithSurface:surfaceRef];
+    if (self)
+    {
+        _surface = (IOSurfaceRef)CFRetain(surfaceRef);
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    while (_lockCount > 0)
+    {
+        IOSurfaceUnlock(_surface, kIOSurfaceLockReadOnly, NULL);
+        _lockCount--;
+    }
+    CFRelease(_surface);
+}
+
+- (NSSize)size
+{
+    return NSMakeSize(IOSurfaceGetWidth(_surface), IOSurfaceGetHeight(_surface));
+}
+
+- (SyphonPixelFormat)pixelFormat
+{
+    return IOSurfaceGetPixelFormat(_surface);
+}
+
+- (NSUInteger)planeCount
+{
+    size_t count = IOSurfaceGetPlaneCount(_surface);
+    return count == 0 ? 1 : count;
+}
+
+- (BOOL)lockForReading
+{
+    /*
+     The surface's seed changes each time the server finishes writing to it. We record it when we lock, and the
+     image was overwritten mid-read if it differs when we unlock.
+     */
+    uint32_t seed;
+    if (IOSurfaceLock(_surface, kIOSurfaceLockReadOnly, &seed) != kIOReturnSuccess)
+    {
+        return NO;
+    }
+    os_unfair_lock_lock(&_lock);
+    if (_lockCount == 0)
+    {
+        _lockSeed = seed;
+    }
+    _lockCount++;
+    os_unfair_lock_unlock(&_lock);
+    return YES;
+}
+
+- (const void *)baseAddressOfPlane:(NSUInteger)plane bytesPerRow:(size_t *)bytesPerRow
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL locked = _lockCount > 0;
+    os_unfair_lock_unlock(&_lock);
+    if (!locked || plane >= self.planeCount)
+    {
+        return NULL;
+    }
+    if (IOSurfaceGetPlaneCount(_surface) == 0)
+    {
+        *bytesPerRow = IOSurfaceGetBytesPerRow(_surface);
+        return IOSurfaceGetBaseAddress(_surface);
+    }
+    *bytesPerRow = IOSurfaceGetBytesPerRowOfPlane(_surface, plane);
+    return IOSurfaceGetBaseAddressOfPlane(_surface, plane);
+}
+
+- (BOOL)unlock
+{
+    uint32_t seed;
+    if (IOSurfaceUnlock(_surface, kIOSurfaceLockReadOnly, &seed) != kIOReturnSuccess)
+    {
+        return NO;
+    }
+    os_unfair_lock_lock(&_lock);
+    BOOL unchanged = _lockCount > 0 && seed == _lockSeed;
+    if (_lockCount > 0)
+    {
+        _lockCount--;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return unchanged;
+}
+
+@end
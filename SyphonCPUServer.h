@@ -0,0 +1,135 @@
+/*
+    SyphonCPUServer.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <Foundation/Foundation.h>
+#import <Syphon/SyphonServerBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ A server handles the publishing of frames from one video source to any number of clients.
+
+ Frames are published from memory, with no need for a GPU context. Frames can be published either by passing in pixels, which are copied, or by calling ``beginFrameOfSize:`` to obtain the memory of the server's next frame, writing pixels into it, then calling ``endFrameAndPublish``, which avoids a copy.
+
+ Pixels must be in the server's ``SyphonServerBase/pixelFormat``, which is set using ``SyphonServerOptionPixelFormat``. Every ``SyphonPixelFormat`` is supported. Frames in ``SyphonPixelFormatYCbCr420`` have two planes: the luma plane followed by the interleaved chroma plane. Other formats have one plane.
+
+If the server is created with ``SyphonServerOptionTileSize``, each frame is split into tiles, which are published separately and copied only while they have clients. Tiled servers must publish frames using ``publishFrameBytes:bytesPerRow:size:flipped:`` or ``publishFrameBytes:bytesPerRow:size:dirtyRects:count:flipped:``, and can't be used with ``beginFrameOfSize:``.
+
+ If the server is created with ``SyphonServerOptionStreamNames``, it publishes a frame for each of its streams together, using ``publishStreamFrames:bytesPerRow:sizes:flipped:``. Other methods publish only the first stream.
+
+ Each server represents one video output for your application. If your application produces several video outputs, then they should each have their own server. If your application might have multiple servers running, you should name each server to aid identification by users.
+
+ It is safe to access instances of this class across threads, except that a call to ``beginFrameOfSize:`` must have returned before a call is made to ``endFrameAndPublish``, and these methods must be paired and called in order.
+ */
+@interface SyphonCPUServer : SyphonServerBase
+
+/*!
+ Creates a new server with the specified human-readable name (which need not be unique) and options. The server will be started immediately. Init may fail and return `nil` if the server could not be started.
+
+ @param name Non-unique human readable server name. This is not required and may be `nil`, but is usually used by clients in their UI to aid identification.
+ @param options A dictionary containing key-value pairs to specify options for the server. Currently supported options are ``SyphonServerOptionIsPrivate``, ``SyphonServerOptionPixelFormat``, ``SyphonServerOptionTileSize``, ``SyphonServerOptionStreamNames``, ``SyphonServerOptionSurfaceCount`` and ``SyphonServerOptionTracksFrameReleases``. See their descriptions for details.
+ @returns A newly intialized ``SyphonCPUServer``. `nil` on failure.
+ */
+- (nullable instancetype)initWithName:(nullable NSString *)name options:(nullable NSDictionary<NSString *, id> *)options NS_DESIGNATED_INITIALIZER;
+
+/*!
+ Publishes a frame in a single plane of memory to clients. The pixels are copied and can be safely modified once this method has returned. This method can't be used for servers publishing ``SyphonPixelFormatYCbCr420``: use ``publishFramePlanes:bytesPerRow:size:flipped:`` instead.
+
+ @param bytes The first row of pixels.
+ @param bytesPerRow The distance in bytes between the start of each row.
+ @param size The dimensions of the frame in pixels.
+ @param isFlipped `YES` if the rows are ordered bottom to top.
+ */
+- (void)publishFrameBytes:(const void *)bytes bytesPerRow:(size_t)bytesPerRow size:(NSSize)size flipped:(BOOL)isFlipped;
+
+/*!
+ Publishes a frame in a single plane of memory to clients, with the regions which changed since the previous frame. Clients receive the regions as the frame's dirty rects, and a tiled server copies and publishes only the tiles they touch. The pixels are copied and can be safely modified once this method has returned. This method can't be used for servers publishing ``SyphonPixelFormatYCbCr420``.
+
+ @param bytes The first row of pixels.
+ @param bytesPerRow The distance in bytes between the start of each row.
+ @param size The dimensions of the frame in pixels.
+ @param dirtyRects The regions of the frame which changed since the previous frame, in pixels, where the origin is the first pixel of the row at bytes. Pass `NULL` if the entire frame may have changed.
+ @param count The number of rects in dirtyRects.
+ @param isFlipped `YES` if the rows are ordered bottom to top.
+ */
+- (void)publishFrameBytes:(const void *)bytes bytesPerRow:(size_t)bytesPerRow size:(NSSize)size dirtyRects:(nullable const NSRect *)dirtyRects count:(NSUInteger)count flipped:(BOOL)isFlipped;
+
+/*!
+ Publishes a frame in one or more planes of memory to clients. The pixels are copied and can be safely modified once this method has returned.
+
+ @param planes An array of pointers to the first row of each plane, with one entry for each plane of the server's pixel format.
+ @param bytesPerRow An array of the distance in bytes between the start of each row, with one entry for each plane.
+ @param size The dimensions of the frame in pixels.
+ @param isFlipped `YES` if the rows are ordered bottom to top.
+ */
+- (void)publishFramePlanes:(const void * _Nonnull const * _Nonnull)planes bytesPerRow:(const size_t *)bytesPerRow size:(NSSize)size flipped:(BOOL)isFlipped;
+
+/*!
+ Publishes a frame for each of the server's streams (see ``SyphonServerOptionStreamNames``) to clients, together, so that clients never receive a frame from one stream without the frames which accompany it. The pixels are copied and can be safely modified once this method has returned. This method can't be used for servers publishing ``SyphonPixelFormatYCbCr420``.
+
+ @param bytes An array of pointers to the first row of pixels of each stream's frame, with one entry for each of the server's ``SyphonServerBase/streamNames``, or one entry if it has a single stream.
+ @param bytesPerRow An array of the distance in bytes between the start of each row, with one entry for each stream.
+ @param sizes An array of the dimensions of each stream's frame in pixels, with one entry for each stream.
+ @param isFlipped `YES` if the rows are ordered bottom to top.
+ */
+- (void)publishStreamFrames:(const void * _Nonnull const * _Nonnull)bytes bytesPerRow:(const size_t *)bytesPerRow sizes:(const NSSize *)sizes flipped:(BOOL)isFlipped;
+
+/*!
+ Prepares the server's next frame for you to write pixels directly into it. If this returns `YES`, use ``baseAddressOfPlane:bytesPerRow:`` to find where to write each plane, then call ``endFrameAndPublish`` once you have finished. If `NO` is returned you should not write pixels or call ``endFrameAndPublish``.
+
+ The previous contents of the frame are undefined: you must write every pixel. Clients may not see the frame until it has been published. Sizes are rounded down to whole pixels, as they are by the other publishing methods, and `NO` is returned if that leaves less than one pixel in either dimension. Tiled servers always return `NO`.
+
+ @param size The dimensions of the frame in pixels.
+ @returns `YES` if the frame is ready to be written, `NO` otherwise.
+ */
+- (BOOL)beginFrameOfSize:(NSSize)size;
+
+/*!
+ Returns the address of a plane of the frame being written. Only valid between calls to ``beginFrameOfSize:`` and ``endFrameAndPublish``.
+
+ @param plane The index of the plane: 0 for all formats except ``SyphonPixelFormatYCbCr420``, which has planes 0 and 1.
+ @param bytesPerRow On return, the distance in bytes between the start of each row. Rows are ordered top to bottom.
+ @returns The address of the first row of the plane, or `NULL` if there is no frame being written or no such plane.
+ */
+- (nullable void *)baseAddressOfPlane:(NSUInteger)plane bytesPerRow:(size_t *)bytesPerRow;
+
+/*!
+ Publishes the frame written since the call to ``beginFrameOfSize:``.
+ */
+- (void)endFrameAndPublish;
+
+/*!
+ Stops the server instance. Use of this method is optional and releasing all references to the server has the same effect.
+ */
+- (void)stop;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,362 @@
+/*
+    SyphonCPUServer.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SyphonCPUServer.h"
+#import "SyphonPrivate.h"
+#import "SyphonSubclassing.h"
+#import "SyphonPixelKernels.h"
+#import "SyphonServerTile.h"
+#import <IOSurface/IOSurface.h>
+
+static size_t SyphonCPUServerPlaneCount(IOSurfaceRef surface)
+{
+    size_t count = IOSurfaceGetPlaneCount(surface);
+    return count == 0 ? 1 : count;
+}
+
+static void *SyphonCPUServerPlaneAddress(IOSurfaceRef surface, size_t plane, size_t *bytesPerRow, size_t *rowLength, size_t *rows)
+{
+    if (IOSurfaceGetPlaneCount(surface) == 0)
+    {
+        *bytesPerRow = IOSurfaceGetBytesPerRow(surface);
+        *rowLength = IOSurfaceGetWidth(surface) * IOSurfaceGetBytesPerElement(surface);
+        *rows = IOSurfaceGetHeight(surface);
+        return IOSurfaceGetBaseAddress(surface);
+    }
+    *bytesPerRow = IOSurfaceGetBytesPerRowOfPlane(surface, plane);
+    *rowLength = IOSurfaceGetWidthOfPlane(surface, plane) * IOSurfaceGetBytesPerElementOfPlane(surface, plane);
+    *rows = IOSurfaceGetHeightOfPlane(surface, plane);
+    return IOSurfaceGetBaseAddressOfPlane(surface, plane);
+}
+
+/*
+ Rounds size down to whole pixels, as surfaces have, returning NO if that leaves less than a pixel in either
+ dimension or more than a surface can have. Written so NaN fails too, and so conversions to size_t are defined.
+ */
+static BOOL SyphonCPUServerFrameSize(NSSize size, NSSize *result)
+{
+    size = NSMakeSize(floor(size.width), floor(size.height));
+    if (!(size.width >= 1 && size.height >= 1 && size.width <= UINT32_MAX && size.height <= UINT32_MAX))
+    {
+        return NO;
+    }
+    *result = size;
+    return YES;
+}
+
+@implementation SyphonCPUServer
+{
+    IOSurfaceRef _frameSurface; // only set between -beginFrameOfSize: and -endFrameAndPublish
+}
+
+- (instancetype)initWithName:(NSString *)name options:(NSDictionary<NSString *,id> *)options
+{
+    self = [super initWithName:name options:options];
+    return self;
+}
+
++ (BOOL)drawsEachFrameToNewSurface
+{
+    return YES;
+}
+
+- (void)dealloc
+{
+    if (_frameSurface)
+    {
+        IOSurfaceUnlock(_frameSurface, 0, NULL);
+        CFRelease(_frameSurface);
+    }
+}
+
+- (void)publishFrameBytes:(const void *)bytes bytesPerRow:(size_t)bytesPerRow size:(NSSize)size flipped:(BOOL)isFlipped
+{
+    if (self.pixelFormat == SyphonPixelFormatYCbCr420)
+    {
+        SYPHONLOG(@"publishFrameBytes:bytesPerRow:size:flipped: can't be used for multi-planar formats");
+        return;
+    }
+    [self publishFramePlanes:&bytes bytesPerRow:&bytesPerRow size:size flipped:isFlipped];
+}
+
+- (void)publishFrameBytes:(const void *)bytes bytesPerRow:(size_t)bytesPerRow size:(NSSize)size dirtyRects:(const NSRect *)dirtyRects count:(NSUInteger)count flipped:(BOOL)isFlipped
+{
+    if (self.pixelFormat == SyphonPixelFormatYCbCr420)
+    {
+        SYPHONLOG(@"publishFrameBytes:bytesPerRow:size:dirtyRects:count:flipped: can't be used for multi-planar formats");
+        return;
+    }
+    if (!SyphonCPUServerFrameSize(size, &size))
+    {
+        return;
+    }
+    @synchronized (self) {
+        NSRect *rects = NULL;
+        if (dirtyRects && count)
+        {
+            rects = malloc(sizeof(NSRect) * count);
+            count = SyphonDirtyRectsToSurface(dirtyRects, count, NSMakeRect(0, 0, size.width, size.height), isFlipped, rects);
+            if (count == 0)
+            {
+                // Nothing changed
+                free(rects);
+                return;
+            }
+        }
+        else
+        {
+            count = 0;
+        }
+        if (self.tileSize.width >= 1)
+        {
+            [self publishTilesFromBytes:bytes bytesPerRow:bytesPerRow size:size dirtyRects:rects count:count flipped:isFlipped];
+        }
+        else if ([self beginFrameOfSize:size])
+        {
+            size_t dstBytesPerRow, rowLength, rows;
+            void *dst = SyphonCPUServerPlaneAddress(_frameSurface, 0, &dstBytesPerRow, &rowLength, &rows);
+            SyphonPixelCopyPlane(dst, dstBytesPerRow, bytes, bytesPerRow, rowLength, rows, isFlipped);
+            SyphonFrameMetadata metadata = [self metadataForNewFrame];
+            SyphonFrameMetadataSetDirtyRects(&metadata, rects, count);
+            IOSurfaceUnlock(_frameSurface, 0, NULL);
+            CFRelease(_frameSurface);
+            _frameSurface = NULL;
+            [self publishWithFrameMetadata:metadata];
+        }
+        free(rects);
+    }
+}
+
+/*
+ Copies the tiles which changed and have clients from a frame, and publishes them. rects are in surface coordinates.
+ */
+- (void)publishTilesFromBytes:(const void *)bytes bytesPerRow:(size_t)bytesPerRow size:(NSSize)size dirtyRects:(const NSRect *)rects count:(NSUInteger)count flipped:(BOOL)isFlipped
+{
+    NSArray<SyphonServerTile *> *tiles = [self tilesForCanvasSize:size];
+    SyphonFrameMetadata metadata = [self metadataForNewFrame];
+    metadata.sequence = [self nextFrameSequence];
+    metadata.publishTime = SyphonFrameTimestampNow();
+    if (metadata.captureTime == 0)
+    {
+        metadata.captureTime = metadata.publishTime;
+    }
+    size_t bytesPerPixel = SyphonPixelFormatBitsPerPixel(self.pixelFormat) / 8;
+    NSRect *tileRects = count ? malloc(sizeof(NSRect) * count) : NULL;
+    for (SyphonServerTile *tile in tiles)
+    {
+        // Find the changes within this tile, in its own coordinates
+        NSRect tileRect = tile.rect;
+        NSUInteger tileCount = 0;
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            NSRect rect = NSIntersectionRect(rects[i], tileRect);
+            if (!NSIsEmptyRect(rect))
+            {
+                tileRects[tileCount++] = NSOffsetRect(rect, -tileRect.origin.x, -tileRect.origin.y);
+            }
+        }
+        BOOL needsRedraw = tile.needsRedraw;
+        if (count != 0 && tileCount == 0 && !needsRedraw)
+        {
+            continue;
+        }
+        if (!tile.hasClients)
+        {
+            // Nobody will see the change now, but clients which connect later must
+            tile.needsRedraw = YES;
+            continue;
+        }
+        BOOL isNew;
+        IOSurfaceRef surface = [tile newSurfaceIsNew:&isNew];
+        if (surface == NULL)
+        {
+            continue;
+        }
+        if (IOSurfaceLock(surface, 0, NULL) == kIOReturnSuccess)
+        {
+            if (isNew || needsRedraw)
+            {
+                tileCount = 0;
+            }
+            NSRect whole = NSMakeRect(0, 0, tileRect.size.width, tileRect.size.height);
+            size_t dstBytesPerRow = IOSurfaceGetBytesPerRow(surface);
+            uint8_t *dstBase = IOSurfaceGetBaseAddress(surface);
+            for (NSUInteger i = 0; i < MAX(tileCount, 1U); i++)
+            {
+                NSRect rect = tileCount ? tileRects[i] : whole;
+                size_t x = tileRect.origin.x + rect.origin.x;
+                size_t y = tileRect.origin.y + rect.origin.y;
+                size_t width = rect.size.width;
+                size_t height = rect.size.height;
+                // Flipped frames have the canvas' last row first
+                size_t srcY = isFlipped ? (size_t)size.height - y - height : y;
+                uint8_t *dst = dstBase + ((size_t)rect.origin.y * dstBytesPerRow) + ((size_t)rect.origin.x * bytesPerPixel);
+                SyphonPixelCopyRegion(dst, dstBytesPerRow, bytes, bytesPerRow, bytesPerPixel, x, srcY, width, height, isFlipped);
+            }
+            IOSurfaceUnlock(surface, 0, NULL);
+            tile.needsRedraw = NO;
+            SyphonFrameMetadata tileMetadata = metadata;
+            SyphonFrameMetadataSetDirtyRects(&tileMetadata, tileRects, tileCount);
+            [tile publishWithFrameMetadata:tileMetadata];
+        }
+        CFRelease(surface);
+    }
+    free(tileRects);
+}
+
+- (void)publishFramePlanes:(const void * const *)planes bytesPerRow:(const size_t *)bytesPerRow size:(NSSize)size flipped:(BOOL)isFlipped
+{
+    if (self.tileSize.width >= 1)
+    {
+        [self publishFrameBytes:planes[0] bytesPerRow:bytesPerRow[0] size:size dirtyRects:NULL count:0 flipped:isFlipped];
+        return;
+    }
+    @synchronized (self) {
+        if (![self beginFrameOfSize:size])
+        {
+            return;
+        }
+        size_t count = SyphonCPUServerPlaneCount(_frameSurface);
+        for (size_t plane = 0; plane < count; plane++)
+        {
+            size_t dstBytesPerRow, rowLength, rows;
+            void *dst = SyphonCPUServerPlaneAddress(_frameSurface, plane, &dstBytesPerRow, &rowLength, &rows);
+            SyphonPixelCopyPlane(dst, dstBytesPerRow, planes[plane], bytesPerRow[plane], rowLength, rows, isFlipped);
+        }
+        [self endFrameAndPublish];
+    }
+}
+
+- (void)publishStreamFrames:(const void * const *)bytes bytesPerRow:(const size_t *)bytesPerRow sizes:(const NSSize *)sizes flipped:(BOOL)isFlipped
+{
+    if (self.pixelFormat == SyphonPixelFormatYCbCr420)
+    {
+        SYPHONLOG(@"publishStreamFrames:bytesPerRow:sizes:flipped: can't be used for multi-planar formats");
+        return;
+    }
+    NSUInteger count = MAX(self.streamNames.count, 1U);
+    @synchronized (self) {
+        if (_frameSurface)
+        {
+            return;
+        }
+        NSSize size;
+        for (NSUInteger stream = 0; stream < count; stream++)
+        {
+            if (!SyphonCPUServerFrameSize(sizes[stream], &size))
+            {
+                return;
+            }
+        }
+        // Streams are written in place, so every surface is obtained and locked before any is written: otherwise a
+        // failure part way would leave clients with a set mixing new and old frames
+        IOSurfaceRef *surfaces = calloc(count, sizeof(IOSurfaceRef));
+        if (surfaces == NULL)
+        {
+            return;
+        }
+        NSUInteger locked = 0;
+        while (locked < count)
+        {
+            SyphonCPUServerFrameSize(sizes[locked], &size);
+            IOSurfaceRef surface = [self newSurfaceForStream:locked width:(size_t)size.width height:(size_t)size.height];
+            if (surface == NULL)
+            {
+                break;
+            }
+            if (IOSurfaceLock(surface, 0, NULL) != kIOReturnSuccess)
+            {
+                CFRelease(surface);
+                break;
+            }
+            surfaces[locked++] = surface;
+        }
+        BOOL complete = locked == count;
+        for (NSUInteger stream = 0; stream < locked; stream++)
+        {
+            if (complete)
+            {
+                size_t dstBytesPerRow, rowLength, rows;
+                void *dst = SyphonCPUServerPlaneAddress(surfaces[stream], 0, &dstBytesPerRow, &rowLength, &rows);
+                SyphonPixelCopyPlane(dst, dstBytesPerRow, bytes[stream], bytesPerRow[stream], rowLength, rows, isFlipped);
+            }
+            IOSurfaceUnlock(surfaces[stream], 0, NULL);
+            CFRelease(surfaces[stream]);
+        }
+        free(surfaces);
+        if (complete)
+        {
+            [self publish];
+        }
+    }
+}
+
+- (BOOL)beginFrameOfSize:(NSSize)size
+{
+    if (_frameSurface || !SyphonCPUServerFrameSize(size, &size) || self.tileSize.width >= 1)
+    {
+        return NO;
+    }
+    IOSurfaceRef surface = [self newSurfaceForWidth:(size_t)size.width height:(size_t)size.height options:nil];
+    if (surface)
+    {
+        // Locking for writing makes our writes visible to clients and increments the surface's seed when we unlock
+        if (IOSurfaceLock(surface, 0, NULL) == kIOReturnSuccess)
+        {
+            _frameSurface = surface;
+            return YES;
+        }
+        CFRelease(surface);
+    }
+    return NO;
+}
+
+- (void *)baseAddressOfPlane:(NSUInteger)plane bytesPerRow:(size_t *)bytesPerRow
+{
+    if (_frameSurface == NULL || plane >= SyphonCPUServerPlaneCount(_frameSurface))
+    {
+        return NULL;
+    }
+    size_t rowLength, rows;
+    return SyphonCPUServerPlaneAddress(_frameSurface, plane, bytesPerRow, &rowLength, &rows);
+}
+
+- (void)endFrameAndPublish
+{
+    if (_frameSurface)
+    {
+        IOSurfaceUnlock(_frameSurface, 0, NULL);
+        CFRelease(_frameSurface);
+        _frameSurface = NULL;
+        [self publish];
+    }
+}
+
+@end
@@ -28,14 +28,52 @@
 */
 
 #import <Foundation/Foundation.h>
+#import <Syphon/SyphonPixelFormat.h>
+#import <Syphon/SyphonFrameMetadata.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
+/*!
+ @relates SyphonClientBase
+ If this key is matched with a NSArray of NSNumbers with SyphonPixelFormat values, the client will only connect to a server publishing one of those formats. Where a server offers several, the client chooses the one which uses the least memory bandwidth. Formats the client class is unable to present are ignored. By default a client accepts every format its class supports.
+ */
+extern NSString * const SyphonClientOptionPixelFormats;
+
+/*!
+ @relates SyphonClientBase
+ If this key is matched with a NSNumber with a BOOL value YES, and the server publishes a preview (see SyphonServerOptionPreviewScale), the client receives the server's reduced preview frames in place of its full-size frames. If the server has no preview, the client receives full-size frames. Default is NO.
+ */
+extern NSString * const SyphonClientOptionPreview;
+
+/*!
+ @relates SyphonClientBase
+ If this key is matched with a NSNumber with an unsigned integer value, and the server publishes its frames as tiles (see SyphonServerOptionTileSize), the client receives only the tile at that index in the server description's SyphonServerDescriptionTilesKey array. Initialization fails if the server has no such tile. Default is to receive entire frames.
+ */
+extern NSString * const SyphonClientOptionTileIndex;
+
+/*!
+ @relates SyphonClientBase
+ If this key is matched with a NSNumber with an unsigned integer value, a client created with a new frame handler keeps up to that many of the most recent frames, up to 32, so that a frame suited to a particular presentation time can be chosen (see getFrameHistory:count: and the newFrameImageForPresentationTime: method of subclasses). Frames are not copied, so a frame is only kept until the server draws over it: servers created with SyphonServerOptionSurfaceCount keep that many frames, while servers with a single surface, such as SyphonMetalServer and SyphonOpenGLServer, keep only the latest. Default is 0, for no history.
+ */
+extern NSString * const SyphonClientOptionFrameHistoryLength;
+
+/*!
+ @relates SyphonClientBase
+ If this key is matched with a NSNumber with an unsigned long long value, a client with a frame history (see SyphonClientOptionFrameHistoryLength) chooses frames for a presentation time from those captured that many nanoseconds earlier. A longer delay smooths playout when frames arrive irregularly, at the cost of latency. Default is the average interval between recent frames.
+ */
+extern NSString * const SyphonClientOptionPresentationDelay;
+
+/*!
+ @relates SyphonClientBase
+ If this key is matched with a NSNumber with a BOOL value YES, and the server tracks frame releases (see SyphonServerOptionTracksFrameReleases), a client created with a new frame handler tells the server which frames it is reading, from when it receives a frame until it releases it with releaseFrameSequence:. The server then avoids drawing over those frames where it can, and may skip or delay frames while the client holds them, so a client with this option must release every frame it receives. Default is NO.
+ */
+extern NSString * const SyphonClientOptionReleasesFrames;
+
 @interface SyphonClientBase : NSObject
 /*!
  Returns a new client instance for the described server. You should check the isValid property after initialization to ensure a connection was made to the server.
  @param description Typically acquired from the shared SyphonServerDirectory, or one of Syphon's notifications.
- @param options Currently ignored. May be nil.
+ @param options A dictionary containing key-value pairs to specify options for the client. Currently supported options are SyphonClientOptionPixelFormats, SyphonClientOptionPreview, SyphonClientOptionTileIndex, SyphonClientOptionFrameHistoryLength, SyphonClientOptionPresentationDelay and SyphonClientOptionReleasesFrames, plus any added by the subclass. May be nil.
  @param handler A block which is invoked when a new frame becomes available. handler may be nil. This block may be invoked on a thread other than that on which the client was created.
  @returns A newly initialized SyphonClientBase object, or nil if a client could not be created.
 */
@@ -46,6 +84,16 @@ NS_ASSUME_NONNULL_BEGIN
 */
 @property (readonly) NSDictionary<NSString *, id> *serverDescription;
 
+/*!
+ The format of frames received from the server.
+ */
+@property (readonly) SyphonPixelFormat pixelFormat;
+
+/*!
+ The names of the streams published by the server, in order, if it publishes several (see SyphonServerOptionStreamNames). Subclasses which support streams give access to a frame from each, all published together. Empty if the server publishes a single stream.
+ */
+@property (readonly) NSArray<NSString *> *streamNames;
+
 /*!
  A client is valid if it has a working connection to a server. Once this returns NO, the SyphonClient will not yield any further frames.
  */
@@ -62,6 +110,25 @@ NS_ASSUME_NONNULL_BEGIN
  Returns YES if the server has output a new frame since the last time newFrameImage was called for this client, NO otherwise.
 */
 @property (readonly) BOOL hasNewFrame;
+
+/*!
+ Information which accompanied the frame most recently returned by newFrameImage. Metadata is only delivered to clients created with a new frame handler, and is zeroed for other clients and for servers using older versions of Syphon.
+ */
+@property (readonly) SyphonFrameMetadata frameMetadata;
+
+/*!
+ Copies information about the frames in the client's history (see SyphonClientOptionFrameHistoryLength), newest first. Only frames which the server hasn't since drawn over are included.
+ @param metadata An array with space for count SyphonFrameMetadata, which on return holds the information for each frame.
+ @param count The greatest number of frames to return.
+ @returns The number of frames placed in metadata.
+ */
+- (NSUInteger)getFrameHistory:(SyphonFrameMetadata *)metadata count:(NSUInteger)count;
+
+/*!
+ Tells the server the client has finished reading the frame with the given sequence number (see SyphonFrameMetadata), and every earlier frame, so the server may draw over them. Has no effect unless the client was created with SyphonClientOptionReleasesFrames and the server tracks releases.
+ @param sequence The sequence number from the frameMetadata of the last frame the client has finished with.
+ */
+- (void)releaseFrameSequence:(uint64_t)sequence;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -31,17 +31,57 @@
 #import "SyphonServerDirectory.h"
 #import "SyphonClientConnectionManager.h"
 #import "SyphonPrivate.h"
+#import "SyphonFence.h"
 #import <os/lock.h>
 
-// TODO: name?
-static void *SyphonClientServersContext = &SyphonClientServersContext;
+#define kSyphonClientMaxFrameHistoryLength 32U
+
+/*
+ A frame kept in a client's history. The surface's seed changes when the server draws to it again, after which the
+ frame is gone: servers with several surfaces (see SyphonServerOptionSurfaceCount) keep a frame for longer.
+ */
+typedef struct SyphonClientHistoryFrame {
+    IOSurfaceRef surface;
+    uint32_t seed;
+    NSUInteger frameID;
+    SyphonFrameMetadata metadata;
+} SyphonClientHistoryFrame;
+
+/*
+ Returns a copy of description with the UUID and surfaces of a preview or tile dictionary, or nil if it lacks them.
+ */
+static NSDictionary<NSString *, id> *SyphonClientSubstreamDescription(NSDictionary<NSString *, id> *description, NSDictionary<NSString *, id> *substream)
+{
+    if (![substream isKindOfClass:[NSDictionary class]]
+        || ![substream objectForKey:SyphonServerDescriptionUUIDKey]
+        || ![substream objectForKey:SyphonServerDescriptionSurfacesKey])
+    {
+        return nil;
+    }
+    NSMutableDictionary<NSString *, id> *result = [description mutableCopy];
+    [result setObject:[substream objectForKey:SyphonServerDescriptionUUIDKey] forKey:SyphonServerDescriptionUUIDKey];
+    [result setObject:[substream objectForKey:SyphonServerDescriptionSurfacesKey] forKey:SyphonServerDescriptionSurfacesKey];
+    return result;
+}
 
 @implementation SyphonClientBase {
     os_unfair_lock                  _lock;
     NSUInteger                      _lastFrameID;
+    SyphonFrameMetadata             _frameMetadata;
     SyphonClientConnectionManager   *_connectionManager;
     NSDictionary<NSString *, id>    *_serverDescription;
+    SyphonPixelFormat               _pixelFormat;
     void                            (^_handler)(id);
+    id                              _directoryObserver;
+    SyphonClientHistoryFrame        *_history; // guarded by _lock, as are the following
+    NSUInteger                      _historyLength;
+    NSUInteger                      _historyCount;
+    NSUInteger                      _historyNext;
+    uint64_t                        _presentationDelay;
+    BOOL                            _hasPresentationDelay;
+    IOSurfaceRef                    _fenceSurface; // guarded by _lock, as are the following
+    SyphonFenceRef                  _fence;
+    int32_t                         _fenceSlot;
 }
 
 + (BOOL)automaticallyNotifiesObserversForKey:(NSString *)theKey
@@ -56,6 +96,11 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
     }
 }
 
++ (NSArray<NSNumber *> *)supportedPixelFormats
+{
+    return @[@(SyphonPixelFormatBGRA8)];
+}
+
 - (id)init
 {
     // Returns nil
@@ -71,15 +116,77 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
     {
         _lock = OS_UNFAIR_LOCK_INIT;
 
-        _connectionManager = [[SyphonClientConnectionManager alloc] initWithServerDescription:description];
-
         _handler = [handler copy]; // copy don't retain
         _serverDescription = description;
 
-        [[SyphonServerDirectory sharedDirectory] addObserver:self
-                                                  forKeyPath:@"servers"
-                                                     options:NSKeyValueObservingOptionInitial | NSKeyValueObservingOptionNew
-                                                     context:SyphonClientServersContext];
+        // Only clients with a handler are told of every frame, so only they can keep a history
+        NSNumber *historyLength = [options objectForKey:SyphonClientOptionFrameHistoryLength];
+        if (handler && [historyLength respondsToSelector:@selector(unsignedIntegerValue)] && [historyLength unsignedIntegerValue] > 0)
+        {
+            _historyLength = MIN([historyLength unsignedIntegerValue], kSyphonClientMaxFrameHistoryLength);
+            _history = calloc(_historyLength, sizeof(SyphonClientHistoryFrame));
+        }
+        NSNumber *delay = [options objectForKey:SyphonClientOptionPresentationDelay];
+        if ([delay respondsToSelector:@selector(unsignedLongLongValue)])
+        {
+            _presentationDelay = [delay unsignedLongLongValue];
+            _hasPresentationDelay = YES;
+        }
+
+        // A preview or tile is connected to as though it were the server, but changes to the server are still observed below
+        NSDictionary<NSString *, id> *connectTo = description;
+        NSNumber *wantsPreview = [options objectForKey:SyphonClientOptionPreview];
+        NSNumber *tileIndex = [options objectForKey:SyphonClientOptionTileIndex];
+        if ([tileIndex respondsToSelector:@selector(unsignedIntegerValue)])
+        {
+            NSArray *tiles = [description objectForKey:SyphonServerDescriptionTilesKey];
+            if (![tiles isKindOfClass:[NSArray class]] || [tileIndex unsignedIntegerValue] >= tiles.count)
+            {
+                return nil;
+            }
+            connectTo = SyphonClientSubstreamDescription(description, [tiles objectAtIndex:[tileIndex unsignedIntegerValue]]);
+        }
+        else if ([wantsPreview respondsToSelector:@selector(boolValue)] && [wantsPreview boolValue]
+                 && [description objectForKey:SyphonServerDescriptionPreviewKey])
+        {
+            connectTo = SyphonClientSubstreamDescription(description, [description objectForKey:SyphonServerDescriptionPreviewKey]);
+        }
+        if (!connectTo)
+        {
+            return nil;
+        }
+
+        // Only clients with a handler receive frame sequences, and previews and tiles are drawn over regardless
+        _fenceSlot = -1;
+        NSNumber *releasesFrames = [options objectForKey:SyphonClientOptionReleasesFrames];
+        NSNumber *fenceID = [description objectForKey:SyphonServerDescriptionFenceKey];
+        if (handler && connectTo == description
+            && [releasesFrames respondsToSelector:@selector(boolValue)] && [releasesFrames boolValue]
+            && [fenceID respondsToSelector:@selector(unsignedIntValue)])
+        {
+            [self attachFence:[fenceID unsignedIntValue]];
+        }
+
+        _connectionManager = [[SyphonClientConnectionManager alloc] initWithServerDescription:connectTo];
+
+        NSArray<NSNumber *> *acceptedFormats = [[self class] supportedPixelFormats];
+        NSArray<NSNumber *> *requestedFormats = [options objectForKey:SyphonClientOptionPixelFormats];
+        if ([requestedFormats isKindOfClass:[NSArray class]])
+        {
+            acceptedFormats = [acceptedFormats filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF IN %@", requestedFormats]];
+        }
+        NSDictionary *surface = SyphonSurfaceDescriptionChoose([connectTo objectForKey:SyphonServerDescriptionSurfacesKey], acceptedFormats);
+        _pixelFormat = SyphonSurfaceDescriptionGetPixelFormat(surface);
+
+        NSString *uuid = [description objectForKey:SyphonServerDescriptionUUIDKey];
+        if (uuid)
+        {
+            __weak SyphonClientBase *weakSelf = self;
+            _directoryObserver = [[SyphonServerDirectory sharedDirectory] addObserverForServerUUID:uuid
+                                                                                        usingBlock:^(NSDictionary<NSString *,id<NSCoding>> *changed) {
+                [weakSelf serverDescriptionDidChange:changed];
+            }];
+        }
 
         [_connectionManager addInfoClient:(id <SyphonInfoReceiving>)self
                             isFrameClient:handler != nil ? YES : NO];
@@ -87,6 +194,7 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
         NSNumber *dictionaryVersion = [description objectForKey:SyphonServerDescriptionDictionaryVersionKey];
         if (dictionaryVersion == nil
             || [dictionaryVersion unsignedIntValue] > kSyphonDictionaryVersion
+            || surface == nil
             || _connectionManager == nil)
         {
             return nil;
@@ -106,8 +214,12 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
 - (void) dealloc
 {
     // Don't call anything in the subclass, it has already been dealloc'd
-    [[SyphonServerDirectory sharedDirectory] removeObserver:self forKeyPath:@"servers"];
+    if (_directoryObserver)
+    {
+        [[SyphonServerDirectory sharedDirectory] removeServerObserver:_directoryObserver];
+    }
     [self stopBase];
+    free(_history);
 }
 
 - (void)stop
@@ -124,6 +236,24 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
                                isFrameClient:_handler != nil ? YES : NO];
         _connectionManager = nil;
     }
+    for (NSUInteger i = 0; i < _historyLength; i++)
+    {
+        if (_history[i].surface)
+        {
+            CFRelease(_history[i].surface);
+            _history[i].surface = NULL;
+        }
+    }
+    _historyCount = 0;
+    if (_fenceSurface)
+    {
+        SyphonFenceReleaseSlot(_fence, _fenceSlot);
+        IOSurfaceUnlock(_fenceSurface, 0, NULL);
+        CFRelease(_fenceSurface);
+        _fenceSurface = NULL;
+        _fence = NULL;
+        _fenceSlot = -1;
+    }
     os_unfair_lock_unlock(&_lock);
 }
 
@@ -140,6 +270,26 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
     // Nothing for us to do, subclasses will usually override this
 }
 
+- (SyphonPixelFormat)pixelFormat
+{
+    return _pixelFormat;
+}
+
+- (NSArray<NSString *> *)streamNames
+{
+    NSArray<NSString *> *names = [self.serverDescription objectForKey:SyphonServerDescriptionStreamsKey];
+    return [names isKindOfClass:[NSArray class]] ? names : @[];
+}
+
+- (SyphonFrameMetadata)frameMetadata
+{
+    SyphonFrameMetadata result;
+    os_unfair_lock_lock(&_lock);
+    result = _frameMetadata;
+    os_unfair_lock_unlock(&_lock);
+    return result;
+}
+
 - (BOOL)hasNewFrame
 {
     BOOL result;
@@ -158,32 +308,17 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
 }
 
 #pragma mark Changes
-- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary<NSString *,id> *)change context:(void *)context
+- (void)serverDescriptionDidChange:(NSDictionary<NSString *, id> *)description
 {
-    if (context == SyphonClientServersContext)
-    {
-        NSUInteger kind = [change[NSKeyValueChangeKindKey] unsignedIntegerValue];
-        if (kind == NSKeyValueChangeSetting || kind == NSKeyValueChangeReplacement)
-        {
-            NSArray *servers = change[NSKeyValueChangeNewKey];
-            NSString *uuid = _serverDescription[SyphonServerDescriptionUUIDKey];
-            for (NSDictionary *description in servers) {
-                if ([description[SyphonServerDescriptionUUIDKey] isEqualToString:uuid] &&
-                    ![_serverDescription isEqualToDictionary:description])
-                {
-                    [self willChangeValueForKey:@"serverDescription"];
-                    NSDictionary *copied = [description copy];
-                    os_unfair_lock_lock(&_lock);
-                    _serverDescription = copied;
-                    os_unfair_lock_unlock(&_lock);
-                    [self didChangeValueForKey:@"serverDescription"];
-                }
-            }
-        }
-    }
-    else
+    // Retirement (a nil description) is handled by the connection manager
+    if (description && ![_serverDescription isEqualToDictionary:description])
     {
-        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        [self willChangeValueForKey:@"serverDescription"];
+        NSDictionary *copied = [description copy];
+        os_unfair_lock_lock(&_lock);
+        _serverDescription = copied;
+        os_unfair_lock_unlock(&_lock);
+        [self didChangeValueForKey:@"serverDescription"];
     }
 }
 
@@ -191,6 +326,11 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
 {
     os_unfair_lock_lock(&_lock);
     _lastFrameID = [_connectionManager frameID];
+    _frameMetadata = [_connectionManager frameMetadata];
+    if (_fence)
+    {
+        SyphonFenceBeginFrame(_fence, _fenceSlot, _frameMetadata.sequence);
+    }
     os_unfair_lock_unlock(&_lock);
 }
 
@@ -204,4 +344,148 @@ static void *SyphonClientServersContext = &SyphonClientServersContext;
     return surface;
 }
 
+- (NSUInteger)getRetainedSurfaces:(IOSurfaceRef *)surfaces count:(NSUInteger)count
+{
+    NSUInteger result;
+    [self updateFrameID];
+    os_unfair_lock_lock(&_lock);
+    result = [_connectionManager getRetainedSurfaces:surfaces count:count];
+    os_unfair_lock_unlock(&_lock);
+    return result;
+}
+
+#pragma mark History
+
+- (void)recordFrame:(IOSurfaceRef)surface metadata:(SyphonFrameMetadata)metadata frameID:(NSUInteger)frameID
+{
+    os_unfair_lock_lock(&_lock);
+    // Frames may still arrive once the client has stopped
+    if (_historyLength == 0 || _connectionManager == nil)
+    {
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+    SyphonClientHistoryFrame *frame = &_history[_historyNext];
+    if (frame->surface)
+    {
+        CFRelease(frame->surface);
+    }
+    frame->surface = (IOSurfaceRef)CFRetain(surface);
+    frame->seed = IOSurfaceGetSeed(surface);
+    frame->frameID = frameID;
+    frame->metadata = metadata;
+    _historyNext = (_historyNext + 1) % _historyLength;
+    _historyCount = MIN(_historyCount + 1, _historyLength);
+    os_unfair_lock_unlock(&_lock);
+}
+
+/*
+ Places the frames in the history which the server hasn't since drawn over in frames, newest first, and returns
+ their number. frames must have space for _historyCount frames.
+ */
+- (NSUInteger)getIntactFramesHavingLock:(SyphonClientHistoryFrame **)frames
+{
+    NSUInteger count = 0;
+    for (NSUInteger i = 0; i < _historyCount; i++)
+    {
+        SyphonClientHistoryFrame *frame = &_history[(_historyNext + _historyLength - 1 - i) % _historyLength];
+        if (frame->surface && IOSurfaceGetSeed(frame->surface) == frame->seed)
+        {
+            frames[count++] = frame;
+        }
+    }
+    return count;
+}
+
+- (NSUInteger)getFrameHistory:(SyphonFrameMetadata *)metadata count:(NSUInteger)count
+{
+    SyphonClientHistoryFrame *frames[kSyphonClientMaxFrameHistoryLength];
+    os_unfair_lock_lock(&_lock);
+    NSUInteger intact = MIN([self getIntactFramesHavingLock:frames], count);
+    for (NSUInteger i = 0; i < intact; i++)
+    {
+        metadata[i] = frames[i]->metadata;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return intact;
+}
+
+- (IOSurfaceRef)newSurfaceForPresentationTime:(uint64_t)time
+{
+    SyphonClientHistoryFrame *frames[kSyphonClientMaxFrameHistoryLength];
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = [self getIntactFramesHavingLock:frames];
+    if (count == 0)
+    {
+        os_unfair_lock_unlock(&_lock);
+        return [self newSurface];
+    }
+    // Without a delay we allow for frames arriving up to one frame interval late
+    uint64_t delay = _presentationDelay;
+    if (!_hasPresentationDelay && count > 1 && frames[0]->metadata.captureTime > frames[count - 1]->metadata.captureTime)
+    {
+        delay = (frames[0]->metadata.captureTime - frames[count - 1]->metadata.captureTime) / (count - 1);
+    }
+    uint64_t target = time > delay ? time - delay : 0;
+    // Show the newest frame due by the target, or hold the oldest until one is
+    SyphonClientHistoryFrame *chosen = frames[count - 1];
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        if (frames[i]->metadata.captureTime <= target)
+        {
+            chosen = frames[i];
+            break;
+        }
+    }
+    _lastFrameID = chosen->frameID;
+    _frameMetadata = chosen->metadata;
+    if (_fence)
+    {
+        SyphonFenceBeginFrame(_fence, _fenceSlot, _frameMetadata.sequence);
+    }
+    IOSurfaceRef surface = (IOSurfaceRef)CFRetain(chosen->surface);
+    os_unfair_lock_unlock(&_lock);
+    return surface;
+}
+
+#pragma mark Releases
+
+- (void)attachFence:(IOSurfaceID)fenceID
+{
+    // A client without a slot still works, but the server can't see what it reads
+    IOSurfaceRef surface = IOSurfaceLookup(fenceID);
+    if (!surface)
+    {
+        return;
+    }
+    if (IOSurfaceLock(surface, 0, NULL) != kIOReturnSuccess)
+    {
+        CFRelease(surface);
+        return;
+    }
+    SyphonFenceRef fence = (SyphonFenceRef)IOSurfaceGetBaseAddress(surface);
+    int32_t slot = SyphonFenceIsValid(fence, IOSurfaceGetAllocSize(surface)) ? SyphonFenceClaimSlot(fence) : -1;
+    if (slot < 0)
+    {
+        IOSurfaceUnlock(surface, 0, NULL);
+        CFRelease(surface);
+        return;
+    }
+    os_unfair_lock_lock(&_lock);
+    _fenceSurface = surface;
+    _fence = fence;
+    _fenceSlot = slot;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)releaseFrameSequence:(uint64_t)sequence
+{
+    os_unfair_lock_lock(&_lock);
+    if (_fence)
+    {
+        SyphonFenceFinishFrame(_fence, _fenceSlot, sequence);
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
 @end
@@ -29,6 +29,7 @@
 
 
 #import <Foundation/Foundation.h>
+#import "SyphonFrameMetadata.h"
 
 /* This object handles messaging to and from the server.
 
@@ -48,6 +49,10 @@
 
 @protocol SyphonFrameReceiving
 - (void)receiveNewFrame;
+@optional
+// Called for every frame, even when receiveNewFrame is called once for several, with the frame's retained surface.
+// Not called on the frame queue, and never with the connection manager's lock held.
+- (void)recordFrame:(IOSurfaceRef)surface metadata:(SyphonFrameMetadata)metadata frameID:(NSUInteger)frameID;
 @end
 @protocol SyphonInfoReceiving
 - (void)invalidateFrame;
@@ -59,5 +64,9 @@
 - (void)addInfoClient:(id <SyphonInfoReceiving>)client isFrameClient:(BOOL)frameClient;     // Must be
 - (void)removeInfoClient:(id <SyphonInfoReceiving>)client isFrameClient:(BOOL)frameClient;  // paired
 - (IOSurfaceRef)newSurface;
+// Retains and places the surface for each of the server's streams in surfaces, or NULL for streams without one, all from the same frame.
+// Returns the number of streams the server has published surfaces for, up to count.
+- (NSUInteger)getRetainedSurfaces:(IOSurfaceRef *)surfaces count:(NSUInteger)count;
 @property (readonly) NSUInteger frameID;
+@property (readonly) SyphonFrameMetadata frameMetadata; // metadata sent with the most recent frame
 @end
@@ -37,62 +37,179 @@
 
 #pragma mark Shared Instances
 
-static os_unfair_lock _lookupTableLock = OS_UNFAIR_LOCK_INIT;
-static NSMapTable *_lookupTable;
+/*
+ Instances are shared per server. The table is split into shards, each with its own lock, chosen by a hash of the
+ server's UUID which each instance computes once, so creating and destroying clients for different servers rarely
+ contends. Tables are created once and keep their capacity.
+ */
+#define kSyphonClientLookupShardCount 16
+
+// The number of a server's surfaces an instance keeps, see -rememberSurfaceHavingLock:
+#define kSyphonClientRecentSurfaceLimit 8
+
+static os_unfair_lock _lookupLocks[kSyphonClientLookupShardCount]; // zero is OS_UNFAIR_LOCK_INIT
+static NSMapTable *_lookupTables[kSyphonClientLookupShardCount];
+
+static NSUInteger SyphonClientPrivateShard(NSUInteger uuidHash)
+{
+	static dispatch_once_t once;
+	dispatch_once(&once, ^{
+		for (int i = 0; i < kSyphonClientLookupShardCount; i++)
+		{
+			_lookupTables[i] = [[NSMapTable alloc] initWithKeyOptions:NSMapTableStrongMemory valueOptions:NSMapTableWeakMemory capacity:4];
+		}
+	});
+	return uuidHash % kSyphonClientLookupShardCount;
+}
 
-static id SyphonClientPrivateCopyInstance(NSString *uuid)
+static id SyphonClientPrivateCopyInstance(NSString *uuid, NSUInteger uuidHash)
 {
 	id result = nil;
-	os_unfair_lock_lock(&_lookupTableLock);
-	if (uuid) result = [_lookupTable objectForKey:uuid];
-	os_unfair_lock_unlock(&_lookupTableLock);
+	if (uuid)
+	{
+		NSUInteger shard = SyphonClientPrivateShard(uuidHash);
+		os_unfair_lock_lock(&_lookupLocks[shard]);
+		result = [_lookupTables[shard] objectForKey:uuid];
+		os_unfair_lock_unlock(&_lookupLocks[shard]);
+	}
 	return result;
 }
 
-static void SyphonClientPrivateInsertInstance(id instance, NSString *uuid)
+static void SyphonClientPrivateInsertInstance(id instance, NSString *uuid, NSUInteger uuidHash)
+{
+	if (uuid)
+	{
+		NSUInteger shard = SyphonClientPrivateShard(uuidHash);
+		os_unfair_lock_lock(&_lookupLocks[shard]);
+		[_lookupTables[shard] setObject:instance forKey:uuid];
+		os_unfair_lock_unlock(&_lookupLocks[shard]);
+	}
+}
+
+static void SyphonClientPrivateRemoveInstance(NSString *uuid, NSUInteger uuidHash)
 {
-	os_unfair_lock_lock(&_lookupTableLock);
 	if (uuid)
 	{
-		if (!_lookupTable) _lookupTable = [[NSMapTable alloc] initWithKeyOptions:NSMapTableStrongMemory valueOptions:NSMapTableWeakMemory capacity:1];
-		[_lookupTable setObject:instance forKey:uuid];
+		NSUInteger shard = SyphonClientPrivateShard(uuidHash);
+		os_unfair_lock_lock(&_lookupLocks[shard]);
+		// This is called from dealloc, when weak references to the instance are already nil, so only remove the
+		// entry if it is empty: if not, another instance has since been inserted for the same server
+		if ([_lookupTables[shard] objectForKey:uuid] == nil)
+		{
+			[_lookupTables[shard] removeObjectForKey:uuid];
+		}
+		os_unfair_lock_unlock(&_lookupLocks[shard]);
 	}
-	os_unfair_lock_unlock(&_lookupTableLock);
 }
 
-static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
+#pragma mark Frame Port
+
+/*
+ Each process has one frame port, to which servers in a publish group send the new frame notices for all of the
+ process' clients of those servers in one message. Instances are found by their own UUID, which servers use to
+ identify them.
+ */
+
+static os_unfair_lock _framePortLock = OS_UNFAIR_LOCK_INIT;
+static NSMapTable *_framePortInstances;
+
+static void SyphonClientFramePortInsertInstance(id instance, NSString *uuid)
 {
-	os_unfair_lock_lock(&_lookupTableLock);
-	if (uuid) [_lookupTable removeObjectForKey:uuid];
-	if ([_lookupTable count] == 0)
+	os_unfair_lock_lock(&_framePortLock);
+	if (_framePortInstances == nil)
 	{
-		_lookupTable = nil;
+		_framePortInstances = [[NSMapTable alloc] initWithKeyOptions:NSMapTableStrongMemory valueOptions:NSMapTableWeakMemory capacity:4];
 	}
-	os_unfair_lock_unlock(&_lookupTableLock);
+	[_framePortInstances setObject:instance forKey:uuid];
+	os_unfair_lock_unlock(&_framePortLock);
+}
+
+static void SyphonClientFramePortRemoveInstance(NSString *uuid)
+{
+	os_unfair_lock_lock(&_framePortLock);
+	[_framePortInstances removeObjectForKey:uuid];
+	os_unfair_lock_unlock(&_framePortLock);
+}
+
+static id SyphonClientFramePortCopyInstance(NSString *uuid)
+{
+	os_unfair_lock_lock(&_framePortLock);
+	id result = [_framePortInstances objectForKey:uuid];
+	os_unfair_lock_unlock(&_framePortLock);
+	return result;
 }
 
 @interface SyphonClientConnectionManager (Private)
-- (void)publishNewFrame;
+- (void)publishNewFrameWithMetadata:(NSData *)data;
+- (void)publishNewFrameAsynchronouslyWithMetadata:(NSData *)data;
 - (void)setSurfaceID:(IOSurfaceID)surfaceID;
+- (void)setStreamSurfaceIDs:(NSArray<NSNumber *> *)streamIDs;
 - (IOSurfaceRef)surfaceHavingLock;
+- (NSUInteger)frameIDHavingLock;
 - (void)endConnectionHavingLock:(BOOL)hasLock;
 - (void)invalidateFramesHavingLock;
+- (void)rememberSurfaceHavingLock:(IOSurfaceRef)surface;
 @end
+
+// Returns the name of the process' frame port, creating it if necessary, or nil if it couldn't be created
+static NSString *SyphonClientFramePortName(void)
+{
+	static NSString *name;
+	static SyphonMessageReceiver *receiver;
+	static dispatch_once_t once;
+	dispatch_once(&once, ^{
+		NSString *uuid = SyphonCreateUUIDString();
+		NSSet *classes = [NSSet setWithObjects:[NSDictionary class], [NSString class], [NSData class], nil];
+		receiver = [[SyphonMessageReceiver alloc] initForName:uuid
+													 protocol:SyphonMessagingProtocolCFMessage
+											   allowedClasses:classes
+													  handler:^(id data, uint32_t type) {
+			if (type == SyphonMessageTypeNewFrameBatch && [data isKindOfClass:[NSDictionary class]])
+			{
+				// The port serves every grouped server in the process, so frame handlers are run
+				// asynchronously on each client's own queue: a slow handler then delays neither
+				// the other clients nor the server which sent the batch
+				[(NSDictionary *)data enumerateKeysAndObjectsUsingBlock:^(id key, id metadata, BOOL *stop) {
+					SyphonClientConnectionManager *instance = SyphonClientFramePortCopyInstance(key);
+					[instance publishNewFrameAsynchronouslyWithMetadata:metadata];
+				}];
+			}
+			else
+			{
+				SYPHONLOG(@"Unknown message type #%u received on frame port", type);
+			}
+		}];
+		// The port lasts for the life of the process
+		if (receiver)
+		{
+			name = uuid;
+		}
+	});
+	return name;
+}
+
 @implementation SyphonClientConnectionManager
 {
 @private
     NSString *_myUUID;
     IOSurfaceID _surfaceID;
     IOSurfaceRef _surface;
+    NSMutableArray *_recentSurfaces; // IOSurfaces, in the order they were first used
+    NSArray<NSNumber *> *_streamSurfaceIDs;
+    NSMutableDictionary<NSNumber *, id> *_streamSurfaces; // IOSurfaces looked up so far, keyed by stream index
     uint32_t _lastSeed;
     NSUInteger _frameID;
+    SyphonFrameMetadata _frameMetadata;
     NSString *_serverUUID;
+    NSUInteger _serverUUIDHash;
     BOOL _serverActive;
     SyphonMessageReceiver *_connection;
     atomic_int _handlerCount;
     NSHashTable *_infoClients;
     NSHashTable *_frameClients;
     dispatch_queue_t _frameQueue;
+    atomic_bool _frameNotifyPending;
+    NSHashTable *_recordingClients; // frame clients which record every frame, guarded by _lock
     os_unfair_lock _lock;
 }
 
@@ -102,9 +219,10 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 	if (self)
 	{
 		_serverUUID = [[description objectForKey:SyphonServerDescriptionUUIDKey] copy];
+		_serverUUIDHash = [_serverUUID hash];
 		
 		// Return an existing instance for this server if we have one
-		id existing = SyphonClientPrivateCopyInstance(_serverUUID);
+		id existing = SyphonClientPrivateCopyInstance(_serverUUID, _serverUUIDHash);
 		if (existing)
 		{
 			return existing;
@@ -126,14 +244,19 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 		_myUUID = SyphonCreateUUIDString();
         _serverActive = YES; // Until we know better - SyphonClient has API behaviour depending on this
 
-		SyphonClientPrivateInsertInstance(self, _serverUUID);
+		SyphonClientPrivateInsertInstance(self, _serverUUID, _serverUUIDHash);
+		SyphonClientFramePortInsertInstance(self, _myUUID);
 	}
 	return self;
 }
 
 - (void) dealloc
 {
-	SyphonClientPrivateRemoveInstance(self, _serverUUID);
+	SyphonClientPrivateRemoveInstance(_serverUUID, _serverUUIDHash);
+	if (_myUUID)
+	{
+		SyphonClientFramePortRemoveInstance(_myUUID);
+	}
 }
 
 - (void)endConnectionHavingLock:(BOOL)hasLock
@@ -145,6 +268,7 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 	connection = _connection;
 	_connection = nil;
     [self invalidateFramesHavingLock];
+    [_recentSurfaces removeAllObjects];
 	if (!hasLock) os_unfair_lock_unlock(&_lock);
 	[connection invalidate];
 }
@@ -164,6 +288,7 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 		CFRelease(_surface);
 		_surface = NULL;
     }
+    [_streamSurfaces removeAllObjects];
     for (id <SyphonInfoReceiving> obj in _infoClients) {
         [obj invalidateFrame];
     }
@@ -190,14 +315,14 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 	if (_infoClients.count == 1)
 	{
 		// set up a connection to receive and deal with messages from the server
-        NSSet *classes = [NSSet setWithObjects:[NSString class], [NSNumber class], nil];
+        NSSet *classes = [NSSet setWithObjects:[NSString class], [NSNumber class], [NSData class], [NSArray class], nil];
         _connection = [[SyphonMessageReceiver alloc] initForName:_myUUID
                                                         protocol:SyphonMessagingProtocolCFMessage
                                                   allowedClasses:classes
                                                          handler:^(id data, uint32_t type) {
 			switch (type) {
 				case SyphonMessageTypeNewFrame:
-					[self publishNewFrame];
+					[self publishNewFrameWithMetadata:data];
 					break;
 				case SyphonMessageTypeUpdateServerName:
                     // Ignore, handled by SyphonClient from SyphonServerDirectory now
@@ -206,6 +331,12 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 				case SyphonMessageTypeUpdateSurfaceID:
 					[self setSurfaceID:[(NSNumber *)data unsignedIntValue]];
 					break;
+				case SyphonMessageTypeUpdateStreamSurfaceIDs:
+					if ([data isKindOfClass:[NSArray class]])
+					{
+						[self setStreamSurfaceIDs:(NSArray *)data];
+					}
+					break;
 				case SyphonMessageTypeRetireServer:
 					[self invalidateServerNotHavingLock];
 					break;
@@ -224,6 +355,14 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
     {
         _frameQueue = dispatch_queue_create([_myUUID cStringUsingEncoding:NSUTF8StringEncoding], 0);
         _frameClients = [NSHashTable weakObjectsHashTable];
+    }
+    if (isFrameClient && [client respondsToSelector:@selector(recordFrame:metadata:frameID:)])
+    {
+        if (_recordingClients == nil)
+        {
+            _recordingClients = [NSHashTable weakObjectsHashTable];
+        }
+        [_recordingClients addObject:client];
     }
 	os_unfair_lock_unlock(&_lock);
     if (isFrameClient)
@@ -254,6 +393,12 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
         {
             SYPHONLOG(@"Registering for frame updates");
             [sender send:_myUUID ofType:SyphonMessageTypeAddClientForFrames];
+            NSString *framePort = SyphonClientFramePortName();
+            if (framePort)
+            {
+                // Servers which predate batches ignore this, and send frames to our own port
+                [sender send:@[_myUUID, framePort] ofType:SyphonMessageTypeAddClientForFrameBatches];
+            }
         }
 	}
 }
@@ -268,6 +413,7 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
     }
 	os_unfair_lock_lock(&_lock);
     [_infoClients removeObject:client];
+    [_recordingClients removeObject:client];
     BOOL shouldSendRemove = _infoClients.count == 0 ? YES : NO;
 	if (shouldSendRemove)
 	{
@@ -299,10 +445,49 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 	return [NSString stringWithFormat:@"Server UUID: %@", _serverUUID, nil];
 }
 
-- (void)publishNewFrame
+- (void)updateFrameMetadata:(NSData *)data
 {
-	// This could be dispatch_async WHEN we coalesce incoming messages
-	// Just now it's sync so a server can't flood a client (at the cost of blocking servers)
+	// Older servers send no metadata, in which case it is zeroed
+	SyphonFrameMetadata metadata = {0};
+	IOSurfaceID surfaceID = 0;
+	if ([data isKindOfClass:[NSData class]])
+	{
+		SyphonFrameMetadataGetFromData(data, &metadata, &surfaceID);
+	}
+	os_unfair_lock_lock(&_lock);
+	_frameMetadata = metadata;
+	if (surfaceID != 0 && surfaceID != _surfaceID)
+	{
+		// The server has moved to another of its surfaces (see SyphonServerOptionSurfaceCount)
+		_surfaceID = surfaceID;
+		_frameID++;
+		[self invalidateFramesHavingLock];
+	}
+	// Clients may be told of several frames at once, so frames are recorded here, where each is seen
+	IOSurfaceRef surface = NULL;
+	NSUInteger frameID = 0;
+	NSArray<id <SyphonFrameReceiving>> *recording = nil;
+	if (_recordingClients.count)
+	{
+		surface = [self surfaceHavingLock];
+		if (surface) CFRetain(surface);
+		frameID = [self frameIDHavingLock];
+		recording = _recordingClients.allObjects;
+	}
+	os_unfair_lock_unlock(&_lock);
+	if (surface)
+	{
+		for (id <SyphonFrameReceiving> client in recording) {
+			[client recordFrame:surface metadata:metadata frameID:frameID];
+		}
+		CFRelease(surface);
+	}
+}
+
+- (void)publishNewFrameWithMetadata:(NSData *)data
+{
+	[self updateFrameMetadata:data];
+	// Sync so a server can't flood a client (at the cost of blocking servers)
 	dispatch_sync(_frameQueue, ^{
 		for (id <SyphonFrameReceiving> obj in _frameClients) {
 			[obj receiveNewFrame];
@@ -310,16 +495,74 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 	});
 }
 
+- (void)publishNewFrameAsynchronouslyWithMetadata:(NSData *)data
+{
+	[self updateFrameMetadata:data];
+	// Coalesce frames which arrive while clients are still to be notified of an earlier one,
+	// so a server can't flood a client: handlers then see the latest frame, and histories have the others
+	if (atomic_exchange(&_frameNotifyPending, true))
+	{
+		return;
+	}
+	dispatch_async(_frameQueue, ^{
+		atomic_store(&self->_frameNotifyPending, false);
+		for (id <SyphonFrameReceiving> obj in self->_frameClients) {
+			[obj receiveNewFrame];
+		}
+	});
+}
+
 - (IOSurfaceRef)surfaceHavingLock
 {
+	if (!_surface)
+	{
+		for (id recent in _recentSurfaces)
+		{
+			if (IOSurfaceGetID((__bridge IOSurfaceRef)recent) == _surfaceID)
+			{
+				_surface = (IOSurfaceRef)CFRetain((__bridge IOSurfaceRef)recent);
+				break;
+			}
+		}
+	}
 	if (!_surface)
 	{
 		// WHOA - This causes a retain.
 		_surface = IOSurfaceLookup(_surfaceID);
+		if (_surface)
+		{
+			[self rememberSurfaceHavingLock:_surface];
+		}
 	}
 	return _surface;
 }
 
+/*
+ Servers with several surfaces move between them every frame, so we keep those we have seen rather than look them
+ up again. A surface of a different size or format means the server has replaced its surfaces, so we let go of
+ the old ones.
+ */
+- (void)rememberSurfaceHavingLock:(IOSurfaceRef)surface
+{
+	if (_recentSurfaces == nil)
+	{
+		_recentSurfaces = [[NSMutableArray alloc] initWithCapacity:kSyphonClientRecentSurfaceLimit];
+	}
+	size_t width = IOSurfaceGetWidth(surface);
+	size_t height = IOSurfaceGetHeight(surface);
+	OSType format = IOSurfaceGetPixelFormat(surface);
+	NSIndexSet *stale = [_recentSurfaces indexesOfObjectsPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop) {
+		IOSurfaceRef recent = (__bridge IOSurfaceRef)obj;
+		return IOSurfaceGetWidth(recent) != width || IOSurfaceGetHeight(recent) != height || IOSurfaceGetPixelFormat(recent) != format;
+	}];
+	[_recentSurfaces removeObjectsAtIndexes:stale];
+	if (_recentSurfaces.count == kSyphonClientRecentSurfaceLimit)
+	{
+		[_recentSurfaces removeObjectAtIndex:0];
+	}
+	[_recentSurfaces addObject:(__bridge id)surface];
+}
+
 - (void)setSurfaceID:(IOSurfaceID)surfaceID
 {
 	os_unfair_lock_lock(&_lock);
@@ -329,6 +572,59 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 	os_unfair_lock_unlock(&_lock);
 }
 
+- (void)setStreamSurfaceIDs:(NSArray<NSNumber *> *)streamIDs
+{
+	os_unfair_lock_lock(&_lock);
+	_streamSurfaceIDs = streamIDs;
+	if (_streamSurfaces == nil)
+	{
+		_streamSurfaces = [[NSMutableDictionary alloc] initWithCapacity:streamIDs.count];
+	}
+	_frameID++; // new surfaces mean a new frame
+	[self invalidateFramesHavingLock];
+	os_unfair_lock_unlock(&_lock);
+}
+
+- (NSUInteger)getRetainedSurfaces:(IOSurfaceRef *)surfaces count:(NSUInteger)count
+{
+	os_unfair_lock_lock(&_lock);
+	// Servers with one stream only send its surface with SyphonMessageTypeUpdateSurfaceID
+	NSUInteger available = _streamSurfaceIDs ? MIN(count, _streamSurfaceIDs.count) : MIN(count, 1U);
+	for (NSUInteger i = 0; i < available; i++)
+	{
+		IOSurfaceRef surface = NULL;
+		if (i == 0)
+		{
+			surface = [self surfaceHavingLock];
+		}
+		else
+		{
+			id existing = [_streamSurfaces objectForKey:@(i)];
+			if (existing)
+			{
+				surface = (__bridge IOSurfaceRef)existing;
+			}
+			else
+			{
+				IOSurfaceID surfaceID = [[_streamSurfaceIDs objectAtIndex:i] unsignedIntValue];
+				surface = surfaceID != 0 ? IOSurfaceLookup(surfaceID) : NULL;
+				if (surface)
+				{
+					[_streamSurfaces setObject:(__bridge_transfer id)surface forKey:@(i)];
+				}
+			}
+		}
+		if (surface) CFRetain(surface);
+		surfaces[i] = surface;
+	}
+	os_unfair_lock_unlock(&_lock);
+	for (NSUInteger i = available; i < count; i++)
+	{
+		surfaces[i] = NULL;
+	}
+	return available;
+}
+
 - (IOSurfaceRef)newSurface
 {
     IOSurfaceRef surface;
@@ -339,10 +635,26 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
     return surface;
 }
 
+- (SyphonFrameMetadata)frameMetadata
+{
+	SyphonFrameMetadata result;
+	os_unfair_lock_lock(&_lock);
+	result = _frameMetadata;
+	os_unfair_lock_unlock(&_lock);
+	return result;
+}
+
 - (NSUInteger)frameID
 {
 	NSUInteger result;
 	os_unfair_lock_lock(&_lock);
+	result = [self frameIDHavingLock];
+	os_unfair_lock_unlock(&_lock);
+	return result;
+}
+
+- (NSUInteger)frameIDHavingLock
+{
 	IOSurfaceRef surface = [self surfaceHavingLock];
 	if (surface)
 	{
@@ -353,9 +665,7 @@ static void SyphonClientPrivateRemoveInstance(id instance, NSString *uuid)
 			_lastSeed = seed;
 		}
 	}
-	result = _frameID;
-	os_unfair_lock_unlock(&_lock);
-	return result;
+	return _frameID;
 }
 
 @end
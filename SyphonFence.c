@@ -0,0 +1,203 @@
+/*
+    SyphonFence.c
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Declares kill() when built as strict C11
+#define _POSIX_C_SOURCE 200809L
+
+#include "SyphonFence.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#define SYPHON_FENCE_MAGIC 0x53794663U // 'SyFc'
+#define SYPHON_FENCE_VERSION 1U
+#define SYPHON_FENCE_RECLAIMING UINT32_MAX // the owner of a slot being reclaimed, which no process has as its pid
+
+/*
+ Each slot has a cache line of its own, so clients don't contend for lines when they update their slots.
+ A client is reading every frame after finished up to and including begun.
+ */
+typedef struct SyphonFenceSlot {
+    _Atomic uint32_t owner;     // pid of the owning process, 0 if free, SYPHON_FENCE_RECLAIMING while being reclaimed
+    uint32_t reserved;
+    _Atomic uint64_t begun;     // the newest frame the client has begun to read
+    _Atomic uint64_t finished;  // the newest frame the client has finished with
+    uint8_t padding[40];
+} SyphonFenceSlot;
+
+struct SyphonFence {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint8_t padding[52];
+    SyphonFenceSlot slots[SYPHON_FENCE_CAPACITY];
+};
+
+_Static_assert(sizeof(SyphonFenceSlot) == 64, "SyphonFenceSlot should fill a cache line");
+
+static bool SyphonFenceProcessIsAlive(uint32_t pid)
+{
+    // EPERM means the process exists but belongs to another user
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+}
+
+size_t SyphonFenceGetSize(void)
+{
+    return sizeof(struct SyphonFence);
+}
+
+void SyphonFenceInit(SyphonFenceRef fence)
+{
+    memset(fence, 0, sizeof(struct SyphonFence));
+    fence->version = SYPHON_FENCE_VERSION;
+    fence->capacity = SYPHON_FENCE_CAPACITY;
+    atomic_thread_fence(memory_order_release);
+    fence->magic = SYPHON_FENCE_MAGIC;
+}
+
+bool SyphonFenceIsValid(SyphonFenceRef fence, size_t length)
+{
+    return fence != NULL
+        && length >= sizeof(struct SyphonFence)
+        && fence->magic == SYPHON_FENCE_MAGIC
+        && fence->version == SYPHON_FENCE_VERSION
+        && fence->capacity == SYPHON_FENCE_CAPACITY;
+}
+
+int32_t SyphonFenceClaimSlot(SyphonFenceRef fence)
+{
+    uint32_t pid = (uint32_t)getpid();
+    // Only look for slots of exited processes if the fence seems full
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        for (int32_t i = 0; i < SYPHON_FENCE_CAPACITY; i++)
+        {
+            SyphonFenceSlot *slot = &fence->slots[i];
+            uint32_t expected = 0;
+            if (atomic_compare_exchange_strong(&slot->owner, &expected, pid))
+            {
+                atomic_store(&slot->begun, 0);
+                atomic_store(&slot->finished, 0);
+                return i;
+            }
+        }
+        if (SyphonFenceReclaimSlots(fence) == 0)
+        {
+            break;
+        }
+    }
+    return -1;
+}
+
+void SyphonFenceReleaseSlot(SyphonFenceRef fence, int32_t slot)
+{
+    if (slot >= 0 && slot < SYPHON_FENCE_CAPACITY)
+    {
+        atomic_store(&fence->slots[slot].begun, 0);
+        atomic_store(&fence->slots[slot].finished, 0);
+        atomic_store(&fence->slots[slot].owner, 0);
+    }
+}
+
+void SyphonFenceBeginFrame(SyphonFenceRef fence, int32_t slot, uint64_t sequence)
+{
+    if (slot < 0 || slot >= SYPHON_FENCE_CAPACITY || sequence == 0)
+    {
+        return;
+    }
+    SyphonFenceSlot *record = &fence->slots[slot];
+    // Only this client writes to the slot, so these needn't be atomic together
+    if (sequence <= atomic_load_explicit(&record->finished, memory_order_relaxed))
+    {
+        // Going back to an earlier frame, for instance from a history
+        atomic_store(&record->finished, sequence - 1);
+    }
+    if (sequence > atomic_load_explicit(&record->begun, memory_order_relaxed))
+    {
+        atomic_store(&record->begun, sequence);
+    }
+}
+
+void SyphonFenceFinishFrame(SyphonFenceRef fence, int32_t slot, uint64_t sequence)
+{
+    if (slot < 0 || slot >= SYPHON_FENCE_CAPACITY)
+    {
+        return;
+    }
+    SyphonFenceSlot *record = &fence->slots[slot];
+    if (sequence > atomic_load_explicit(&record->finished, memory_order_relaxed))
+    {
+        atomic_store(&record->finished, sequence);
+    }
+}
+
+uint32_t SyphonFenceGetReaderCount(SyphonFenceRef fence, uint64_t sequence)
+{
+    uint32_t count = 0;
+    for (int32_t i = 0; i < SYPHON_FENCE_CAPACITY; i++)
+    {
+        SyphonFenceSlot *slot = &fence->slots[i];
+        if (atomic_load(&slot->owner) == 0)
+        {
+            continue;
+        }
+        uint64_t finished = atomic_load(&slot->finished);
+        uint64_t begun = atomic_load(&slot->begun);
+        if (sequence > finished && sequence <= begun)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t SyphonFenceReclaimSlots(SyphonFenceRef fence)
+{
+    uint32_t reclaimed = 0;
+    for (int32_t i = 0; i < SYPHON_FENCE_CAPACITY; i++)
+    {
+        SyphonFenceSlot *slot = &fence->slots[i];
+        uint32_t owner = atomic_load(&slot->owner);
+        // Take the slot before emptying it, so a client which claimed it since we read its owner keeps its state
+        if (owner != 0 && owner != SYPHON_FENCE_RECLAIMING && !SyphonFenceProcessIsAlive(owner)
+            && atomic_compare_exchange_strong(&slot->owner, &owner, SYPHON_FENCE_RECLAIMING))
+        {
+            // Empty the slot before freeing it, so it doesn't count as reading for a moment when claimed
+            atomic_store(&slot->begun, 0);
+            atomic_store(&slot->finished, 0);
+            atomic_store(&slot->owner, 0);
+            reclaimed++;
+        }
+    }
+    return reclaimed;
+}
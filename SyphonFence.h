@@ -0,0 +1,113 @@
+/*
+    SyphonFence.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+ Syphon Fence is a table of per-client slots in memory shared between a server and its clients, through which
+ clients tell the server which frames they are reading, so the server can avoid drawing over them.
+
+ - Each client claims a slot and records the sequence number (see SyphonFrameMetadata) of each frame it begins
+   to read, and of the newest frame it has finished with. Finishing with a frame finishes with every earlier one
+ - A frame is in use while any client has begun to read it, or a later frame, and hasn't finished with it
+ - Only the client writes to its slot, and no locks are taken, so a slow client can't hold up the server or other
+   clients: the server decides what to do about frames in use
+ - Slots of processes which have exited are reclaimed by SyphonFenceReclaimSlots(), which makes a system call per
+   slot, so is kept out of the per-frame path
+
+ The fence uses only C11 atomics. The server keeps it in an IOSurface, which clients look up by ID.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SYPHON_FENCE_CAPACITY 64
+
+/*
+ SyphonFenceRef
+	A fence in memory of at least SyphonFenceGetSize() bytes.
+ */
+typedef struct SyphonFence *SyphonFenceRef;
+
+/*
+ SyphonFenceGetSize
+	Returns the number of bytes needed for a fence.
+ */
+size_t SyphonFenceGetSize(void);
+
+/*
+ SyphonFenceInit
+	Prepares memory of at least SyphonFenceGetSize() bytes as an empty fence.
+ */
+void SyphonFenceInit(SyphonFenceRef fence);
+
+/*
+ SyphonFenceIsValid
+	Returns true if memory of the given length holds a fence prepared with SyphonFenceInit().
+ */
+bool SyphonFenceIsValid(SyphonFenceRef fence, size_t length);
+
+/*
+ SyphonFenceClaimSlot
+	Claims a slot for a client in the calling process, reclaiming slots of exited processes if the fence is full.
+	Returns the index of the slot, or -1 if the fence is full.
+ */
+int32_t SyphonFenceClaimSlot(SyphonFenceRef fence);
+
+/*
+ SyphonFenceReleaseSlot
+	Releases a slot previously returned by SyphonFenceClaimSlot(), finishing with any frames it was reading.
+ */
+void SyphonFenceReleaseSlot(SyphonFenceRef fence, int32_t slot);
+
+/*
+ SyphonFenceBeginFrame
+	Records that the client with the slot has begun to read the frame with the given sequence number.
+ */
+void SyphonFenceBeginFrame(SyphonFenceRef fence, int32_t slot, uint64_t sequence);
+
+/*
+ SyphonFenceFinishFrame
+	Records that the client with the slot has finished with the frame with the given sequence number, and every
+	earlier frame.
+ */
+void SyphonFenceFinishFrame(SyphonFenceRef fence, int32_t slot, uint64_t sequence);
+
+/*
+ SyphonFenceGetReaderCount
+	Returns the number of clients reading the frame with the given sequence number. Makes no system calls, so
+	clients which exited while reading are counted until SyphonFenceReclaimSlots() is called.
+ */
+uint32_t SyphonFenceGetReaderCount(SyphonFenceRef fence, uint64_t sequence);
+
+/*
+ SyphonFenceReclaimSlots
+	Frees the slots of processes which have exited. Returns the number of slots freed.
+ */
+uint32_t SyphonFenceReclaimSlots(SyphonFenceRef fence);
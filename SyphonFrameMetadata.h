@@ -0,0 +1,87 @@
+/*
+    SyphonFrameMetadata.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ The maximum number of bytes of user data which can accompany a frame.
+ */
+#define SyphonFrameMetadataUserDataCapacity 64
+
+/*!
+ The maximum number of dirty rects which can accompany a frame.
+ */
+#define SyphonFrameMetadataDirtyRectCapacity 16
+
+/*!
+ Information which accompanies each frame published by a server. Times are in nanoseconds on the system's monotonic clock (see SyphonFrameTimestampNow()) and so can be compared between processes.
+ */
+typedef struct SyphonFrameMetadata {
+    /*!
+     Starts at 1 for the first frame published by a server and increases by 1 for each subsequent frame. A gap between the sequence numbers of frames a client receives indicates frames the client did not see. Zero if no metadata was received.
+     */
+    uint64_t sequence;
+    /*!
+     The time supplied by the server for the capture or creation of the frame, or the publishTime if the server didn't supply one.
+     */
+    uint64_t captureTime;
+    /*!
+     The time the frame was published.
+     */
+    uint64_t publishTime;
+    /*!
+     The number of valid bytes in userData.
+     */
+    uint32_t userDataLength;
+    /*!
+     Data supplied by the server to accompany the frame.
+     */
+    uint8_t userData[SyphonFrameMetadataUserDataCapacity];
+    /*!
+     The number of valid rects in dirtyRects. Zero means the entire frame may have changed.
+     */
+    uint32_t dirtyRectCount;
+    /*!
+     The regions of the frame which changed since the previous frame, in pixels, where the origin is the first pixel of the image's first row (the bottom-left corner of an OpenGL texture, or the top-left of a Metal texture). These only describe changes since the immediately preceding frame: if the sequence number shows a client missed frames, it should treat the entire frame as changed.
+     */
+    NSRect dirtyRects[SyphonFrameMetadataDirtyRectCapacity];
+    /*!
+     The version of the frame's content supplied by the server, or zero if the server didn't supply one. Frames with the same non-zero version have the same content.
+     */
+    uint64_t contentVersion;
+} SyphonFrameMetadata;
+
+/*!
+ Returns the current time in nanoseconds on the clock used for the times in SyphonFrameMetadata.
+ */
+extern uint64_t SyphonFrameTimestampNow(void);
+
+NS_ASSUME_NONNULL_END
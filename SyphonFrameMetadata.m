@@ -0,0 +1,168 @@
+/*
+    SyphonFrameMetadata.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SyphonFrameMetadata.h"
+#import "SyphonPrivate.h"
+#import <time.h>
+
+#define kSyphonFrameMetadataWireVersion 3U
+
+/*
+ The layout metadata has when sent with a new-frame message. Receivers accept any length at least the size of
+ version 1, so fields may be appended in future versions. Every platform Syphon runs on is little-endian.
+
+ Version 2 appends contentVersion. Version 3 appends the ID of the surface holding the frame, so servers which draw
+ each frame to the next of several surfaces needn't send clients a separate message for each surface.
+ */
+typedef struct SyphonFrameMetadataWire {
+    uint32_t version;
+    uint32_t length;
+    uint64_t sequence;
+    uint64_t captureTime;
+    uint64_t publishTime;
+    uint32_t userDataLength;
+    uint8_t userData[SyphonFrameMetadataUserDataCapacity];
+    uint32_t dirtyRectCount;
+    struct {
+        uint32_t x, y, width, height;
+    } dirtyRects[SyphonFrameMetadataDirtyRectCapacity];
+    uint64_t contentVersion;
+    uint32_t surfaceID;
+    uint32_t reserved;
+} SyphonFrameMetadataWire;
+
+#define kSyphonFrameMetadataWireMinimumLength offsetof(SyphonFrameMetadataWire, contentVersion) // version 1
+
+uint64_t SyphonFrameTimestampNow(void)
+{
+    return clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+}
+
+NSData *SyphonFrameMetadataCreateData(const SyphonFrameMetadata *metadata, IOSurfaceID surfaceID)
+{
+    SyphonFrameMetadataWire wire = {0};
+    wire.version = kSyphonFrameMetadataWireVersion;
+    wire.length = sizeof(SyphonFrameMetadataWire);
+    wire.sequence = metadata->sequence;
+    wire.captureTime = metadata->captureTime;
+    wire.publishTime = metadata->publishTime;
+    wire.userDataLength = MIN(metadata->userDataLength, SyphonFrameMetadataUserDataCapacity);
+    memcpy(wire.userData, metadata->userData, wire.userDataLength);
+    wire.dirtyRectCount = MIN(metadata->dirtyRectCount, SyphonFrameMetadataDirtyRectCapacity);
+    for (uint32_t i = 0; i < wire.dirtyRectCount; i++)
+    {
+        // Rects are integral in surface coordinates, see SyphonDirtyRectsToSurface()
+        wire.dirtyRects[i].x = (uint32_t)metadata->dirtyRects[i].origin.x;
+        wire.dirtyRects[i].y = (uint32_t)metadata->dirtyRects[i].origin.y;
+        wire.dirtyRects[i].width = (uint32_t)metadata->dirtyRects[i].size.width;
+        wire.dirtyRects[i].height = (uint32_t)metadata->dirtyRects[i].size.height;
+    }
+    wire.contentVersion = metadata->contentVersion;
+    wire.surfaceID = surfaceID;
+    return [[NSData alloc] initWithBytes:&wire length:sizeof(SyphonFrameMetadataWire)];
+}
+
+BOOL SyphonFrameMetadataGetFromData(NSData *data, SyphonFrameMetadata *metadata, IOSurfaceID *surfaceID)
+{
+    // Fields absent from earlier versions are zero
+    SyphonFrameMetadataWire wire = {0};
+    if (![data isKindOfClass:[NSData class]] || data.length < kSyphonFrameMetadataWireMinimumLength)
+    {
+        return NO;
+    }
+    [data getBytes:&wire length:MIN(data.length, sizeof(SyphonFrameMetadataWire))];
+    if (wire.version < 1U || wire.length < kSyphonFrameMetadataWireMinimumLength)
+    {
+        return NO;
+    }
+    metadata->sequence = wire.sequence;
+    metadata->captureTime = wire.captureTime;
+    metadata->publishTime = wire.publishTime;
+    metadata->userDataLength = MIN(wire.userDataLength, SyphonFrameMetadataUserDataCapacity);
+    memcpy(metadata->userData, wire.userData, metadata->userDataLength);
+    metadata->dirtyRectCount = MIN(wire.dirtyRectCount, SyphonFrameMetadataDirtyRectCapacity);
+    for (uint32_t i = 0; i < metadata->dirtyRectCount; i++)
+    {
+        metadata->dirtyRects[i] = NSMakeRect(wire.dirtyRects[i].x, wire.dirtyRects[i].y, wire.dirtyRects[i].width, wire.dirtyRects[i].height);
+    }
+    metadata->contentVersion = wire.contentVersion;
+    if (surfaceID)
+    {
+        *surfaceID = wire.surfaceID;
+    }
+    return YES;
+}
+
+void SyphonFrameMetadataSetDirtyRects(SyphonFrameMetadata *metadata, const NSRect *rects, NSUInteger count)
+{
+    if (count <= SyphonFrameMetadataDirtyRectCapacity)
+    {
+        metadata->dirtyRectCount = (uint32_t)count;
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            metadata->dirtyRects[i] = rects[i];
+        }
+    }
+    else
+    {
+        // Too many to send, so send their bounds
+        NSRect bounds = NSZeroRect;
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            bounds = NSUnionRect(bounds, rects[i]);
+        }
+        metadata->dirtyRectCount = 1;
+        metadata->dirtyRects[0] = bounds;
+    }
+}
+
+NSUInteger SyphonDirtyRectsToSurface(const NSRect *rects, NSUInteger count, NSRect region, BOOL flipped, NSRect *surfaceRects)
+{
+    NSUInteger result = 0;
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        NSRect rect = NSIntegralRect(NSIntersectionRect(rects[i], region));
+        if (!NSIsEmptyRect(rect))
+        {
+            rect.origin.x -= region.origin.x;
+            rect.origin.y -= region.origin.y;
+            if (flipped)
+            {
+                rect.origin.y = region.size.height - rect.origin.y - rect.size.height;
+            }
+            // NSIntegralRect may have grown the rect beyond the region
+            surfaceRects[result] = NSIntersectionRect(rect, NSMakeRect(0, 0, floor(region.size.width), floor(region.size.height)));
+            if (!NSIsEmptyRect(surfaceRects[result]))
+            {
+                result++;
+            }
+        }
+    }
+    return result;
+}
@@ -27,6 +27,7 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #import "SyphonIOSurfaceImageCore.h"
+#import "SyphonOpenGLFunctions.h"
 #import <OpenGL/gl3.h>
 
 @implementation SyphonIOSurfaceImageCore
@@ -64,7 +65,16 @@
 
         NSSize size = self.textureSize;
 
-        CGLError err = CGLTexImageIOSurface2D(cgl_ctx, GL_TEXTURE_RECTANGLE, GL_RGBA8, size.width, size.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, surface, 0);
+        GLenum internalFormat, format, type;
+        CGLError err;
+        if (SyphonOpenGLGetFormatsForPixelFormat(IOSurfaceGetPixelFormat(surface), &internalFormat, &format, &type))
+        {
+            err = CGLTexImageIOSurface2D(cgl_ctx, GL_TEXTURE_RECTANGLE, internalFormat, size.width, size.height, format, type, surface, 0);
+        }
+        else
+        {
+            err = kCGLBadValue;
+        }
 #ifdef SYPHON_CORE_RESTORE
         glBindTexture(GL_TEXTURE_RECTANGLE, prev);
 #else
@@ -28,6 +28,7 @@
  */
 
 #import "SyphonIOSurfaceImageLegacy.h"
+#import "SyphonOpenGLFunctions.h"
 #import <OpenGL/CGLMacro.h>
 
 @implementation SyphonIOSurfaceImageLegacy
@@ -58,7 +59,16 @@
 
         NSSize size = self.textureSize;
 
-        CGLError err = CGLTexImageIOSurface2D(cgl_ctx, GL_TEXTURE_RECTANGLE_ARB, GL_RGBA8, size.width, size.height, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, surface, 0);
+        GLenum internalFormat, format, type;
+        CGLError err;
+        if (SyphonOpenGLGetFormatsForPixelFormat(IOSurfaceGetPixelFormat(surface), &internalFormat, &format, &type))
+        {
+            err = CGLTexImageIOSurface2D(cgl_ctx, GL_TEXTURE_RECTANGLE_ARB, internalFormat, size.width, size.height, format, type, surface, 0);
+        }
+        else
+        {
+            err = kCGLBadValue;
+        }
 
         glPopAttrib();
 
@@ -34,6 +34,9 @@
 @property (readonly) NSString *name;
 @property (readonly) BOOL isValid;
 - (void)send:(id <NSCoding>)payload ofType:(uint32_t)type;
+// Encode a payload once to send the same message to several receivers
++ (NSData *)encodePayload:(id <NSCoding>)payload;
+- (void)sendEncodedPayload:(NSData *)encoded ofType:(uint32_t)type;
 @end
 @interface SyphonMessageSender (Subclassing)
 - (void)invalidate;
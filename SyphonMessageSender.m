@@ -76,7 +76,21 @@
 	return _name;
 }
 
++ (NSData *)encodePayload:(id <NSCoding>)payload
+{
+	if (payload)
+	{
+		return [NSKeyedArchiver archivedDataWithRootObject:payload requiringSecureCoding:YES error:nil];
+	}
+	return nil;
+}
+
 - (void)send:(id <NSCoding>)payload ofType:(uint32_t)type
+{
+	[self sendEncodedPayload:[[self class] encodePayload:payload] ofType:type];
+}
+
+- (void)sendEncodedPayload:(NSData *)encoded ofType:(uint32_t)type
 {
 	// subclasses override this
 }
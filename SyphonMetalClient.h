@@ -39,7 +39,7 @@ NS_ASSUME_NONNULL_BEGIN
  Returns a new client instance for the described server. You should check the isValid property after initialization to ensure a connection was made to the server.
  @param description Typically acquired from the shared SyphonServerDirectory, or one of Syphon's notifications.
  @param device Metal device to create textures on.
- @param options Currently ignored. May be nil.
+ @param options A dictionary containing key-value pairs to specify options for the client. Currently supported options are SyphonClientOptionPixelFormats, SyphonClientOptionFrameHistoryLength, SyphonClientOptionPresentationDelay and SyphonClientOptionReleasesFrames. May be nil.
  @param handler A block which is invoked when a new frame becomes available. handler may be nil. This block may be invoked on a thread other than that on which the client was created.
  @returns A newly initialized SyphonMetalClient object, or nil if a client could not be created.
 */
@@ -55,6 +55,14 @@ Returns a MTLTexture representing the current output from the server. The textur
 */
 - (nullable id<MTLTexture>)newFrameImage;
 
+/*!
+Returns a MTLTexture for the frame to present at the given time, chosen from the client's frame history (see SyphonClientOptionFrameHistoryLength). Frames are chosen so that playout is smooth when the server publishes at a different or irregular rate: the newest frame due by the time is returned, and a frame may be returned for several calls until the next is due. Without a history, this returns the current frame. frameMetadata describes the frame returned.
+
+@param time The time the frame will be presented, on the clock used by SyphonFrameTimestampNow(), for instance the time a display link will show your next frame.
+@returns A MTLTexture, or nil if no frame is available. YOU ARE RESPONSIBLE FOR RELEASING THIS OBJECT when you are finished with it.
+*/
+- (nullable id<MTLTexture>)newFrameImageForPresentationTime:(uint64_t)time;
+
 /*!
 Stops the client from receiving any further frames from the server. Use of this method is optional and releasing all references to the client has the same effect.
 */
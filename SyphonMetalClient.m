@@ -29,9 +29,21 @@
 
 #import "SyphonMetalClient.h"
 #import "SyphonSubclassing.h"
+#import "SyphonServerRendererMetal.h"
 #import <os/lock.h>
 #import <stdatomic.h>
 
+static id<MTLTexture> SyphonMetalClientNewTexture(id<MTLDevice> device, IOSurfaceRef surface)
+{
+    MTLPixelFormat format = SyphonMetalPixelFormatForPixelFormat(IOSurfaceGetPixelFormat(surface));
+    if (format == MTLPixelFormatInvalid)
+    {
+        return nil;
+    }
+    MTLTextureDescriptor* descriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:format width:IOSurfaceGetWidth(surface) height:IOSurfaceGetHeight(surface) mipmapped:NO];
+    return [device newTextureWithDescriptor:descriptor iosurface:surface plane:0];
+}
+
 @implementation SyphonMetalClient
 {
     os_unfair_lock  _threadLock;
@@ -42,6 +54,11 @@
 
 @dynamic isValid, serverDescription, hasNewFrame;
 
++ (NSArray<NSNumber *> *)supportedPixelFormats
+{
+    return @[@(SyphonPixelFormatBGRA8), @(SyphonPixelFormatRGBA16Float), @(SyphonPixelFormatRGB10A2)];
+}
+
 - (id)initWithServerDescription:(NSDictionary<NSString *, id> *)description
                          device:(id<MTLDevice>)theDevice
                         options:(NSDictionary<NSString *, id> *)options
@@ -95,9 +112,7 @@
         IOSurfaceRef surface = [self newSurface];
         if (surface != nil)
         {
-            MTLTextureDescriptor* descriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm width:IOSurfaceGetWidth(surface) height:IOSurfaceGetHeight(surface) mipmapped:NO];
-            _frame = [_device newTextureWithDescriptor:descriptor iosurface:surface plane:0];
-
+            _frame = SyphonMetalClientNewTexture(_device, surface);
             CFRelease(surface);
         }
         
@@ -111,4 +126,19 @@
     return image;
 }
 
+- (id<MTLTexture>)newFrameImageForPresentationTime:(uint64_t)time
+{
+    // Frames from the history are often not the current frame, so aren't cached
+    id<MTLTexture> image = nil;
+    IOSurfaceRef surface = [self newSurfaceForPresentationTime:time];
+    if (surface != nil)
+    {
+        os_unfair_lock_lock(&_threadLock);
+        image = SyphonMetalClientNewTexture(_device, surface);
+        os_unfair_lock_unlock(&_threadLock);
+        CFRelease(surface);
+    }
+    return image;
+}
+
 @end
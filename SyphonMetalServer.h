@@ -54,7 +54,7 @@ extern NSString * const SyphonServerOptionIsPrivate;
 
  @param name Non-unique human readable server name. This is not required and may be `nil`, but is usually used by clients in their UI to aid identification.
  @param device The `MTLDevice` that textures will be valid and available on for publishing.
- @param options A dictionary containing key-value pairs to specify options for the server. The only currently supported option is SyphonServerOptionIsPrivate. See its description for details.
+ @param options A dictionary containing key-value pairs to specify options for the server. Currently supported options are SyphonServerOptionIsPrivate and SyphonServerOptionPixelFormat. SyphonPixelFormatYCbCr420 is not supported by this class. See their descriptions for details.
  @returns A newly intialized SyphonMetalServer. Nil on failure.
 */
 - (id)initWithName:(nullable NSString*)name device:(id<MTLDevice>)device options:(nullable NSDictionary<NSString *, id> *)options;
@@ -89,6 +89,18 @@ A dictionary describing the server. Normally you won't need to access this, howe
 */
 - (void)publishFrameTexture:(id<MTLTexture>)textureToPublish onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer imageRegion:(NSRect)region flipped:(BOOL)isFlipped;
 
+/*!
+ Publishes the part of the texture described in region of the texture to clients, where only the areas within the dirty rects have changed since the previous frame. Only those areas are copied, and clients receive the rects in their ``SyphonClientBase/frameMetadata``. If the server can't reuse its previous frame (for instance because the region's size changed), the entire region is copied.
+
+ @param textureToPublish The `MTLTexture` you wish to publish on the server.
+ @param commandBuffer Your command buffer on which Syphon will write its internal metal commands. You are responsible for comitting this command buffer.
+ @param region The sub-region of the texture to publish.
+ @param dirtyRects An array of rects in the coordinates of the texture which have changed since the previous frame. Rects are clipped to region.
+ @param count The number of rects in dirtyRects. If this is 0 the entire region is published.
+ @param isFlipped `YES` if the texture is vertically flipped in Metal coordinates
+ */
+- (void)publishFrameTexture:(id<MTLTexture>)textureToPublish onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer imageRegion:(NSRect)region dirtyRects:(const NSRect * _Nullable)dirtyRects count:(NSUInteger)count flipped:(BOOL)isFlipped;
+
 /*!
  Returns a `MTLTexture` representing the current output from the server, valid on the server's `MTLDevice`. Call this method every time you wish to access the current server frame. This texture has a limited useful lifetime: you should release it as soon as you are finished drawing with it.
   
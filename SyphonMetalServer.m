@@ -36,6 +36,7 @@
 {
     id<MTLTexture> _surfaceTexture;
     id<MTLDevice> _device;
+    MTLPixelFormat _metalPixelFormat;
     SyphonServerRendererMetal *_renderer;
 }
 
@@ -53,7 +54,12 @@
     {
         _device = theDevice;
         _surfaceTexture = nil;
-        _renderer = [[SyphonServerRendererMetal alloc] initWithDevice:theDevice colorPixelFormat:MTLPixelFormatBGRA8Unorm];
+        _metalPixelFormat = SyphonMetalPixelFormatForPixelFormat(self.pixelFormat);
+        if (_metalPixelFormat == MTLPixelFormatInvalid)
+        {
+            return nil;
+        }
+        _renderer = [[SyphonServerRendererMetal alloc] initWithDevice:theDevice colorPixelFormat:_metalPixelFormat];
         if (!_renderer)
         {
             return nil;
@@ -83,8 +89,17 @@
 }
 
 - (id<MTLTexture>)prepareToDrawFrameOfSize:(NSSize)size
+{
+    return [self prepareToDrawFrameOfSize:size isNew:NULL];
+}
+
+- (id<MTLTexture>)prepareToDrawFrameOfSize:(NSSize)size isNew:(BOOL *)isNew
 {
     @synchronized (self) {
+        if (isNew)
+        {
+            *isNew = NO;
+        }
         BOOL hasSizeChanged = !NSEqualSizes(CGSizeMake(_surfaceTexture.width, _surfaceTexture.height), size);
         if (hasSizeChanged)
         {
@@ -92,7 +107,7 @@
         }
         if(_surfaceTexture == nil)
         {
-            MTLTextureDescriptor *descriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
+            MTLTextureDescriptor *descriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:_metalPixelFormat
                                                                                                   width:size.width
                                                                                                  height:size.height
                                                                                               mipmapped:NO];
@@ -103,6 +118,10 @@
                 _surfaceTexture = [_device newTextureWithDescriptor:descriptor iosurface:surface plane:0];
                 _surfaceTexture.label = @"Syphon Surface Texture";
                 CFRelease(surface);
+                if (isNew)
+                {
+                    *isNew = YES;
+                }
             }
         }
         return _surfaceTexture;
@@ -135,6 +154,11 @@
 }
 
 - (void)publishFrameTexture:(id<MTLTexture>)textureToPublish onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer imageRegion:(NSRect)region flipped:(BOOL)isFlipped
+{
+    [self publishFrameTexture:textureToPublish onCommandBuffer:commandBuffer imageRegion:region dirtyRects:NULL count:0 flipped:isFlipped];
+}
+
+- (void)publishFrameTexture:(id<MTLTexture>)textureToPublish onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer imageRegion:(NSRect)region dirtyRects:(const NSRect *)dirtyRects count:(NSUInteger)count flipped:(BOOL)isFlipped
 {
     if(textureToPublish == nil) {
         SYPHONLOG(@"TextureToPublish is nil. Syphon will not publish");
@@ -143,7 +167,20 @@
     
     region = NSIntersectionRect(region, NSMakeRect(0, 0, textureToPublish.width, textureToPublish.height));
     
-    id<MTLTexture> destination = [self prepareToDrawFrameOfSize:region.size];
+    BOOL isNew;
+    id<MTLTexture> destination = [self prepareToDrawFrameOfSize:region.size isNew:&isNew];
+    
+    // A new surface has no previous frame to update, so must be drawn in full
+    NSRect *rects = NULL;
+    if (count && !isNew)
+    {
+        rects = malloc(sizeof(NSRect) * count);
+        count = SyphonDirtyRectsToSurface(dirtyRects, count, region, isFlipped, rects);
+    }
+    else
+    {
+        count = 0;
+    }
     
     // When possible, use faster blit
     if( !isFlipped && textureToPublish.pixelFormat == destination.pixelFormat
@@ -152,26 +189,45 @@
     {
         id<MTLBlitCommandEncoder> blitCommandEncoder = [commandBuffer blitCommandEncoder];
         blitCommandEncoder.label = @"Syphon Server Optimised Blit commandEncoder";
-        [blitCommandEncoder copyFromTexture:textureToPublish
-                                sourceSlice:0
-                                sourceLevel:0
-                               sourceOrigin:MTLOriginMake(region.origin.x, region.origin.y, 0)
-                                 sourceSize:MTLSizeMake(region.size.width, region.size.height, 1)
-                                  toTexture:destination
-                           destinationSlice:0
-                           destinationLevel:0
-                          destinationOrigin:MTLOriginMake(0, 0, 0)];
+        if (count == 0)
+        {
+            [blitCommandEncoder copyFromTexture:textureToPublish
+                                    sourceSlice:0
+                                    sourceLevel:0
+                                   sourceOrigin:MTLOriginMake(region.origin.x, region.origin.y, 0)
+                                     sourceSize:MTLSizeMake(region.size.width, region.size.height, 1)
+                                      toTexture:destination
+                               destinationSlice:0
+                               destinationLevel:0
+                              destinationOrigin:MTLOriginMake(0, 0, 0)];
+        }
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            [blitCommandEncoder copyFromTexture:textureToPublish
+                                    sourceSlice:0
+                                    sourceLevel:0
+                                   sourceOrigin:MTLOriginMake(region.origin.x + rects[i].origin.x, region.origin.y + rects[i].origin.y, 0)
+                                     sourceSize:MTLSizeMake(rects[i].size.width, rects[i].size.height, 1)
+                                      toTexture:destination
+                               destinationSlice:0
+                               destinationLevel:0
+                              destinationOrigin:MTLOriginMake(rects[i].origin.x, rects[i].origin.y, 0)];
+        }
 
         [blitCommandEncoder endEncoding];
     }
     // otherwise, re-draw the frame
     else
     {
-        [_renderer renderFromTexture:textureToPublish inTexture:destination region:region onCommandBuffer:commandBuffer flip:isFlipped];
+        [_renderer renderFromTexture:textureToPublish inTexture:destination region:region dirtyRects:rects count:count onCommandBuffer:commandBuffer flip:isFlipped];
     }
     
+    // Claim metadata now so it matches this frame even if another is encoded before this one completes
+    SyphonFrameMetadata metadata = [self metadataForNewFrame];
+    SyphonFrameMetadataSetDirtyRects(&metadata, rects, count);
+    free(rects);
     [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> _Nonnull commandBuffer) {
-        [self publish];
+        [self publishWithFrameMetadata:metadata];
     }];
 }
 
@@ -49,7 +49,7 @@ NS_ASSUME_NONNULL_BEGIN
  Returns a new client instance for the described server. You should check the isValid property after initialization to ensure a connection was made to the server.
  @param description Typically acquired from the shared SyphonServerDirectory, or one of Syphon's notifications.
  @param context The CGLContextObj context to create textures for.
- @param options Currently ignored. May be nil.
+ @param options A dictionary containing key-value pairs to specify options for the client. Currently supported options are SyphonClientOptionPixelFormats. May be nil.
  @param handler A block which is invoked when a new frame becomes available. handler may be nil. This block may be invoked on a thread other than that on which the client was created.
  @returns A newly initialized SyphonOpenGLClient object, or nil if a client could not be created.
 */
@@ -49,6 +49,11 @@
 
 @dynamic isValid, serverDescription, hasNewFrame;
 
++ (NSArray<NSNumber *> *)supportedPixelFormats
+{
+    return @[@(SyphonPixelFormatBGRA8), @(SyphonPixelFormatRGBA16Float), @(SyphonPixelFormatRGB10A2)];
+}
+
 #if SYPHON_DEBUG_NO_DRAWING
 + (void)load
 {
@@ -33,6 +33,10 @@
 #import <stdlib.h>
 #import <string.h>
 
+// These may not be declared by the legacy headers
+#define SYPHON_GL_RGBA16F   0x881A
+#define SYPHON_GL_HALF_FLOAT 0x140B
+
 GLboolean SyphonOpenGLContextSupportsExtension(CGLContextObj cgl_ctx, const char *extension)
 {
 	const GLubyte *extensions = NULL;
@@ -65,3 +69,26 @@ GLboolean SyphonOpenGLContextSupportsExtension(CGLContextObj cgl_ctx, const char
 	return GL_FALSE;
 }
 
+GLboolean SyphonOpenGLGetFormatsForPixelFormat(OSType pixelFormat, GLenum *internalFormat, GLenum *format, GLenum *type)
+{
+	switch (pixelFormat) {
+		case 0: // Surfaces from older servers don't set a format
+		case 'BGRA':
+			*internalFormat = GL_RGBA8;
+			*format = GL_BGRA;
+			*type = GL_UNSIGNED_INT_8_8_8_8_REV;
+			return GL_TRUE;
+		case 'RGhA':
+			*internalFormat = SYPHON_GL_RGBA16F;
+			*format = GL_RGBA;
+			*type = SYPHON_GL_HALF_FLOAT;
+			return GL_TRUE;
+		case 'l10r':
+			*internalFormat = GL_RGB10_A2;
+			*format = GL_BGRA;
+			*type = GL_UNSIGNED_INT_2_10_10_10_REV;
+			return GL_TRUE;
+		default:
+			return GL_FALSE;
+	}
+}
@@ -31,3 +31,10 @@
 #import <OpenGL/OpenGL.h>
 
 GLboolean SyphonOpenGLContextSupportsExtension(CGLContextObj cgl_ctx, const char *extension);
+
+/*
+ SyphonOpenGLGetFormatsForPixelFormat
+	Sets the internal format, format and type to use with CGLTexImageIOSurface2D() for surfaces with the given
+	SyphonPixelFormat. Returns GL_FALSE if the pixel format can't be used as a single GL texture.
+ */
+GLboolean SyphonOpenGLGetFormatsForPixelFormat(OSType pixelFormat, GLenum *internalFormat, GLenum *format, GLenum *type);
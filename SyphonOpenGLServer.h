@@ -77,7 +77,7 @@ extern NSString * const SyphonServerOptionStencilBufferResolution;
 
  @param serverName Non-unique human readable server name. This is not required and may be `nil`, but is usually used by clients in their UI to aid identification.
  @param context The `CGLContextObj` context that textures will be valid and available on for publishing.
- @param options A dictionary containing key-value pairs to specify options for the server.
+ @param options A dictionary containing key-value pairs to specify options for the server. SyphonServerOptionPixelFormat is supported for every format except SyphonPixelFormatYCbCr420.
  @returns A newly intialized ``SyphonOpenGLServer``. `nil` on failure.
 */
 - (instancetype)initWithName:(nullable NSString*)serverName context:(CGLContextObj)context options:(nullable NSDictionary<NSString *, id> *)options;
@@ -117,6 +117,19 @@ extern NSString * const SyphonServerOptionStencilBufferResolution;
 */
 - (void)publishFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped;
 
+/*!
+ Publishes the part of the texture described in region of the named texture to clients, where only the areas within the dirty rects have changed since the previous frame. Only those areas are drawn, and clients receive the rects in their ``SyphonClientBase/frameMetadata``. If the server can't reuse its previous frame (for instance because the region's size changed), the entire region is drawn. Otherwise this method behaves as ``publishFrameTexture:textureTarget:imageRegion:textureDimensions:flipped:``.
+
+ @param texID The name of the texture to publish, which must be a texture valid in the CGL context provided when the server was created.
+ @param target `GL_TEXTURE_RECTANGLE_EXT` or `GL_TEXTURE_2D`.
+ @param region The sub-region of the texture to publish.
+ @param dirtyRects An array of rects in the coordinates of the texture which have changed since the previous frame. Rects are clipped to region.
+ @param count The number of rects in dirtyRects. If this is 0 the entire region is published.
+ @param size The full size of the texture
+ @param isFlipped Is the texture flipped?
+ */
+- (void)publishFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region dirtyRects:(const NSRect * _Nullable)dirtyRects count:(NSUInteger)count textureDimensions:(NSSize)size flipped:(BOOL)isFlipped;
+
 /*! 
  Binds an FBO for you to publish a frame of the given dimensions by drawing into the server's context (check it using the context property). If YES is returned, you must pair this with a call to ``unbindAndPublish`` once you have finished drawing. If NO is returned you should abandon drawing and not call ``unbindAndPublish``.
 
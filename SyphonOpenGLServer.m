@@ -34,6 +34,7 @@
 #import "SyphonServerRendererCoreGL.h"
 #import "SyphonPrivate.h"
 #import "SyphonCGL.h"
+#import "SyphonOpenGLFunctions.h"
 #import "SyphonSubclassing.h"
 #import <Cocoa/Cocoa.h>
 #import <IOSurface/IOSurface.h>
@@ -88,7 +89,9 @@
     self = [super initWithName:serverName options:options];
 	if(self)
 	{
-		if (context == NULL)
+		GLenum internalFormat, format, type;
+		if (context == NULL
+			|| !SyphonOpenGLGetFormatsForPixelFormat(self.pixelFormat, &internalFormat, &format, &type))
 		{
 			return nil;
 		}
@@ -131,6 +134,7 @@
             CGLReleaseContext(context);
 #endif
         }
+        _renderer.colorBufferFormat = internalFormat;
 	}
 	return self;
 }
@@ -198,6 +202,11 @@
 }
 
 - (void)unbindAndPublish
+{
+    [self unbindAndPublishDirtyRects:NULL count:0];
+}
+
+- (void)unbindAndPublishDirtyRects:(const NSRect *)rects count:(NSUInteger)count
 {
 #if !SYPHON_DEBUG_NO_DRAWING
     [_renderer unbind];
@@ -212,19 +221,38 @@
 #endif // SYPHON_DEBUG_NO_DRAWING
 		_pushPending = NO;
 	}
-    [self publish];
+    SyphonFrameMetadata metadata = [self metadataForNewFrame];
+    SyphonFrameMetadataSetDirtyRects(&metadata, rects, count);
+    [self publishWithFrameMetadata:metadata];
 }
 
 - (void)publishFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped
+{
+    [self publishFrameTexture:texID textureTarget:target imageRegion:region dirtyRects:NULL count:0 textureDimensions:size flipped:isFlipped];
+}
+
+- (void)publishFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region dirtyRects:(const NSRect *)dirtyRects count:(NSUInteger)count textureDimensions:(NSSize)size flipped:(BOOL)isFlipped
 {
     [_renderer beginInContext];
 	if(texID != 0 && ((target == SYPHON_GL_TEXTURE_2D) || (target == SYPHON_GL_TEXTURE_RECT)) &&
        [self bindToDrawFrameOfSize:region.size inContext:YES])
 	{
+        // A new surface has no previous frame to update, so must be drawn in full
+        NSRect *rects = NULL;
+        if (count && !_pushPending)
+        {
+            rects = malloc(sizeof(NSRect) * count);
+            count = SyphonDirtyRectsToSurface(dirtyRects, count, region, isFlipped, rects);
+        }
+        else
+        {
+            count = 0;
+        }
 #if !SYPHON_DEBUG_NO_DRAWING
-        [_renderer drawFrameTexture:texID textureTarget:target imageRegion:region textureDimensions:size flipped:isFlipped];
+        [_renderer drawFrameTexture:texID textureTarget:target imageRegion:region textureDimensions:size flipped:isFlipped dirtyRects:rects count:count];
 #endif // SYPHON_DEBUG_NO_DRAWING
-		[self unbindAndPublish];
+		[self unbindAndPublishDirtyRects:rects count:count];
+        free(rects);
 	}
     [_renderer endInContext];
 }
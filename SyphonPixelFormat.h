@@ -0,0 +1,54 @@
+/*
+    SyphonPixelFormat.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <Foundation/Foundation.h>
+
+/*!
+ Pixel formats Syphon servers can publish frames in. The values match the equivalent CoreVideo and IOSurface pixel format types.
+
+ Formats other than SyphonPixelFormatBGRA8 can only be received by clients built with a version of the framework which supports them.
+ */
+typedef NS_ENUM(OSType, SyphonPixelFormat) {
+    /*!
+     8 bits per component BGRA. Every server and client supports this format, and it is the default.
+     */
+    SyphonPixelFormatBGRA8 = 'BGRA',
+    /*!
+     16-bit half-float per component RGBA, for high dynamic range or wide-gamut content. Uses twice the memory bandwidth of SyphonPixelFormatBGRA8.
+     */
+    SyphonPixelFormatRGBA16Float = 'RGhA',
+    /*!
+     10 bits per color component and 2 bits of alpha, packed into 32 bits per pixel in little-endian BGRA order.
+     */
+    SyphonPixelFormatRGB10A2 = 'l10r',
+    /*!
+     Bi-planar 4:2:0 video-range Y'CbCr, with a full resolution luma plane and a half resolution interleaved chroma plane. Uses 12 bits per pixel.
+     */
+    SyphonPixelFormatYCbCr420 = '420v'
+};
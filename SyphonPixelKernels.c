@@ -0,0 +1,872 @@
+/*
+    SyphonPixelKernels.c
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "SyphonPixelKernels.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SYPHON_PIXEL_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define SYPHON_PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+/*
+ Each kernel operates on a row of pixels (or components), and the plane functions below call them for each row.
+ */
+typedef struct SyphonPixelRowKernels {
+    void (*swapRedBlue)(uint8_t *dst, const uint8_t *src, size_t width);
+    void (*premultiply)(uint8_t *dst, const uint8_t *src, size_t width);
+    void (*unpremultiply)(uint8_t *dst, const uint8_t *src, size_t width);
+    void (*luma)(uint8_t *dst, const uint8_t *src, size_t width);
+    void (*u8ToHalf)(uint16_t *dst, const uint8_t *src, size_t count);
+    void (*halfToU8)(uint8_t *dst, const uint16_t *src, size_t count);
+    void (*accumulate)(uint16_t *sums, const uint8_t *src, size_t count);
+} SyphonPixelRowKernels;
+
+/*
+ BT.709 video-range coefficients, scaled by 256. Each row of the matrix sums to the scale of its output range so
+ that grays have no chroma.
+ */
+#define SYPHON_Y_R 47
+#define SYPHON_Y_G 157
+#define SYPHON_Y_B 16
+#define SYPHON_CB_R -26
+#define SYPHON_CB_G -86
+#define SYPHON_CB_B 112
+#define SYPHON_CR_R 112
+#define SYPHON_CR_G -102
+#define SYPHON_CR_B -10
+
+#pragma mark Portable
+
+static void SyphonPixelSwapRedBlueScalar(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    for (size_t i = 0; i < width; i++)
+    {
+        uint8_t b = src[i * 4];
+        uint8_t g = src[i * 4 + 1];
+        uint8_t r = src[i * 4 + 2];
+        uint8_t a = src[i * 4 + 3];
+        dst[i * 4] = r;
+        dst[i * 4 + 1] = g;
+        dst[i * 4 + 2] = b;
+        dst[i * 4 + 3] = a;
+    }
+}
+
+static inline uint8_t SyphonPixelMultiplyDiv255(uint32_t c, uint32_t a)
+{
+    // Exactly rounded c * a / 255
+    uint32_t t = c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+static void SyphonPixelPremultiplyScalar(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    for (size_t i = 0; i < width; i++)
+    {
+        uint8_t a = src[i * 4 + 3];
+        dst[i * 4] = SyphonPixelMultiplyDiv255(src[i * 4], a);
+        dst[i * 4 + 1] = SyphonPixelMultiplyDiv255(src[i * 4 + 1], a);
+        dst[i * 4 + 2] = SyphonPixelMultiplyDiv255(src[i * 4 + 2], a);
+        dst[i * 4 + 3] = a;
+    }
+}
+
+static inline uint8_t SyphonPixelUnpremultiplyComponent(uint8_t c, float scale)
+{
+    // Matches the vectorized implementations, which round to nearest even
+    float v = nearbyintf((float)c * scale);
+    return (uint8_t)(v > 255.0f ? 255.0f : v);
+}
+
+static void SyphonPixelUnpremultiplyScalar(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    for (size_t i = 0; i < width; i++)
+    {
+        uint8_t a = src[i * 4 + 3];
+        float scale = a == 0 ? 0.0f : 255.0f / (float)a;
+        dst[i * 4] = SyphonPixelUnpremultiplyComponent(src[i * 4], scale);
+        dst[i * 4 + 1] = SyphonPixelUnpremultiplyComponent(src[i * 4 + 1], scale);
+        dst[i * 4 + 2] = SyphonPixelUnpremultiplyComponent(src[i * 4 + 2], scale);
+        dst[i * 4 + 3] = a;
+    }
+}
+
+static inline uint8_t SyphonPixelLuma(int32_t b, int32_t g, int32_t r)
+{
+    return (uint8_t)(16 + ((SYPHON_Y_R * r + SYPHON_Y_G * g + SYPHON_Y_B * b + 128) >> 8));
+}
+
+static void SyphonPixelLumaScalar(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    for (size_t i = 0; i < width; i++)
+    {
+        dst[i] = SyphonPixelLuma(src[i * 4], src[i * 4 + 1], src[i * 4 + 2]);
+    }
+}
+
+static uint16_t SyphonPixelFloatToHalf(float f)
+{
+    // Round to nearest even, as the hardware conversions do
+    union { float f; uint32_t u; } v = { f };
+    uint32_t sign = (v.u >> 16) & 0x8000U;
+    uint32_t abs = v.u & 0x7FFFFFFFU;
+    if (abs >= 0x7F800000U)
+    {
+        // Infinity or NaN
+        return (uint16_t)(sign | 0x7C00U | (abs > 0x7F800000U ? 0x200U : 0));
+    }
+    if (abs >= 0x477FF000U)
+    {
+        // Rounds to infinity
+        return (uint16_t)(sign | 0x7C00U);
+    }
+    if (abs < 0x38800000U)
+    {
+        // Subnormal or zero: let the FPU round by adding a value which aligns the result's bits
+        union { float f; uint32_t u; } d = { .u = abs };
+        d.f += 0.5f;
+        return (uint16_t)(sign | (d.u - 0x3F000000U));
+    }
+    uint32_t mantissaOdd = (abs >> 13) & 1U;
+    abs += 0xC8000FFFU + mantissaOdd; // rebias the exponent and round
+    return (uint16_t)(sign | (abs >> 13));
+}
+
+static float SyphonPixelHalfToFloat(uint16_t h)
+{
+    union { float f; uint32_t u; } v;
+    uint32_t sign = (uint32_t)(h & 0x8000U) << 16;
+    uint32_t exponent = (h >> 10) & 0x1FU;
+    uint32_t mantissa = h & 0x3FFU;
+    if (exponent == 0)
+    {
+        // Zero or subnormal
+        v.f = (float)mantissa * (1.0f / 16777216.0f);
+        v.u |= sign;
+    }
+    else if (exponent == 0x1FU)
+    {
+        v.u = sign | 0x7F800000U | (mantissa << 13);
+    }
+    else
+    {
+        v.u = sign | ((exponent + 112U) << 23) | (mantissa << 13);
+    }
+    return v.f;
+}
+
+static uint16_t SyphonPixelU8ToHalfTable[256];
+
+static void SyphonPixelU8ToHalfScalar(uint16_t *dst, const uint8_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = SyphonPixelU8ToHalfTable[src[i]];
+    }
+}
+
+static inline uint8_t SyphonPixelFloatToU8(float f)
+{
+    f *= 255.0f;
+    if (!(f > 0.0f)) f = 0.0f; // also catches NaN
+    if (f > 255.0f) f = 255.0f;
+    return (uint8_t)nearbyintf(f);
+}
+
+static void SyphonPixelHalfToU8Scalar(uint8_t *dst, const uint16_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = SyphonPixelFloatToU8(SyphonPixelHalfToFloat(src[i]));
+    }
+}
+
+static void SyphonPixelAccumulateScalar(uint16_t *sums, const uint8_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        sums[i] += src[i];
+    }
+}
+
+#if SYPHON_PIXEL_X86
+
+#pragma mark SSE2
+
+static void SyphonPixelSwapRedBlueSSE2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    const __m128i keep = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i low = _mm_set1_epi32(0xFF);
+    size_t i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i swapped = _mm_or_si128(_mm_and_si128(p, keep),
+                                       _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), low),
+                                                    _mm_slli_epi32(_mm_and_si128(p, low), 16)));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), swapped);
+    }
+    SyphonPixelSwapRedBlueScalar(dst + i * 4, src + i * 4, width - i);
+}
+
+// Multiplies two pixels unpacked to 16 bits per component by their alpha
+static inline __m128i SyphonPixelPremultiplySSE2Pair(__m128i p)
+{
+    const __m128i colorLanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, 0xFF), 0xFF);
+    // Alpha is multiplied by 255, and so unchanged
+    a = _mm_or_si128(_mm_and_si128(a, colorLanes), alphaLanes);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(p, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static void SyphonPixelPremultiplySSE2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i lo = SyphonPixelPremultiplySSE2Pair(_mm_unpacklo_epi8(p, zero));
+        __m128i hi = SyphonPixelPremultiplySSE2Pair(_mm_unpackhi_epi8(p, zero));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_packus_epi16(lo, hi));
+    }
+    SyphonPixelPremultiplyScalar(dst + i * 4, src + i * 4, width - i);
+}
+
+// Unpremultiplies one pixel with 32 bits per component
+static inline __m128i SyphonPixelUnpremultiplySSE2Pixel(__m128i p)
+{
+    const __m128i alphaLane = _mm_set_epi32(-1, 0, 0, 0);
+    __m128 a = _mm_cvtepi32_ps(_mm_shuffle_epi32(p, 0xFF));
+    __m128 scale = _mm_andnot_ps(_mm_cmpeq_ps(a, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(255.0f), a));
+    __m128i c = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(p), scale));
+    // Keep alpha, the pack which follows saturates color to 255
+    return _mm_or_si128(_mm_andnot_si128(alphaLane, c), _mm_and_si128(alphaLane, p));
+}
+
+static void SyphonPixelUnpremultiplySSE2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= width; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i lo = _mm_unpacklo_epi8(p, zero);
+        __m128i hi = _mm_unpackhi_epi8(p, zero);
+        __m128i p0 = SyphonPixelUnpremultiplySSE2Pixel(_mm_unpacklo_epi16(lo, zero));
+        __m128i p1 = SyphonPixelUnpremultiplySSE2Pixel(_mm_unpackhi_epi16(lo, zero));
+        __m128i p2 = SyphonPixelUnpremultiplySSE2Pixel(_mm_unpacklo_epi16(hi, zero));
+        __m128i p3 = SyphonPixelUnpremultiplySSE2Pixel(_mm_unpackhi_epi16(hi, zero));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), packed);
+    }
+    SyphonPixelUnpremultiplyScalar(dst + i * 4, src + i * 4, width - i);
+}
+
+// Computes luma for four pixels, returned as 32-bit values
+static inline __m128i SyphonPixelLumaSSE2Quad(__m128i p)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i coefficients = _mm_set_epi16(0, SYPHON_Y_R, SYPHON_Y_G, SYPHON_Y_B, 0, SYPHON_Y_R, SYPHON_Y_G, SYPHON_Y_B);
+    // Each 32-bit lane has B * Yb + G * Yg or R * Yr for one pixel
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), coefficients);
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(p, zero), coefficients);
+    lo = _mm_shuffle_epi32(_mm_add_epi32(lo, _mm_srli_epi64(lo, 32)), _MM_SHUFFLE(3, 3, 2, 0));
+    hi = _mm_shuffle_epi32(_mm_add_epi32(hi, _mm_srli_epi64(hi, 32)), _MM_SHUFFLE(3, 3, 2, 0));
+    __m128i sum = _mm_unpacklo_epi64(lo, hi);
+    return _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8), _mm_set1_epi32(16));
+}
+
+static void SyphonPixelLumaSSE2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t i = 0;
+    for (; i + 16 <= width; i += 16)
+    {
+        __m128i y0 = SyphonPixelLumaSSE2Quad(_mm_loadu_si128((const __m128i *)(src + i * 4)));
+        __m128i y1 = SyphonPixelLumaSSE2Quad(_mm_loadu_si128((const __m128i *)(src + i * 4 + 16)));
+        __m128i y2 = SyphonPixelLumaSSE2Quad(_mm_loadu_si128((const __m128i *)(src + i * 4 + 32)));
+        __m128i y3 = SyphonPixelLumaSSE2Quad(_mm_loadu_si128((const __m128i *)(src + i * 4 + 48)));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(y0, y1), _mm_packs_epi32(y2, y3));
+        _mm_storeu_si128((__m128i *)(dst + i), packed);
+    }
+    SyphonPixelLumaScalar(dst + i, src + i * 4, width - i);
+}
+
+static void SyphonPixelAccumulateSSE2(uint16_t *sums, const uint8_t *src, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(sums + i)), _mm_unpacklo_epi8(p, zero));
+        __m128i hi = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(sums + i + 8)), _mm_unpackhi_epi8(p, zero));
+        _mm_storeu_si128((__m128i *)(sums + i), lo);
+        _mm_storeu_si128((__m128i *)(sums + i + 8), hi);
+    }
+    SyphonPixelAccumulateScalar(sums + i, src + i, count - i);
+}
+
+#pragma mark AVX2
+
+__attribute__((target("avx2")))
+static void SyphonPixelSwapRedBlueAVX2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                             2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i * 4));
+        _mm256_storeu_si256((__m256i *)(dst + i * 4), _mm256_shuffle_epi8(p, shuffle));
+    }
+    SyphonPixelSwapRedBlueSSE2(dst + i * 4, src + i * 4, width - i);
+}
+
+__attribute__((target("avx2")))
+static void SyphonPixelPremultiplyAVX2(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    // Unpack and pack operate within each 128-bit lane, so pixels stay in order
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alphaShuffle = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1,
+                                                  6, 7, 6, 7, 6, 7, -1, -1, 14, 15, 14, 15, 14, 15, -1, -1);
+    const __m256i alphaLanes = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+    const __m256i half = _mm256_set1_epi16(128);
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(src + i * 4));
+        __m256i lo = _mm256_unpacklo_epi8(p, zero);
+        __m256i hi = _mm256_unpackhi_epi8(p, zero);
+        __m256i aLo = _mm256_or_si256(_mm256_shuffle_epi8(lo, alphaShuffle), alphaLanes);
+        __m256i aHi = _mm256_or_si256(_mm256_shuffle_epi8(hi, alphaShuffle), alphaLanes);
+        __m256i tLo = _mm256_add_epi16(_mm256_mullo_epi16(lo, aLo), half);
+        __m256i tHi = _mm256_add_epi16(_mm256_mullo_epi16(hi, aHi), half);
+        lo = _mm256_srli_epi16(_mm256_add_epi16(tLo, _mm256_srli_epi16(tLo, 8)), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(tHi, _mm256_srli_epi16(tHi, 8)), 8);
+        _mm256_storeu_si256((__m256i *)(dst + i * 4), _mm256_packus_epi16(lo, hi));
+    }
+    SyphonPixelPremultiplySSE2(dst + i * 4, src + i * 4, width - i);
+}
+
+__attribute__((target("avx2,f16c")))
+static void SyphonPixelU8ToHalfAVX2(uint16_t *dst, const uint8_t *src, size_t count)
+{
+    const __m256 max = _mm256_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src + i)));
+        __m256 f = _mm256_div_ps(_mm256_cvtepi32_ps(c), max);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    }
+    SyphonPixelU8ToHalfScalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2,f16c")))
+static void SyphonPixelHalfToU8AVX2(uint8_t *dst, const uint16_t *src, size_t count)
+{
+    const __m256 max = _mm256_set1_ps(255.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256 f0 = _mm256_mul_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))), max);
+        __m256 f1 = _mm256_mul_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i + 8))), max);
+        // max returns its second operand for NaN
+        f0 = _mm256_min_ps(_mm256_max_ps(f0, _mm256_setzero_ps()), max);
+        f1 = _mm256_min_ps(_mm256_max_ps(f1, _mm256_setzero_ps()), max);
+        __m256i c = _mm256_packs_epi32(_mm256_cvtps_epi32(f0), _mm256_cvtps_epi32(f1));
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(3, 1, 2, 0));
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(c), _mm256_extracti128_si256(c, 1));
+        _mm_storeu_si128((__m128i *)(dst + i), packed);
+    }
+    SyphonPixelHalfToU8Scalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void SyphonPixelAccumulateAVX2(uint16_t *sums, const uint8_t *src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i p = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + i)));
+        __m256i sum = _mm256_add_epi16(_mm256_loadu_si256((const __m256i *)(sums + i)), p);
+        _mm256_storeu_si256((__m256i *)(sums + i), sum);
+    }
+    SyphonPixelAccumulateScalar(sums + i, src + i, count - i);
+}
+
+#endif
+
+#if SYPHON_PIXEL_NEON
+
+#pragma mark NEON
+
+static void SyphonPixelSwapRedBlueNEON(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t i = 0;
+    for (; i + 16 <= width; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(src + i * 4);
+        uint8x16_t b = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = b;
+        vst4q_u8(dst + i * 4, p);
+    }
+    SyphonPixelSwapRedBlueScalar(dst + i * 4, src + i * 4, width - i);
+}
+
+static inline uint8x8_t SyphonPixelMultiplyDiv255NEON(uint8x8_t c, uint8x8_t a)
+{
+    uint16x8_t t = vmull_u8(c, a);
+    // (t + 128 + ((t + 128) >> 8)) >> 8
+    return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+}
+
+static void SyphonPixelPremultiplyNEON(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        p.val[0] = SyphonPixelMultiplyDiv255NEON(p.val[0], p.val[3]);
+        p.val[1] = SyphonPixelMultiplyDiv255NEON(p.val[1], p.val[3]);
+        p.val[2] = SyphonPixelMultiplyDiv255NEON(p.val[2], p.val[3]);
+        vst4_u8(dst + i * 4, p);
+    }
+    SyphonPixelPremultiplyScalar(dst + i * 4, src + i * 4, width - i);
+}
+
+static inline uint16x4_t SyphonPixelUnpremultiplyNEONQuad(uint16x4_t c, float32x4_t scale)
+{
+    uint32x4_t v = vcvtnq_u32_f32(vmulq_f32(vcvtq_f32_u32(vmovl_u16(c)), scale));
+    return vmovn_u32(vminq_u32(v, vdupq_n_u32(255)));
+}
+
+static void SyphonPixelUnpremultiplyNEON(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        uint16x8_t a = vmovl_u8(p.val[3]);
+        float32x4_t aLo = vcvtq_f32_u32(vmovl_u16(vget_low_u16(a)));
+        float32x4_t aHi = vcvtq_f32_u32(vmovl_u16(vget_high_u16(a)));
+        float32x4_t sLo = vdivq_f32(vdupq_n_f32(255.0f), aLo);
+        float32x4_t sHi = vdivq_f32(vdupq_n_f32(255.0f), aHi);
+        // Zero alpha gives infinite scale, which becomes zero
+        sLo = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(sLo), vceqq_f32(aLo, vdupq_n_f32(0.0f))));
+        sHi = vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(sHi), vceqq_f32(aHi, vdupq_n_f32(0.0f))));
+        for (int channel = 0; channel < 3; channel++)
+        {
+            uint16x8_t c = vmovl_u8(p.val[channel]);
+            uint16x4_t lo = SyphonPixelUnpremultiplyNEONQuad(vget_low_u16(c), sLo);
+            uint16x4_t hi = SyphonPixelUnpremultiplyNEONQuad(vget_high_u16(c), sHi);
+            p.val[channel] = vmovn_u16(vcombine_u16(lo, hi));
+        }
+        vst4_u8(dst + i * 4, p);
+    }
+    SyphonPixelUnpremultiplyScalar(dst + i * 4, src + i * 4, width - i);
+}
+
+static void SyphonPixelLumaNEON(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8)
+    {
+        uint8x8x4_t p = vld4_u8(src + i * 4);
+        uint16x8_t y = vmull_u8(p.val[2], vdup_n_u8(SYPHON_Y_R));
+        y = vmlal_u8(y, p.val[1], vdup_n_u8(SYPHON_Y_G));
+        y = vmlal_u8(y, p.val[0], vdup_n_u8(SYPHON_Y_B));
+        vst1_u8(dst + i, vadd_u8(vrshrn_n_u16(y, 8), vdup_n_u8(16)));
+    }
+    SyphonPixelLumaScalar(dst + i, src + i * 4, width - i);
+}
+
+static void SyphonPixelU8ToHalfNEON(uint16_t *dst, const uint8_t *src, size_t count)
+{
+    const float32x4_t max = vdupq_n_f32(255.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t c = vmovl_u8(vld1_u8(src + i));
+        float32x4_t lo = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(c))), max);
+        float32x4_t hi = vdivq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(c))), max);
+        float16x8_t h = vcombine_f16(vcvt_f16_f32(lo), vcvt_f16_f32(hi));
+        vst1q_u16(dst + i, vreinterpretq_u16_f16(h));
+    }
+    SyphonPixelU8ToHalfScalar(dst + i, src + i, count - i);
+}
+
+static void SyphonPixelHalfToU8NEON(uint8_t *dst, const uint16_t *src, size_t count)
+{
+    const float32x4_t max = vdupq_n_f32(255.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        float16x8_t h = vreinterpretq_f16_u16(vld1q_u16(src + i));
+        float32x4_t lo = vmulq_f32(vcvt_f32_f16(vget_low_f16(h)), max);
+        float32x4_t hi = vmulq_f32(vcvt_f32_f16(vget_high_f16(h)), max);
+        // maxnm returns the number when one operand is NaN
+        lo = vminq_f32(vmaxnmq_f32(lo, vdupq_n_f32(0.0f)), max);
+        hi = vminq_f32(vmaxnmq_f32(hi, vdupq_n_f32(0.0f)), max);
+        uint16x8_t c = vcombine_u16(vmovn_u32(vcvtnq_u32_f32(lo)), vmovn_u32(vcvtnq_u32_f32(hi)));
+        vst1_u8(dst + i, vmovn_u16(c));
+    }
+    SyphonPixelHalfToU8Scalar(dst + i, src + i, count - i);
+}
+
+static void SyphonPixelAccumulateNEON(uint16_t *sums, const uint8_t *src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u16(sums + i, vaddw_u8(vld1q_u16(sums + i), vld1_u8(src + i)));
+    }
+    SyphonPixelAccumulateScalar(sums + i, src + i, count - i);
+}
+
+#endif
+
+#pragma mark Dispatch
+
+static SyphonPixelRowKernels SyphonPixelKernels;
+static pthread_once_t SyphonPixelKernelsOnce = PTHREAD_ONCE_INIT;
+
+static void SyphonPixelKernelsInit(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        SyphonPixelU8ToHalfTable[i] = SyphonPixelFloatToHalf((float)i / 255.0f);
+    }
+    SyphonPixelRowKernels kernels = {
+        SyphonPixelSwapRedBlueScalar,
+        SyphonPixelPremultiplyScalar,
+        SyphonPixelUnpremultiplyScalar,
+        SyphonPixelLumaScalar,
+        SyphonPixelU8ToHalfScalar,
+        SyphonPixelHalfToU8Scalar,
+        SyphonPixelAccumulateScalar
+    };
+#if SYPHON_PIXEL_X86
+    // SSE2 is present on every x86-64 CPU
+    kernels.swapRedBlue = SyphonPixelSwapRedBlueSSE2;
+    kernels.premultiply = SyphonPixelPremultiplySSE2;
+    kernels.unpremultiply = SyphonPixelUnpremultiplySSE2;
+    kernels.luma = SyphonPixelLumaSSE2;
+    kernels.accumulate = SyphonPixelAccumulateSSE2;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernels.swapRedBlue = SyphonPixelSwapRedBlueAVX2;
+        kernels.premultiply = SyphonPixelPremultiplyAVX2;
+        // Every CPU with AVX2 also has F16C
+        kernels.u8ToHalf = SyphonPixelU8ToHalfAVX2;
+        kernels.halfToU8 = SyphonPixelHalfToU8AVX2;
+        kernels.accumulate = SyphonPixelAccumulateAVX2;
+    }
+#elif SYPHON_PIXEL_NEON
+    kernels.swapRedBlue = SyphonPixelSwapRedBlueNEON;
+    kernels.premultiply = SyphonPixelPremultiplyNEON;
+    kernels.unpremultiply = SyphonPixelUnpremultiplyNEON;
+    kernels.luma = SyphonPixelLumaNEON;
+    kernels.u8ToHalf = SyphonPixelU8ToHalfNEON;
+    kernels.halfToU8 = SyphonPixelHalfToU8NEON;
+    kernels.accumulate = SyphonPixelAccumulateNEON;
+#endif
+    SyphonPixelKernels = kernels;
+}
+
+static inline const SyphonPixelRowKernels *SyphonPixelGetKernels(void)
+{
+    pthread_once(&SyphonPixelKernelsOnce, SyphonPixelKernelsInit);
+    return &SyphonPixelKernels;
+}
+
+#pragma mark Planes
+
+void SyphonPixelCopyPlane(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t rowLength, size_t rows, bool flipped)
+{
+    if (rows == 0 || rowLength == 0)
+    {
+        return;
+    }
+    if (!flipped && dstBytesPerRow == srcBytesPerRow)
+    {
+        // One copy for the whole plane, including any padding but the last row's
+        memcpy(dst, src, (dstBytesPerRow * (rows - 1)) + rowLength);
+    }
+    else
+    {
+        // memcpy is vectorized, so copying by row costs little more than the single copy
+        for (size_t row = 0; row < rows; row++)
+        {
+            size_t srcRow = flipped ? rows - 1 - row : row;
+            memcpy((uint8_t *)dst + (row * dstBytesPerRow), (const uint8_t *)src + (srcRow * srcBytesPerRow), rowLength);
+        }
+    }
+}
+
+void SyphonPixelCopyRegion(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t bytesPerPixel, size_t x, size_t y, size_t width, size_t height, bool flipped)
+{
+    const uint8_t *origin = (const uint8_t *)src + (y * srcBytesPerRow) + (x * bytesPerPixel);
+    SyphonPixelCopyPlane(dst, dstBytesPerRow, origin, srcBytesPerRow, width * bytesPerPixel, height, flipped);
+}
+
+bool SyphonPixelDownscaleBox(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t srcWidth, size_t srcHeight, size_t components, size_t factor)
+{
+    // Rows of each block are summed, vectorized, then the sums for each block's columns, which is factor times less work
+    size_t rowLength = srcWidth * components;
+    uint16_t *sums = malloc(rowLength * sizeof(uint16_t));
+    if (sums == NULL)
+    {
+        return false;
+    }
+    const SyphonPixelRowKernels *kernels = SyphonPixelGetKernels();
+    size_t dstWidth = (srcWidth + factor - 1) / factor;
+    for (size_t y = 0; y < srcHeight; y += factor)
+    {
+        size_t blockHeight = srcHeight - y < factor ? srcHeight - y : factor;
+        memset(sums, 0, rowLength * sizeof(uint16_t));
+        for (size_t row = 0; row < blockHeight; row++)
+        {
+            kernels->accumulate(sums, (const uint8_t *)src + ((y + row) * srcBytesPerRow), rowLength);
+        }
+        uint8_t *out = (uint8_t *)dst + ((y / factor) * dstBytesPerRow);
+        for (size_t x = 0; x < dstWidth; x++)
+        {
+            size_t left = x * factor;
+            size_t blockWidth = srcWidth - left < factor ? srcWidth - left : factor;
+            uint32_t count = (uint32_t)(blockWidth * blockHeight);
+            for (size_t component = 0; component < components; component++)
+            {
+                uint32_t sum = 0;
+                for (size_t column = 0; column < blockWidth; column++)
+                {
+                    sum += sums[((left + column) * components) + component];
+                }
+                out[(x * components) + component] = (uint8_t)((sum + (count / 2)) / count);
+            }
+        }
+    }
+    free(sums);
+    return true;
+}
+
+/*
+ xxHash64 is bound by memory bandwidth using 64-bit scalar arithmetic, which SSE2, AVX2 and NEON lack vector
+ multiplies for, so it has only a portable implementation.
+ */
+#define SYPHON_XXH_PRIME1 11400714785074694791ULL
+#define SYPHON_XXH_PRIME2 14029467366897019727ULL
+#define SYPHON_XXH_PRIME3 1609587929392839161ULL
+#define SYPHON_XXH_PRIME4 9650029242287828579ULL
+#define SYPHON_XXH_PRIME5 2870177450012600261ULL
+
+static inline uint64_t SyphonPixelRotateLeft(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t SyphonPixelRead64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t SyphonPixelHashRound(uint64_t acc, uint64_t input)
+{
+    acc += input * SYPHON_XXH_PRIME2;
+    acc = SyphonPixelRotateLeft(acc, 31);
+    return acc * SYPHON_XXH_PRIME1;
+}
+
+static inline uint64_t SyphonPixelHashMerge(uint64_t h, uint64_t acc)
+{
+    h ^= SyphonPixelHashRound(0, acc);
+    return (h * SYPHON_XXH_PRIME1) + SYPHON_XXH_PRIME4;
+}
+
+static uint64_t SyphonPixelHash(const uint8_t *p, size_t length, uint64_t seed)
+{
+    const uint8_t *end = p + length;
+    uint64_t h;
+    if (length >= 32)
+    {
+        uint64_t v1 = seed + SYPHON_XXH_PRIME1 + SYPHON_XXH_PRIME2;
+        uint64_t v2 = seed + SYPHON_XXH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - SYPHON_XXH_PRIME1;
+        const uint8_t *limit = end - 32;
+        do {
+            v1 = SyphonPixelHashRound(v1, SyphonPixelRead64(p));
+            v2 = SyphonPixelHashRound(v2, SyphonPixelRead64(p + 8));
+            v3 = SyphonPixelHashRound(v3, SyphonPixelRead64(p + 16));
+            v4 = SyphonPixelHashRound(v4, SyphonPixelRead64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = SyphonPixelRotateLeft(v1, 1) + SyphonPixelRotateLeft(v2, 7) + SyphonPixelRotateLeft(v3, 12) + SyphonPixelRotateLeft(v4, 18);
+        h = SyphonPixelHashMerge(h, v1);
+        h = SyphonPixelHashMerge(h, v2);
+        h = SyphonPixelHashMerge(h, v3);
+        h = SyphonPixelHashMerge(h, v4);
+    }
+    else
+    {
+        h = seed + SYPHON_XXH_PRIME5;
+    }
+    h += length;
+    for (; p + 8 <= end; p += 8)
+    {
+        h ^= SyphonPixelHashRound(0, SyphonPixelRead64(p));
+        h = (SyphonPixelRotateLeft(h, 27) * SYPHON_XXH_PRIME1) + SYPHON_XXH_PRIME4;
+    }
+    if (p + 4 <= end)
+    {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        h ^= (uint64_t)v * SYPHON_XXH_PRIME1;
+        h = (SyphonPixelRotateLeft(h, 23) * SYPHON_XXH_PRIME2) + SYPHON_XXH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++)
+    {
+        h ^= *p * SYPHON_XXH_PRIME5;
+        h = SyphonPixelRotateLeft(h, 11) * SYPHON_XXH_PRIME1;
+    }
+    h ^= h >> 33;
+    h *= SYPHON_XXH_PRIME2;
+    h ^= h >> 29;
+    h *= SYPHON_XXH_PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t SyphonPixelHashPlane(const void *src, size_t bytesPerRow, size_t rowLength, size_t rows, uint64_t seed)
+{
+    if (bytesPerRow == rowLength)
+    {
+        return SyphonPixelHash(src, rowLength * rows, seed);
+    }
+    // Each row's hash seeds the next
+    for (size_t row = 0; row < rows; row++)
+    {
+        seed = SyphonPixelHash((const uint8_t *)src + (row * bytesPerRow), rowLength, seed);
+    }
+    return seed;
+}
+
+static void SyphonPixelApplyRows(void (*kernel)(uint8_t *, const uint8_t *, size_t), void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height)
+{
+    for (size_t row = 0; row < height; row++)
+    {
+        kernel((uint8_t *)dst + (row * dstBytesPerRow), (const uint8_t *)src + (row * srcBytesPerRow), width);
+    }
+}
+
+void SyphonPixelSwapRedBlue(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height)
+{
+    SyphonPixelApplyRows(SyphonPixelGetKernels()->swapRedBlue, dst, dstBytesPerRow, src, srcBytesPerRow, width, height);
+}
+
+void SyphonPixelPremultiply(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height)
+{
+    SyphonPixelApplyRows(SyphonPixelGetKernels()->premultiply, dst, dstBytesPerRow, src, srcBytesPerRow, width, height);
+}
+
+void SyphonPixelUnpremultiply(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height)
+{
+    SyphonPixelApplyRows(SyphonPixelGetKernels()->unpremultiply, dst, dstBytesPerRow, src, srcBytesPerRow, width, height);
+}
+
+/*
+ Chroma is computed from the average of each 2 by 2 block, at a quarter of the luma's resolution, so uses the
+ portable implementation. At the right and bottom edges of odd-sized images the last column or row is repeated.
+ */
+static void SyphonPixelChroma(const uint8_t *src, size_t srcBytesPerRow, size_t width, size_t height, size_t x, size_t y, uint8_t *cb, uint8_t *cr)
+{
+    size_t x1 = x + 1 < width ? x + 1 : x;
+    size_t y1 = y + 1 < height ? y + 1 : y;
+    const uint8_t *p00 = src + (y * srcBytesPerRow) + (x * 4);
+    const uint8_t *p01 = src + (y * srcBytesPerRow) + (x1 * 4);
+    const uint8_t *p10 = src + (y1 * srcBytesPerRow) + (x * 4);
+    const uint8_t *p11 = src + (y1 * srcBytesPerRow) + (x1 * 4);
+    int32_t b = (p00[0] + p01[0] + p10[0] + p11[0] + 2) >> 2;
+    int32_t g = (p00[1] + p01[1] + p10[1] + p11[1] + 2) >> 2;
+    int32_t r = (p00[2] + p01[2] + p10[2] + p11[2] + 2) >> 2;
+    *cb = (uint8_t)(128 + ((SYPHON_CB_R * r + SYPHON_CB_G * g + SYPHON_CB_B * b + 128) >> 8));
+    *cr = (uint8_t)(128 + ((SYPHON_CR_R * r + SYPHON_CR_G * g + SYPHON_CR_B * b + 128) >> 8));
+}
+
+void SyphonPixelBGRAToNV12(uint8_t *luma, size_t lumaBytesPerRow, uint8_t *chroma, size_t chromaBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height)
+{
+    SyphonPixelApplyRows(SyphonPixelGetKernels()->luma, luma, lumaBytesPerRow, src, srcBytesPerRow, width, height);
+    for (size_t y = 0; y < height; y += 2)
+    {
+        uint8_t *row = chroma + ((y / 2) * chromaBytesPerRow);
+        for (size_t x = 0; x < width; x += 2)
+        {
+            SyphonPixelChroma(src, srcBytesPerRow, width, height, x, y, row + x, row + x + 1);
+        }
+    }
+}
+
+void SyphonPixelBGRAToI420(uint8_t *luma, size_t lumaBytesPerRow, uint8_t *cb, size_t cbBytesPerRow, uint8_t *cr, size_t crBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height)
+{
+    SyphonPixelApplyRows(SyphonPixelGetKernels()->luma, luma, lumaBytesPerRow, src, srcBytesPerRow, width, height);
+    for (size_t y = 0; y < height; y += 2)
+    {
+        uint8_t *cbRow = cb + ((y / 2) * cbBytesPerRow);
+        uint8_t *crRow = cr + ((y / 2) * crBytesPerRow);
+        for (size_t x = 0; x < width; x += 2)
+        {
+            SyphonPixelChroma(src, srcBytesPerRow, width, height, x, y, cbRow + (x / 2), crRow + (x / 2));
+        }
+    }
+}
+
+void SyphonPixelConvertU8ToHalf(uint16_t *dst, const uint8_t *src, size_t count)
+{
+    SyphonPixelGetKernels()->u8ToHalf(dst, src, count);
+}
+
+void SyphonPixelConvertHalfToU8(uint8_t *dst, const uint16_t *src, size_t count)
+{
+    SyphonPixelGetKernels()->halfToU8(dst, src, count);
+}
@@ -0,0 +1,118 @@
+/*
+    SyphonPixelKernels.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ Syphon Pixel Kernels convert and copy pixels in memory, for servers and clients which work with frames on the CPU.
+
+ - Each kernel has a portable implementation and vectorized implementations for SSE2, AVX2 and NEON. The best the
+   CPU supports is chosen once, the first time any kernel is used
+ - Four-component functions work with 8 bits per component in BGRA or RGBA order: either way alpha is the fourth byte
+ - Unless otherwise stated, destination and source may be the same memory but must not otherwise overlap
+
+ The kernels use only C, POSIX and compiler intrinsics.
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ SyphonPixelCopyPlane
+	Copies rows of rowLength bytes from src to dst. If flipped is true the rows are copied in reverse order.
+	dst and src must not overlap.
+ */
+void SyphonPixelCopyPlane(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t rowLength, size_t rows, bool flipped);
+
+/*
+ SyphonPixelCopyRegion
+	Copies the region of width by height pixels at x, y in src to dst, where y is measured from the first row of src.
+	If flipped is true the rows are copied in reverse order. dst and src must not overlap.
+ */
+void SyphonPixelCopyRegion(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t bytesPerPixel, size_t x, size_t y, size_t width, size_t height, bool flipped);
+
+/*
+ SyphonPixelDownscaleBox
+	Reduces an image of srcWidth by srcHeight pixels, each of components 8-bit components, by factor in each
+	dimension. Each pixel of dst is the average of a factor by factor block of src, so dst must have space for
+	(srcWidth + factor - 1) / factor by (srcHeight + factor - 1) / factor pixels. Blocks at the right and bottom
+	edges may be smaller. factor must be between 1 and 256. Returns false if memory could not be allocated.
+ */
+bool SyphonPixelDownscaleBox(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t srcWidth, size_t srcHeight, size_t components, size_t factor);
+
+/*
+ SyphonPixelHashPlane
+	Returns a 64-bit hash of rows of rowLength bytes, using xxHash64. Bytes between the end of one row and the start
+	of the next are not hashed. Pass 0 as seed, or the result for a previous plane to hash several planes together.
+ */
+uint64_t SyphonPixelHashPlane(const void *src, size_t bytesPerRow, size_t rowLength, size_t rows, uint64_t seed);
+
+/*
+ SyphonPixelSwapRedBlue
+	Converts between BGRA and RGBA by exchanging the first and third byte of each pixel.
+ */
+void SyphonPixelSwapRedBlue(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height);
+
+/*
+ SyphonPixelPremultiply
+	Multiplies the color components of each pixel by its alpha.
+ */
+void SyphonPixelPremultiply(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height);
+
+/*
+ SyphonPixelUnpremultiply
+	Divides the color components of each pixel by its alpha. Pixels with zero alpha become zero.
+ */
+void SyphonPixelUnpremultiply(void *dst, size_t dstBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height);
+
+/*
+ SyphonPixelBGRAToNV12
+	Converts BGRA pixels to bi-planar 4:2:0 video-range Y'CbCr using the BT.709 matrix, as used by
+	SyphonPixelFormatYCbCr420. chroma has interleaved Cb and Cr for each 2 by 2 block of pixels. Alpha is ignored.
+ */
+void SyphonPixelBGRAToNV12(uint8_t *luma, size_t lumaBytesPerRow, uint8_t *chroma, size_t chromaBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height);
+
+/*
+ SyphonPixelBGRAToI420
+	Converts BGRA pixels to tri-planar 4:2:0 video-range Y'CbCr using the BT.709 matrix. Alpha is ignored.
+ */
+void SyphonPixelBGRAToI420(uint8_t *luma, size_t lumaBytesPerRow, uint8_t *cb, size_t cbBytesPerRow, uint8_t *cr, size_t crBytesPerRow, const void *src, size_t srcBytesPerRow, size_t width, size_t height);
+
+/*
+ SyphonPixelConvertU8ToHalf
+	Converts count normalized 8-bit components to IEEE half-precision floats in the range 0 to 1.
+	dst and src must not overlap.
+ */
+void SyphonPixelConvertU8ToHalf(uint16_t *dst, const uint8_t *src, size_t count);
+
+/*
+ SyphonPixelConvertHalfToU8
+	Converts count IEEE half-precision floats to normalized 8-bit components, clamping to the range 0 to 1.
+	NaN becomes 0. dst and src must not overlap.
+ */
+void SyphonPixelConvertHalfToU8(uint8_t *dst, const uint16_t *src, size_t count);
@@ -0,0 +1,363 @@
+/*
+    SyphonPixelKernelsBenchmark.c
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ Standalone check and throughput benchmark of the pixel kernels. Every vectorized implementation the CPU supports
+ is checked against the portable one, for widths which exercise the vector loops and their tails, then each
+ implementation and each plane function is timed on a 1920 by 1080 frame. The kernels are included directly so
+ each implementation can be reached. Builds on macOS or Linux, on x86-64 or arm64:
+
+    cc -std=c11 -O2 -Wall -Wextra -o pixel-kernels SyphonPixelKernelsBenchmark.c -lm && ./pixel-kernels
+
+ GCC also needs -Wno-unknown-pragmas. Exits with a non-zero status if an implementation disagrees with the portable one.
+*/
+
+// Declares clock_gettime() when built as strict C11
+#define _POSIX_C_SOURCE 200809L
+
+#include "SyphonPixelKernels.c"
+#include <stdio.h>
+#include <time.h>
+
+#define SYPHON_BENCH_WIDTH 1920
+#define SYPHON_BENCH_HEIGHT 1080
+#define SYPHON_BENCH_PIXELS (SYPHON_BENCH_WIDTH * SYPHON_BENCH_HEIGHT)
+#define SYPHON_BENCH_SECONDS 0.25
+#define SYPHON_BENCH_GUARD 64 // bytes past the end of each output which must be left alone
+
+typedef enum {
+    SyphonBenchKindPixels,      // 4 bytes in, bytesOut bytes out per pixel
+    SyphonBenchKindU8ToHalf,
+    SyphonBenchKindHalfToU8,
+    SyphonBenchKindAccumulate
+} SyphonBenchKind;
+
+typedef void (*SyphonBenchFunction)(void);
+
+typedef struct {
+    const char *name;
+    SyphonBenchFunction function;
+} SyphonBenchImplementation;
+
+typedef struct {
+    const char *name;
+    SyphonBenchKind kind;
+    size_t bytesOut; // per pixel, for SyphonBenchKindPixels
+    SyphonBenchImplementation implementations[4]; // the portable implementation first
+} SyphonBenchKernel;
+
+#define IMPLEMENTATION(name, function) {name, (SyphonBenchFunction)(function)}
+
+static SyphonBenchKernel SyphonBenchKernels[] = {
+    {"swap red blue", SyphonBenchKindPixels, 4, {
+        IMPLEMENTATION("portable", SyphonPixelSwapRedBlueScalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("SSE2", SyphonPixelSwapRedBlueSSE2),
+        IMPLEMENTATION("AVX2", SyphonPixelSwapRedBlueAVX2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelSwapRedBlueNEON),
+#endif
+    }},
+    {"premultiply", SyphonBenchKindPixels, 4, {
+        IMPLEMENTATION("portable", SyphonPixelPremultiplyScalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("SSE2", SyphonPixelPremultiplySSE2),
+        IMPLEMENTATION("AVX2", SyphonPixelPremultiplyAVX2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelPremultiplyNEON),
+#endif
+    }},
+    {"unpremultiply", SyphonBenchKindPixels, 4, {
+        IMPLEMENTATION("portable", SyphonPixelUnpremultiplyScalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("SSE2", SyphonPixelUnpremultiplySSE2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelUnpremultiplyNEON),
+#endif
+    }},
+    {"BGRA to luma", SyphonBenchKindPixels, 1, {
+        IMPLEMENTATION("portable", SyphonPixelLumaScalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("SSE2", SyphonPixelLumaSSE2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelLumaNEON),
+#endif
+    }},
+    {"8-bit to half", SyphonBenchKindU8ToHalf, 0, {
+        IMPLEMENTATION("portable", SyphonPixelU8ToHalfScalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("AVX2", SyphonPixelU8ToHalfAVX2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelU8ToHalfNEON),
+#endif
+    }},
+    {"half to 8-bit", SyphonBenchKindHalfToU8, 0, {
+        IMPLEMENTATION("portable", SyphonPixelHalfToU8Scalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("AVX2", SyphonPixelHalfToU8AVX2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelHalfToU8NEON),
+#endif
+    }},
+    {"accumulate rows", SyphonBenchKindAccumulate, 0, {
+        IMPLEMENTATION("portable", SyphonPixelAccumulateScalar),
+#if SYPHON_PIXEL_X86
+        IMPLEMENTATION("SSE2", SyphonPixelAccumulateSSE2),
+        IMPLEMENTATION("AVX2", SyphonPixelAccumulateAVX2),
+#elif SYPHON_PIXEL_NEON
+        IMPLEMENTATION("NEON", SyphonPixelAccumulateNEON),
+#endif
+    }},
+};
+
+static bool SyphonBenchIsSupported(const SyphonBenchImplementation *implementation)
+{
+#if SYPHON_PIXEL_X86
+    if (strcmp(implementation->name, "AVX2") == 0)
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("f16c");
+    }
+#endif
+    (void)implementation;
+    return true;
+}
+
+// Bytes read and written for count elements
+static void SyphonBenchSizes(const SyphonBenchKernel *kernel, size_t count, size_t *in, size_t *out)
+{
+    switch (kernel->kind)
+    {
+        case SyphonBenchKindPixels:
+            *in = count * 4;
+            *out = count * kernel->bytesOut;
+            break;
+        case SyphonBenchKindU8ToHalf:
+            *in = count;
+            *out = count * 2;
+            break;
+        case SyphonBenchKindHalfToU8:
+            *in = count * 2;
+            *out = count;
+            break;
+        case SyphonBenchKindAccumulate:
+            *in = count;
+            *out = count * 2;
+            break;
+    }
+}
+
+static void SyphonBenchRun(const SyphonBenchKernel *kernel, SyphonBenchFunction function, void *dst, const void *src, size_t count)
+{
+    switch (kernel->kind)
+    {
+        case SyphonBenchKindPixels:
+            ((void (*)(uint8_t *, const uint8_t *, size_t))function)(dst, src, count);
+            break;
+        case SyphonBenchKindU8ToHalf:
+            ((void (*)(uint16_t *, const uint8_t *, size_t))function)(dst, src, count);
+            break;
+        case SyphonBenchKindHalfToU8:
+            ((void (*)(uint8_t *, const uint16_t *, size_t))function)(dst, src, count);
+            break;
+        case SyphonBenchKindAccumulate:
+            ((void (*)(uint16_t *, const uint8_t *, size_t))function)(dst, src, count);
+            break;
+    }
+}
+
+static void SyphonBenchFill(uint8_t *buffer, size_t length, uint32_t seed)
+{
+    uint32_t state = seed;
+    for (size_t i = 0; i < length; i++)
+    {
+        state = (state * 1664525U) + 1013904223U;
+        buffer[i] = (uint8_t)(state >> 24);
+    }
+}
+
+// Prepares an output buffer, which accumulating kernels add to, with sums small enough not to overflow
+static void SyphonBenchPrepareOutput(const SyphonBenchKernel *kernel, uint8_t *dst, size_t length)
+{
+    SyphonBenchFill(dst, length, 7);
+    if (kernel->kind == SyphonBenchKindAccumulate)
+    {
+        uint16_t *sums = (uint16_t *)dst;
+        for (size_t i = 0; i < length / 2; i++)
+        {
+            sums[i] &= 0x7FFF;
+        }
+    }
+}
+
+static double SyphonBenchNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+// Repeats body for at least SYPHON_BENCH_SECONDS, setting the number of runs and their duration
+#define SYPHON_BENCH_TIME(seconds, runs, body) do { \
+        runs = 0; \
+        double start = SyphonBenchNow(); \
+        do { body; runs++; seconds = SyphonBenchNow() - start; } while (seconds < SYPHON_BENCH_SECONDS); \
+    } while (0)
+
+// Reports throughput as bytes read and written, and as pixels of the frame processed
+static void SyphonBenchReport(const char *kernel, const char *implementation, double bytes, double pixels, unsigned long runs, double seconds)
+{
+    printf("%-20s %-9s %9.2f GB/s %9.2f Mpixels/s\n", kernel, implementation,
+           (bytes * runs) / seconds / 1e9, (pixels * runs) / seconds / 1e6);
+}
+
+// Checks every implementation against the portable one, returning the number which disagree
+static int SyphonBenchCheck(const SyphonBenchKernel *kernel, uint8_t *src, uint8_t *expected, uint8_t *actual)
+{
+    int failures = 0;
+    const SyphonBenchImplementation *portable = &kernel->implementations[0];
+    for (size_t i = 1; i < 4 && kernel->implementations[i].name; i++)
+    {
+        const SyphonBenchImplementation *implementation = &kernel->implementations[i];
+        if (!SyphonBenchIsSupported(implementation))
+        {
+            continue;
+        }
+        for (size_t count = 0; count < 300; count += (count < 70 ? 1 : 37))
+        {
+            size_t in, out;
+            SyphonBenchSizes(kernel, count, &in, &out);
+            SyphonBenchFill(src, in, (uint32_t)count + 1);
+            SyphonBenchPrepareOutput(kernel, expected, out + SYPHON_BENCH_GUARD);
+            SyphonBenchPrepareOutput(kernel, actual, out + SYPHON_BENCH_GUARD);
+            SyphonBenchRun(kernel, portable->function, expected, src, count);
+            SyphonBenchRun(kernel, implementation->function, actual, src, count);
+            if (memcmp(expected, actual, out + SYPHON_BENCH_GUARD) != 0)
+            {
+                fprintf(stderr, "%s: %s differs from portable for %zu elements\n", kernel->name, implementation->name, count);
+                failures++;
+                break;
+            }
+        }
+    }
+    return failures;
+}
+
+static void SyphonBenchMeasure(const SyphonBenchKernel *kernel, uint8_t *src, uint8_t *dst)
+{
+    // Component kernels work on every component of the frame
+    size_t count = kernel->kind == SyphonBenchKindPixels ? SYPHON_BENCH_PIXELS : SYPHON_BENCH_PIXELS * 4;
+    size_t in, out;
+    SyphonBenchSizes(kernel, count, &in, &out);
+    SyphonBenchFill(src, in, 1);
+    for (size_t i = 0; i < 4 && kernel->implementations[i].name; i++)
+    {
+        const SyphonBenchImplementation *implementation = &kernel->implementations[i];
+        if (!SyphonBenchIsSupported(implementation))
+        {
+            continue;
+        }
+        SyphonBenchPrepareOutput(kernel, dst, out);
+        double seconds;
+        unsigned long runs;
+        // Accumulating repeatedly only wraps the sums, which doesn't change the work done
+        SYPHON_BENCH_TIME(seconds, runs, SyphonBenchRun(kernel, implementation->function, dst, src, count));
+        SyphonBenchReport(kernel->name, implementation->name, (double)(in + out), SYPHON_BENCH_PIXELS, runs, seconds);
+    }
+}
+
+static void SyphonBenchPlanes(uint8_t *src, uint8_t *dst)
+{
+    const size_t width = SYPHON_BENCH_WIDTH;
+    const size_t height = SYPHON_BENCH_HEIGHT;
+    const size_t bytesPerRow = width * 4;
+    const double frame = (double)(bytesPerRow * height);
+    const double yuv = (double)(width * height) * 1.5;
+    const double pixels = (double)(width * height);
+    uint8_t *luma = dst;
+    uint8_t *chroma = dst + (width * height);
+    double seconds;
+    unsigned long runs;
+    volatile uint64_t hash = 0;
+    SyphonBenchFill(src, bytesPerRow * height, 1);
+
+    SYPHON_BENCH_TIME(seconds, runs, SyphonPixelCopyPlane(dst, bytesPerRow, src, bytesPerRow, bytesPerRow, height, false));
+    SyphonBenchReport("copy plane", "dispatch", frame * 2, pixels, runs, seconds);
+    SYPHON_BENCH_TIME(seconds, runs, SyphonPixelCopyPlane(dst, bytesPerRow, src, bytesPerRow, bytesPerRow, height, true));
+    SyphonBenchReport("copy plane flipped", "dispatch", frame * 2, pixels, runs, seconds);
+    SYPHON_BENCH_TIME(seconds, runs, SyphonPixelCopyRegion(dst, bytesPerRow / 2, src, bytesPerRow, 4, width / 4, height / 4, width / 2, height / 2, true));
+    SyphonBenchReport("copy region", "dispatch", frame / 2, pixels / 4, runs, seconds);
+    SYPHON_BENCH_TIME(seconds, runs, SyphonPixelDownscaleBox(dst, bytesPerRow / 4, src, bytesPerRow, width, height, 4, 4));
+    SyphonBenchReport("downscale by 4", "dispatch", frame, pixels, runs, seconds);
+    SYPHON_BENCH_TIME(seconds, runs, hash += SyphonPixelHashPlane(src, bytesPerRow, bytesPerRow, height, 0));
+    SyphonBenchReport("hash plane", "portable", frame, pixels, runs, seconds);
+    SYPHON_BENCH_TIME(seconds, runs, SyphonPixelBGRAToNV12(luma, width, chroma, width, src, bytesPerRow, width, height));
+    SyphonBenchReport("BGRA to NV12", "dispatch", frame + yuv, pixels, runs, seconds);
+    SYPHON_BENCH_TIME(seconds, runs, SyphonPixelBGRAToI420(luma, width, chroma, width / 2, chroma + ((width / 2) * (height / 2)), width / 2, src, bytesPerRow, width, height));
+    SyphonBenchReport("BGRA to I420", "dispatch", frame + yuv, pixels, runs, seconds);
+}
+
+int main(void)
+{
+    // The largest input or output is a frame of half floats, plus room past its end
+    size_t capacity = (SYPHON_BENCH_PIXELS * 8) + SYPHON_BENCH_GUARD;
+    uint8_t *src = malloc(capacity);
+    uint8_t *expected = malloc(capacity);
+    uint8_t *actual = malloc(capacity);
+    if (!src || !expected || !actual)
+    {
+        fprintf(stderr, "Couldn't allocate buffers\n");
+        return 1;
+    }
+    // Prepares the tables the portable implementations use
+    SyphonPixelGetKernels();
+
+    int failures = 0;
+    size_t kernelCount = sizeof(SyphonBenchKernels) / sizeof(SyphonBenchKernels[0]);
+    for (size_t i = 0; i < kernelCount; i++)
+    {
+        failures += SyphonBenchCheck(&SyphonBenchKernels[i], src, expected, actual);
+    }
+    for (size_t i = 0; i < kernelCount; i++)
+    {
+        SyphonBenchMeasure(&SyphonBenchKernels[i], src, actual);
+    }
+    SyphonBenchPlanes(src, actual);
+
+    free(src);
+    free(expected);
+    free(actual);
+    if (failures)
+    {
+        fprintf(stderr, "%d implementations disagree with the portable ones\n", failures);
+        return 1;
+    }
+    printf("All implementations agree with the portable ones\n");
+    return 0;
+}
@@ -27,11 +27,16 @@
      SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#define kSyphonDictionaryVersion 0U
+// The highest server-description version this build understands
+#define kSyphonDictionaryVersion 1U
+// Servers describe themselves with the lowest version sufficient for their features, so older clients can connect when possible
+#define kSyphonDictionaryVersionBGRA 0U // Version 0 servers publish a single BGRA8 surface
 
 #ifdef __OBJC__
 
 #import <stdatomic.h> // For SyphonSafeBool
+#import <IOSurface/IOSurface.h>
+#import "SyphonFrameMetadata.h"
 
 #define kSyphonIdentifier @"info.v002.Syphon"
 
@@ -40,6 +45,8 @@
 #define SyphonServerAnnounce @"info.v002.Syphon.ServerAnnounce"
 #define SyphonServerRetire @"info.v002.Syphon.ServerRetire"
 #define SyphonServerUpdate @"info.v002.Syphon.ServerUpdate"
+#define SyphonServerChange @"info.v002.Syphon.ServerChange" // Carries only the keys which changed, see below
+#define SyphonServerAnnounceRequestForServer @"info.v002.Syphon.ServerAnnounceRequestForServer" // Object is the UUID of the one server which should announce itself
 
 
 // Server-description keys // and content
@@ -49,16 +56,69 @@ extern NSString * const SyphonServerDescriptionAppNameKey; // NSString
 // extern NSString * const SyphonServerDescriptionIconKey; // TODO: remove this from here if we continue to reconstruct the icon on the far side rather than pack it
 extern NSString * const SyphonServerDescriptionDictionaryVersionKey; // NSNumber as unsigned int
 extern NSString * const SyphonServerDescriptionSurfacesKey; // An NSArray of NSDictionaries describing each supported surface type
+extern NSString * const SyphonServerDescriptionProcessIdentifierKey; // NSNumber as int with the server's process identifier, absent from older servers
+extern NSString * const SyphonServerDescriptionRevisionKey; // NSNumber as unsigned long long, increases whenever the description changes, absent from older servers
+extern NSString * const SyphonServerDescriptionPreviewKey; // NSDictionary describing the server's preview stream, absent if it has none, see below
+
+/*
+ A preview dictionary has its own UUID and surfaces, as in a server description, and the scale by which frames are
+ reduced. Clients connect to it as they would to a server.
+ */
+extern NSString * const SyphonServerDescriptionPreviewScaleKey; // NSNumber as unsigned int
+
+/*
+ Each tile dictionary (in the NSArray for SyphonServerDescriptionTilesKey) also has its own UUID and surfaces.
+ */
+extern NSString * const SyphonServerDescriptionTilesKey;
+extern NSString * const SyphonServerDescriptionTileRectKey;
+extern NSString * const SyphonServerDescriptionStreamsKey; // NSArray of NSString with the names of the server's streams, absent if it publishes one
+extern NSString * const SyphonServerDescriptionFenceKey; // NSNumber as unsigned int with the IOSurfaceID of a surface holding a SyphonFence, absent unless the server tracks frame releases
+
+/*
+ A SyphonServerChange notification's user info has the server's UUID and new revision, the revision it was made
+ from, the keys and values which were added or changed, and an array of any keys which were removed.
+ Directories which don't hold the base revision can't apply it, and wait for a complete description.
+ */
+extern NSString * const SyphonServerChangeBaseRevisionKey; // NSNumber as unsigned long long
+extern NSString * const SyphonServerChangeRemovedKeysKey; // NSArray of NSString
+
+/*
+ Directories which apply SyphonServerChange add this key, with a NSNumber with a BOOL value YES, to the user info of
+ their SyphonServerAnnounceRequest notifications. Once a server process has seen a request without it, from a
+ directory which predates SyphonServerChange, its servers also post complete descriptions with SyphonServerUpdate.
+ Define SYPHON_LEGACY_UPDATES to 0 to build without them.
+ */
+extern NSString * const SyphonServerAnnounceRequestAppliesChangesKey;
+#ifndef SYPHON_LEGACY_UPDATES
+#define SYPHON_LEGACY_UPDATES 1
+#endif
 
 // Surface-description (dictionary for SyphonServerDescriptionSurfacesKey) keys // and content
 extern NSString * const SyphonSurfaceType;
 extern NSString * const SyphonSurfaceTypeIOSurface;
+extern NSString * const SyphonSurfacePixelFormat; // NSNumber as unsigned int with a SyphonPixelFormat, absent means SyphonPixelFormatBGRA8
 
 // SyphonServer options
 extern NSString * const SyphonServerOptionIsPrivate;
 extern NSString * const SyphonServerOptionAntialiasSampleCount;
 extern NSString * const SyphonServerOptionDepthBufferResolution;
 extern NSString * const SyphonServerOptionStencilBufferResolution;
+extern NSString * const SyphonServerOptionPixelFormat;
+extern NSString * const SyphonServerOptionPreviewScale;
+extern NSString * const SyphonServerOptionPreviewFrameRate;
+extern NSString * const SyphonServerOptionSuppressDuplicateFrames;
+extern NSString * const SyphonServerOptionTileSize;
+extern NSString * const SyphonServerOptionStreamNames;
+extern NSString * const SyphonServerOptionSurfaceCount;
+extern NSString * const SyphonServerOptionTracksFrameReleases;
+
+// SyphonClient options
+extern NSString * const SyphonClientOptionPixelFormats;
+extern NSString * const SyphonClientOptionPreview;
+extern NSString * const SyphonClientOptionTileIndex;
+extern NSString * const SyphonClientOptionFrameHistoryLength;
+extern NSString * const SyphonClientOptionPresentationDelay;
+extern NSString * const SyphonClientOptionReleasesFrames;
 
 NSString *SyphonCreateUUIDString(void) NS_RETURNS_RETAINED;
 
@@ -67,6 +127,38 @@ typedef atomic_int_fast32_t SyphonSafeBool;
 BOOL SyphonSafeBoolGet(SyphonSafeBool *b);
 void SyphonSafeBoolSet(SyphonSafeBool *b, BOOL value);
 
+// The shared registry of servers (see SyphonSharedRegistry.h). Returns NULL if the registry is unavailable.
+// Define SYPHON_SHARED_REGISTRY to 0 to build without it.
+#ifndef SYPHON_SHARED_REGISTRY
+#define SYPHON_SHARED_REGISTRY 1
+#endif
+struct SyphonRegistry *SyphonSharedRegistryGet(void);
+
+// The server directory keeps the last servers it knew about on disk to populate itself quickly.
+// Define SYPHON_DIRECTORY_CACHE to 0 to build without it.
+#ifndef SYPHON_DIRECTORY_CACHE
+#define SYPHON_DIRECTORY_CACHE 1
+#endif
+
+// Frame metadata as sent with SyphonMessageTypeNewFrame
+// surfaceID is the surface holding the frame, or 0 if it is the surface last sent with SyphonMessageTypeUpdateSurfaceID
+NSData *SyphonFrameMetadataCreateData(const SyphonFrameMetadata *metadata, IOSurfaceID surfaceID) NS_RETURNS_RETAINED;
+// surfaceID may be NULL, and is set to 0 for metadata from older servers
+BOOL SyphonFrameMetadataGetFromData(NSData *data, SyphonFrameMetadata *metadata, IOSurfaceID *surfaceID);
+// Sets rects in surface coordinates as the frame's dirty rects, replacing them with their bounds if there are too many
+void SyphonFrameMetadataSetDirtyRects(SyphonFrameMetadata *metadata, const NSRect *rects, NSUInteger count);
+// Clips dirty rects in texture coordinates to region and converts them to integral surface coordinates.
+// surfaceRects must have space for count rects. Returns the number of non-empty rects written.
+NSUInteger SyphonDirtyRectsToSurface(const NSRect *rects, NSUInteger count, NSRect region, BOOL flipped, NSRect *surfaceRects);
+
+// Pixel formats
+BOOL SyphonPixelFormatIsSupported(OSType format);
+NSUInteger SyphonPixelFormatBitsPerPixel(OSType format);
+IOSurfaceRef SyphonSurfaceCreate(size_t width, size_t height, OSType format) CF_RETURNS_RETAINED;
+OSType SyphonSurfaceDescriptionGetPixelFormat(NSDictionary *surfaceDescription);
+// Returns the IOSurface description from surfaces with an accepted format using the fewest bits per pixel, or nil
+NSDictionary *SyphonSurfaceDescriptionChoose(NSArray<NSDictionary *> *surfaces, NSArray<NSNumber *> *acceptedFormats);
+
 #endif
 
 #pragma mark Communication Constants
@@ -84,13 +176,29 @@ enum {
 											  Server will send new frame notices. */
     SyphonMessageTypeRemoveClientForInfo = 2, /* Accompanying data is a NSString with the client's UUID.
 											   Server will stop sending server description changes, IOSurfaceID changes and server retirement notices. */
-	SyphonMessageTypeRemoveClientForFrames = 3 /* Accompanying data is a NSString with the client's UUID.
+	SyphonMessageTypeRemoveClientForFrames = 3, /* Accompanying data is a NSString with the client's UUID.
 												Server will stop sending new frame notices. */
+	SyphonMessageTypeAddClientForFrameBatches = 4 /* Accompanying data is a NSArray of two NSStrings: the client's UUID and the name of its process'
+												   frame port. Sent after SyphonMessageTypeAddClientForFrames. Servers in a publish group may then
+												   send the client's new frame notices to the frame port, batched with those of other servers.
+												   Clients which send this also take the surface of each frame from its metadata, so servers
+												   with several surfaces (see SyphonServerOptionSurfaceCount) needn't send them
+												   SyphonMessageTypeUpdateSurfaceID each time they move to the next. */
 };
 
 enum {
 	SyphonMessageTypeUpdateServerName = 0, /* Accompanying data is the server name as NSString. */
-	SyphonMessageTypeNewFrame = 1, /* No accompanying data. */
+	SyphonMessageTypeNewFrame = 1, /* Accompanying data is NSData with frame metadata (see SyphonFrameMetadataCreateData()). Older servers send no data. */
 	SyphonMessageTypeUpdateSurfaceID = 2, /* Accompanying data is an unsigned integer value in a NSNumber representing a new IOSurfaceID */
-	SyphonMessageTypeRetireServer = 3 /* No accompanying data. */
+	SyphonMessageTypeRetireServer = 3, /* No accompanying data. */
+	SyphonMessageTypeUpdateStreamSurfaceIDs = 4 /* Accompanying data is a NSArray of NSNumbers with the IOSurfaceID of each of the server's streams, in the order of
+												 SyphonServerDescriptionStreamsKey, or 0 for a stream without a surface. The first stream's ID is also sent with
+												 SyphonMessageTypeUpdateSurfaceID, which is the only message older clients understand. Sent before the new frame
+												 which uses the surfaces, so clients always see a consistent set. */
+};
+
+enum {
+	SyphonMessageTypeNewFrameBatch = 0 /* Sent to a client process' frame port. Accompanying data is a NSDictionary with the UUIDs of clients as keys, and
+										NSData with frame metadata for each as with SyphonMessageTypeNewFrame. Frames which bring a new surface
+										are never batched, so they can't arrive before the surface. */
 };
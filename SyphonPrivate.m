@@ -28,6 +28,11 @@
  */
 
 #import "SyphonPrivate.h"
+#import "SyphonPixelFormat.h"
+#import "SyphonSharedRegistry.h"
+#import <os/lock.h>
+
+#define kSyphonSharedRegistryRetryInterval NSEC_PER_SEC
 
 NSString * const SyphonServerDescriptionDictionaryVersionKey = @"SyphonServerDescriptionDictionaryVersionKey";
 NSString * const SyphonServerDescriptionUUIDKey = @"SyphonServerDescriptionUUIDKey";
@@ -35,14 +40,41 @@ NSString * const SyphonServerDescriptionNameKey = @"SyphonServerDescriptionNameK
 NSString * const SyphonServerDescriptionAppNameKey = @"SyphonServerDescriptionAppNameKey";
 NSString * const SyphonServerDescriptionIconKey = @"SyphonServerDescriptionIconKey";
 NSString * const SyphonServerDescriptionSurfacesKey = @"SyphonServerDescriptionSurfacesKey";
+NSString * const SyphonServerDescriptionProcessIdentifierKey = @"SyphonServerDescriptionProcessIdentifierKey";
+NSString * const SyphonServerDescriptionRevisionKey = @"SyphonServerDescriptionRevisionKey";
+NSString * const SyphonServerDescriptionPreviewKey = @"SyphonServerDescriptionPreviewKey";
+NSString * const SyphonServerDescriptionPreviewScaleKey = @"SyphonServerDescriptionPreviewScaleKey";
+NSString * const SyphonServerDescriptionTilesKey = @"SyphonServerDescriptionTilesKey";
+NSString * const SyphonServerDescriptionTileRectKey = @"SyphonServerDescriptionTileRectKey";
+NSString * const SyphonServerDescriptionStreamsKey = @"SyphonServerDescriptionStreamsKey";
+NSString * const SyphonServerDescriptionFenceKey = @"SyphonServerDescriptionFenceKey";
+NSString * const SyphonServerChangeBaseRevisionKey = @"SyphonServerChangeBaseRevisionKey";
+NSString * const SyphonServerChangeRemovedKeysKey = @"SyphonServerChangeRemovedKeysKey";
+NSString * const SyphonServerAnnounceRequestAppliesChangesKey = @"SyphonServerAnnounceRequestAppliesChangesKey";
 
 NSString * const SyphonSurfaceType = @"SyphonSurfaceType";
 NSString * const SyphonSurfaceTypeIOSurface = @"SyphonSurfaceTypeIOSurface";
+NSString * const SyphonSurfacePixelFormat = @"SyphonSurfacePixelFormat";
 
 NSString * const SyphonServerOptionIsPrivate = @"SyphonServerOptionIsPrivate";
 NSString * const SyphonServerOptionAntialiasSampleCount = @"SyphonServerOptionAntialiasSampleCount";
 NSString * const SyphonServerOptionDepthBufferResolution = @"SyphonServerOptionDepthBufferResolution";
 NSString * const SyphonServerOptionStencilBufferResolution = @"SyphonServerOptionStencilBufferResolution";
+NSString * const SyphonServerOptionPixelFormat = @"SyphonServerOptionPixelFormat";
+NSString * const SyphonServerOptionPreviewScale = @"SyphonServerOptionPreviewScale";
+NSString * const SyphonServerOptionPreviewFrameRate = @"SyphonServerOptionPreviewFrameRate";
+NSString * const SyphonServerOptionSuppressDuplicateFrames = @"SyphonServerOptionSuppressDuplicateFrames";
+NSString * const SyphonServerOptionTileSize = @"SyphonServerOptionTileSize";
+NSString * const SyphonServerOptionStreamNames = @"SyphonServerOptionStreamNames";
+NSString * const SyphonServerOptionSurfaceCount = @"SyphonServerOptionSurfaceCount";
+NSString * const SyphonServerOptionTracksFrameReleases = @"SyphonServerOptionTracksFrameReleases";
+
+NSString * const SyphonClientOptionPixelFormats = @"SyphonClientOptionPixelFormats";
+NSString * const SyphonClientOptionPreview = @"SyphonClientOptionPreview";
+NSString * const SyphonClientOptionTileIndex = @"SyphonClientOptionTileIndex";
+NSString * const SyphonClientOptionFrameHistoryLength = @"SyphonClientOptionFrameHistoryLength";
+NSString * const SyphonClientOptionPresentationDelay = @"SyphonClientOptionPresentationDelay";
+NSString * const SyphonClientOptionReleasesFrames = @"SyphonClientOptionReleasesFrames";
 
 NSString *SyphonCreateUUIDString(void)
 {
@@ -55,6 +87,33 @@ NSString *SyphonCreateUUIDString(void)
 	return result;
 }
 
+SyphonRegistryRef SyphonSharedRegistryGet(void)
+{
+#if SYPHON_SHARED_REGISTRY
+	// Failure may be temporary (eg another process is creating the registry) so is retried, but not too often,
+	// and a caller never waits for another caller's attempt
+	static SyphonRegistryRef _Atomic registry;
+	static os_unfair_lock lock = OS_UNFAIR_LOCK_INIT;
+	static uint64_t lastAttempt; // guarded by lock
+	SyphonRegistryRef result = atomic_load_explicit(&registry, memory_order_acquire);
+	if (result == NULL && os_unfair_lock_trylock(&lock))
+	{
+		result = atomic_load_explicit(&registry, memory_order_acquire);
+		uint64_t now = SyphonFrameTimestampNow();
+		if (result == NULL && (lastAttempt == 0 || now - lastAttempt >= kSyphonSharedRegistryRetryInterval))
+		{
+			result = SyphonRegistryOpen(SYPHON_REGISTRY_NAME);
+			lastAttempt = SyphonFrameTimestampNow();
+			atomic_store_explicit(&registry, result, memory_order_release);
+		}
+		os_unfair_lock_unlock(&lock);
+	}
+	return result;
+#else
+	return NULL;
+#endif
+}
+
 BOOL SyphonSafeBoolGet(SyphonSafeBool *b)
 {
 	return (*b == 0 ? NO : YES);
@@ -69,3 +128,96 @@ void SyphonSafeBoolSet(SyphonSafeBool *b, BOOL value)
         result = atomic_compare_exchange_strong(b, &old, new);
 	} while (!result);
 }
+
+BOOL SyphonPixelFormatIsSupported(OSType format)
+{
+	return SyphonPixelFormatBitsPerPixel(format) != 0 ? YES : NO;
+}
+
+NSUInteger SyphonPixelFormatBitsPerPixel(OSType format)
+{
+	switch (format) {
+		case SyphonPixelFormatBGRA8:
+		case SyphonPixelFormatRGB10A2:
+			return 32;
+		case SyphonPixelFormatRGBA16Float:
+			return 64;
+		case SyphonPixelFormatYCbCr420:
+			return 12;
+		default:
+			return 0;
+	}
+}
+
+IOSurfaceRef SyphonSurfaceCreate(size_t width, size_t height, OSType format)
+{
+	NSDictionary<NSString *, id> *surfaceAttributes;
+	if (format == SyphonPixelFormatYCbCr420)
+	{
+		// Luma at full resolution, interleaved CbCr at half resolution in each dimension
+		size_t chromaWidth = (width + 1) / 2;
+		size_t chromaHeight = (height + 1) / 2;
+		size_t lumaBytesPerRow = IOSurfaceAlignProperty(kIOSurfacePlaneBytesPerRow, width);
+		size_t chromaBytesPerRow = IOSurfaceAlignProperty(kIOSurfacePlaneBytesPerRow, chromaWidth * 2);
+		size_t lumaSize = IOSurfaceAlignProperty(kIOSurfacePlaneSize, lumaBytesPerRow * height);
+		size_t chromaSize = IOSurfaceAlignProperty(kIOSurfacePlaneSize, chromaBytesPerRow * chromaHeight);
+		NSArray *planes = @[@{(NSString *)kIOSurfacePlaneWidth: @(width),
+							  (NSString *)kIOSurfacePlaneHeight: @(height),
+							  (NSString *)kIOSurfacePlaneBytesPerElement: @(1U),
+							  (NSString *)kIOSurfacePlaneBytesPerRow: @(lumaBytesPerRow),
+							  (NSString *)kIOSurfacePlaneOffset: @(0U),
+							  (NSString *)kIOSurfacePlaneSize: @(lumaSize)},
+							@{(NSString *)kIOSurfacePlaneWidth: @(chromaWidth),
+							  (NSString *)kIOSurfacePlaneHeight: @(chromaHeight),
+							  (NSString *)kIOSurfacePlaneBytesPerElement: @(2U),
+							  (NSString *)kIOSurfacePlaneBytesPerRow: @(chromaBytesPerRow),
+							  (NSString *)kIOSurfacePlaneOffset: @(lumaSize),
+							  (NSString *)kIOSurfacePlaneSize: @(chromaSize)}];
+		surfaceAttributes = @{(NSString*)kIOSurfaceIsGlobal: @(YES),
+							  (NSString*)kIOSurfaceWidth: @(width),
+							  (NSString*)kIOSurfaceHeight: @(height),
+							  (NSString*)kIOSurfacePixelFormat: @(format),
+							  (NSString*)kIOSurfacePlaneInfo: planes,
+							  (NSString*)kIOSurfaceAllocSize: @(lumaSize + chromaSize)};
+	}
+	else
+	{
+		surfaceAttributes = @{(NSString*)kIOSurfaceIsGlobal: @(YES),
+							  (NSString*)kIOSurfaceWidth: @(width),
+							  (NSString*)kIOSurfaceHeight: @(height),
+							  (NSString*)kIOSurfacePixelFormat: @(format),
+							  (NSString*)kIOSurfaceBytesPerElement: @(SyphonPixelFormatBitsPerPixel(format) / 8)};
+	}
+	return IOSurfaceCreate((CFDictionaryRef) surfaceAttributes);
+}
+
+OSType SyphonSurfaceDescriptionGetPixelFormat(NSDictionary *surfaceDescription)
+{
+	NSNumber *format = [surfaceDescription objectForKey:SyphonSurfacePixelFormat];
+	if ([format respondsToSelector:@selector(unsignedIntValue)])
+	{
+		return [format unsignedIntValue];
+	}
+	return SyphonPixelFormatBGRA8;
+}
+
+NSDictionary *SyphonSurfaceDescriptionChoose(NSArray<NSDictionary *> *surfaces, NSArray<NSNumber *> *acceptedFormats)
+{
+	NSDictionary *chosen = nil;
+	NSUInteger chosenCost = NSUIntegerMax;
+	for (NSDictionary *surface in surfaces)
+	{
+		if ([surface isKindOfClass:[NSDictionary class]]
+			&& [[surface objectForKey:SyphonSurfaceType] isEqual:SyphonSurfaceTypeIOSurface])
+		{
+			OSType format = SyphonSurfaceDescriptionGetPixelFormat(surface);
+			NSUInteger cost = SyphonPixelFormatBitsPerPixel(format);
+			if (cost != 0 && cost < chosenCost && [acceptedFormats containsObject:@(format)])
+			{
+				chosen = surface;
+				chosenCost = cost;
+			}
+		}
+	}
+	return chosen;
+}
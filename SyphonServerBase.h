@@ -28,6 +28,8 @@
 */
 
 #import <Foundation/Foundation.h>
+#import <Syphon/SyphonPixelFormat.h>
+#import <Syphon/SyphonFrameMetadata.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -37,6 +39,54 @@ NS_ASSUME_NONNULL_BEGIN
  */
 extern NSString * const SyphonServerOptionIsPrivate;
 
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSNumber with a SyphonPixelFormat value, the server will publish frames in that format. Subclasses may not support every format, in which case initialization fails. Only clients which accept the format will be able to connect to the server. Default is SyphonPixelFormatBGRA8.
+ */
+extern NSString * const SyphonServerOptionPixelFormat;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSNumber with an unsigned integer value of 2 or more, the server also publishes a preview of its frames, reduced in each dimension by that factor (for instance 4 or 8). Clients which only display small images, such as source browsers, can connect to the preview using SyphonClientOptionPreview and read far fewer pixels than they would from full-size frames. The preview is only updated while it has clients, at most as often as SyphonServerOptionPreviewFrameRate allows. Servers using SyphonPixelFormatRGB10A2 or SyphonPixelFormatRGBA16Float don't publish a preview. Default is no preview.
+ */
+extern NSString * const SyphonServerOptionPreviewScale;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSNumber with a double value, the server updates its preview (see SyphonServerOptionPreviewScale) at most that many times a second. Frames published more often than that are not previewed. Default is 10.
+ */
+extern NSString * const SyphonServerOptionPreviewFrameRate;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSNumber with a BOOL value YES, the server doesn't notify clients of frames with the same content as the frame published before them. Frames for which you supply a content version using setNextFrameContentVersion: are compared by that version. Otherwise the server compares hashes of bands of each frame's pixels, reading only the bands which intersect the frame's dirty rects if it has them, and stopping at the first band which changed, so a changed frame usually costs little to check, but an unchanged frame without dirty rects costs a read of the whole frame. This is best used by servers which often publish unchanged frames, for instance of a static slide or paused video. Suppressed frames don't use up a sequence number. Default is NO.
+ */
+extern NSString * const SyphonServerOptionSuppressDuplicateFrames;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSValue with a NSSize value, the server splits its frames into a grid of tiles of that size, each published as a separate stream, so that clients which only need part of a large frame receive and allocate only that part. Tiles at the right and bottom edges may be smaller. Clients choose a tile using SyphonClientOptionTileIndex. Tiles are only drawn while they have clients. Subclasses may not support tiling, in which case they publish frames as usual, and servers using SyphonPixelFormatYCbCr420 can't be tiled, in which case initialization fails. Default is no tiling.
+ */
+extern NSString * const SyphonServerOptionTileSize;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSArray of two or more unique NSStrings, the server publishes that many named streams, for instance a color frame and a matching depth or mask frame. Each stream has its own frames, which may differ in size, and a frame for every stream is published together, so clients always receive frames which belong together. The first stream is the server's primary stream, which is all clients of older versions of Syphon receive. Subclasses may not support several streams, in which case they publish only the first. Streams can't be combined with SyphonServerOptionTileSize, in which case initialization fails. Default is a single stream.
+ */
+extern NSString * const SyphonServerOptionStreamNames;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSNumber with an unsigned integer value of 2 or more, the server draws each frame to the next of that many surfaces in turn, up to 8, rather than to a single surface. Clients can then keep that many recent frames without copying them, to smooth playout (see SyphonClientOptionFrameHistoryLength), and a frame can be drawn while clients read the one before it. Each surface uses as much memory as a frame. Only subclasses which draw every frame to a new surface, such as SyphonCPUServer, use more than one surface: SyphonMetalServer and SyphonOpenGLServer draw in place and ignore this option. Tiled servers and servers with several streams always use one. Default is 1.
+ */
+extern NSString * const SyphonServerOptionSurfaceCount;
+
+/*!
+ @relates SyphonServerBase
+ If this key is matched with a NSNumber with a BOOL value YES, clients created with SyphonClientOptionReleasesFrames tell the server which frames they are still reading, so the server can avoid drawing over them. A server with several surfaces (see SyphonServerOptionSurfaceCount) then draws to a surface no client is reading where there is one, and you can use freeSurfaceCount and waitForFreeSurfaceWithTimeout: to skip or delay frames while clients are slow. Clients of older versions of Syphon, and clients without the option, are not tracked. Default is NO.
+ */
+extern NSString * const SyphonServerOptionTracksFrameReleases;
+
 @interface SyphonServerBase : NSObject
 
 /*!
@@ -45,7 +95,7 @@ extern NSString * const SyphonServerOptionIsPrivate;
  Creates a new server with the specified human-readable name (which need not be unique) and options. The server will be started immediately. Init may fail and return nil if the server could not be started.
 
  @param serverName Non-unique human readable server name. This is not required and may be nil, but is usually used by clients in their UI to aid identification.
- @param options A dictionary containing key-value pairs to specify options for the server. Currently supported options are SyphonServerOptionIsPrivate, plus any added by the subclass. See their descriptions for details.
+ @param options A dictionary containing key-value pairs to specify options for the server. Currently supported options are SyphonServerOptionIsPrivate, SyphonServerOptionPixelFormat, SyphonServerOptionPreviewScale, SyphonServerOptionPreviewFrameRate, SyphonServerOptionSuppressDuplicateFrames, SyphonServerOptionTileSize, SyphonServerOptionStreamNames, SyphonServerOptionSurfaceCount and SyphonServerOptionTracksFrameReleases, plus any added by the subclass. See their descriptions for details.
  @returns A newly intialized Syphon server. Nil on failure.
 */
 - (instancetype)initWithName:(nullable NSString*)serverName options:(nullable NSDictionary<NSString *, id> *)options NS_DESIGNATED_INITIALIZER;
@@ -60,10 +110,59 @@ extern NSString * const SyphonServerOptionIsPrivate;
 @property (readonly) NSDictionary<NSString *, id<NSCoding>>* serverDescription;
 
 /*!
- YES if clients are currently attached, NO otherwise. If you generate frames frequently (for instance on a display-link timer), you may choose to test this and only call publishFrameTexture:textureTarget:imageRegion:textureDimensions:flipped: when clients are attached.
+ The format of frames published by the server.
+ */
+@property (readonly) SyphonPixelFormat pixelFormat;
+
+/*!
+ The names of the streams published by the server, in order (see SyphonServerOptionStreamNames). Empty if the server publishes a single stream.
+ */
+@property (readonly) NSArray<NSString *> *streamNames;
+
+/*!
+ YES if clients are currently attached, NO otherwise. Clients of the server's preview (see SyphonServerOptionPreviewScale) and tiles (see SyphonServerOptionTileSize) are included. If you generate frames frequently (for instance on a display-link timer), you may choose to test this and only call publishFrameTexture:textureTarget:imageRegion:textureDimensions:flipped: when clients are attached.
  */
 @property (readonly) BOOL hasClients;
 
+/*!
+ Hints that frames of the given size are likely to be published soon. The server prepares resources for that size in the background, so that a later change to that size doesn't delay publishing. Resources for recently used sizes are also kept, so a server which alternates between a few sizes need not call this method. Use of this method is optional.
+
+ @param size The dimensions in pixels of frames you expect to publish.
+ */
+- (void)prepareForFrameSize:(NSSize)size;
+
+/*!
+ Supplies information to accompany the next frame published. Clients receive it as the frame's SyphonFrameMetadata. Use of this method is optional.
+
+ @param captureTime The time the frame was captured or created, in nanoseconds as returned by SyphonFrameTimestampNow(). Pass 0 to use the time the frame is published.
+ @param userData Data to accompany the frame, up to SyphonFrameMetadataUserDataCapacity bytes. Longer data is truncated. May be nil.
+ */
+- (void)setNextFrameCaptureTime:(uint64_t)captureTime userData:(nullable NSData *)userData;
+
+/*!
+ Supplies a version for the content of the next frame published. Frames with the same non-zero version must have the same content: if you publish a frame with the same version as the frame before it, and the server was created with SyphonServerOptionSuppressDuplicateFrames, clients are not notified of it. Clients receive the version as the frame's SyphonFrameMetadata contentVersion. Use of this method is optional.
+
+ @param version The version of the next frame's content, or 0 for none.
+ */
+- (void)setNextFrameContentVersion:(uint64_t)version;
+
+/*!
+ The number of frames the server didn't notify clients of because they were the same as the frame before them. See SyphonServerOptionSuppressDuplicateFrames.
+ */
+@property (readonly) NSUInteger suppressedFrameCount;
+
+/*!
+ The number of surfaces the next frame could be drawn to without disturbing a client. The surface holding the frame last published is only counted by servers with a single surface, which always draw over it: servers with several surfaces (see SyphonServerOptionSurfaceCount) count the others. Only servers created with SyphonServerOptionTracksFrameReleases know which surfaces clients are reading: for other servers this is always the number of surfaces which could be drawn to.
+ */
+@property (readonly) NSUInteger freeSurfaceCount;
+
+/*!
+ Waits until at least one of the server's surfaces is free (see freeSurfaceCount), so that a frame can be drawn without disturbing a client. You might call this before drawing each frame, and skip the frame if the wait fails, to keep pace with slow clients.
+ @param timeout The longest time to wait, in seconds. Pass 0 to check without waiting.
+ @returns YES if a surface is free, NO if none became free before the timeout.
+ */
+- (BOOL)waitForFreeSurfaceWithTimeout:(NSTimeInterval)timeout;
+
 /*!
  Stops the server instance. Use of this method is optional and releasing all references to the server has the same effect.
  */
@@ -7,9 +7,28 @@
 
 #import "SyphonServerBase.h"
 #import "SyphonServerConnectionManager.h"
+#import "SyphonSurfacePool.h"
+#import "SyphonServerPreview.h"
+#import "SyphonServerTile.h"
+#import "SyphonServerPublishGroupPrivate.h"
+#import "SyphonPixelKernels.h"
 #import "SyphonPrivate.h"
+#import "SyphonFence.h"
 #import <os/lock.h>
 
+#define kSyphonServerMaxSurfaceCount 8U
+#define kSyphonServerFreeSurfacePollInterval 500 // microseconds
+#define kSyphonServerFenceSweepInterval NSEC_PER_SEC
+#define kSyphonServerHashBandRows 32
+
+/*
+ The hash of a band of rows of a frame, compared with the same band of the next frame to find duplicates.
+ */
+typedef struct SyphonServerBandHash {
+    uint64_t hash;
+    BOOL known;
+} SyphonServerBandHash;
+
 @interface SyphonServerBase (Private)
 + (void)retireRemainingServers;
 @end
@@ -20,6 +39,16 @@ static void finalizer(void)
     [SyphonServerBase retireRemainingServers];
 }
 
+static IOSurfaceRef SyphonServerFenceSurfaceCreate(void) CF_RETURNS_RETAINED
+{
+    // Clients look the fence up by ID, as they do frame surfaces
+    NSDictionary *attributes = @{(NSString *)kIOSurfaceIsGlobal: @(YES),
+                                 (NSString *)kIOSurfaceWidth: @(SyphonFenceGetSize()),
+                                 (NSString *)kIOSurfaceHeight: @(1U),
+                                 (NSString *)kIOSurfaceBytesPerElement: @(1U)};
+    return IOSurfaceCreate((CFDictionaryRef)attributes);
+}
+
 @implementation SyphonServerBase
 {
     // Once our minimum version reaches 10.12, replace
@@ -28,13 +57,47 @@ static void finalizer(void)
 
     NSString *_name;
     NSString *_uuid;
+    NSDictionary<NSString *, id<NSCoding>> *_serverDescription;
+    uint64_t _descriptionRevision;
+    NSDictionary<NSString *, id<NSCoding>> *_broadcastDescription; // the description directories were last sent
     BOOL _broadcasts;
+    SyphonPixelFormat _pixelFormat;
 
     SyphonServerConnectionManager *_connectionManager;
+    SyphonServerPreview *_preview;
+    NSSize _tileSize;
+    NSSize _canvasSize; // guarded by _mdLock
+    NSArray<SyphonServerTile *> *_tiles; // guarded by _mdLock
     id<NSObject> _activityToken;
+    __weak SyphonServerPublishGroup *_publishGroup;
 
     IOSurfaceRef _surface;
+    NSUInteger _ringLength; // the number of surfaces frames are drawn to in turn, see SyphonServerOptionSurfaceCount
+    IOSurfaceRef *_ring; // only if _ringLength > 1, when _surface is also one of these
+    NSUInteger _ringIndex; // only changed by the publishing thread, with _mdLock held, so other threads read it with that
+    BOOL _ringAdvancePending;
+    IOSurfaceRef _fenceSurface; // holds _fence, see SyphonServerOptionTracksFrameReleases
+    SyphonFenceRef _fence;
+    uint64_t *_surfaceSequences; // only with _fence, the sequence of the frame last published from each of _ring, or _surface, guarded by _mdLock
+    uint64_t _lastFenceSweep; // guarded by _mdLock
+    NSArray<NSString *> *_streamNames;
+    IOSurfaceRef *_streamSurfaces; // one for each of _streamNames, of which the first is always NULL, as it uses _surface
+    SyphonSurfacePool *_surfacePool;
     BOOL _pushPending;
+    BOOL _streamsPushPending;
+    uint64_t _frameSequence;
+    uint64_t _nextCaptureTime;
+    NSData *_nextUserData;
+    uint64_t _nextContentVersion;
+    BOOL _suppressesDuplicates;
+    BOOL _hasPublishedContent; // the following describe the last frame examined for duplicates
+    uint64_t _publishedContentVersion;
+    SyphonServerBandHash *_bandHashes; // for each band of each plane of each stream's surface
+    NSUInteger _bandHashCount;
+    NSUInteger _suppressedFrameCount;
+    BOOL _announcePending;
+    uint64_t _lastAnnounceTime;
+    int32_t _registryIndex;
 }
 
 + (NSSet *)keyPathsForValuesAffectingValueForKey:(NSString *)key
@@ -91,7 +154,86 @@ static void finalizer(void)
             _broadcasts = YES;
         }
 
+        NSNumber *pixelFormat = [options objectForKey:SyphonServerOptionPixelFormat];
+        if ([pixelFormat respondsToSelector:@selector(unsignedIntValue)])
+        {
+            _pixelFormat = [pixelFormat unsignedIntValue];
+            if (!SyphonPixelFormatIsSupported(_pixelFormat))
+            {
+                return nil;
+            }
+        }
+        else
+        {
+            _pixelFormat = SyphonPixelFormatBGRA8;
+        }
+
+        NSValue *tileSize = [options objectForKey:SyphonServerOptionTileSize];
+        if ([tileSize isKindOfClass:[NSValue class]] && strcmp([tileSize objCType], @encode(NSSize)) == 0)
+        {
+            _tileSize = NSMakeSize(floor([tileSize sizeValue].width), floor([tileSize sizeValue].height));
+            // Tiles of subsampled formats would need even dimensions and positions, which we don't support
+            if (_tileSize.width < 1 || _tileSize.height < 1 || _pixelFormat == SyphonPixelFormatYCbCr420)
+            {
+                return nil;
+            }
+        }
+
+        NSArray<NSString *> *streamNames = [options objectForKey:SyphonServerOptionStreamNames];
+        if ([streamNames isKindOfClass:[NSArray class]] && streamNames.count > 1)
+        {
+            if ([[NSSet setWithArray:streamNames] count] != streamNames.count
+                || _tileSize.width >= 1)
+            {
+                return nil;
+            }
+            _streamNames = [streamNames copy];
+            _streamSurfaces = calloc(_streamNames.count, sizeof(IOSurfaceRef));
+        }
+        else
+        {
+            _streamNames = @[];
+        }
+
+        // Tiles and streams are drawn in place, as are frames of subclasses which only get a surface when the size
+        // changes, so don't use a ring for them
+        NSNumber *surfaceCount = [options objectForKey:SyphonServerOptionSurfaceCount];
+        _ringLength = 1;
+        if ([surfaceCount respondsToSelector:@selector(unsignedIntegerValue)] && _tileSize.width < 1 && _streamNames.count == 0
+            && [[self class] drawsEachFrameToNewSurface])
+        {
+            _ringLength = MIN(MAX([surfaceCount unsignedIntegerValue], 1U), kSyphonServerMaxSurfaceCount);
+        }
+        if (_ringLength > 1)
+        {
+            _ring = calloc(_ringLength, sizeof(IOSurfaceRef));
+        }
+
+        NSNumber *tracksReleases = [options objectForKey:SyphonServerOptionTracksFrameReleases];
+        if ([tracksReleases respondsToSelector:@selector(boolValue)] && [tracksReleases boolValue])
+        {
+            _fenceSurface = SyphonServerFenceSurfaceCreate();
+            if (!_fenceSurface)
+            {
+                return nil;
+            }
+            // Kept locked for our lifetime so the fence's memory stays where it is
+            IOSurfaceLock(_fenceSurface, 0, NULL);
+            _fence = (SyphonFenceRef)IOSurfaceGetBaseAddress(_fenceSurface);
+            SyphonFenceInit(_fence);
+            _surfaceSequences = calloc(_ringLength, sizeof(uint64_t));
+        }
+
+        NSNumber *suppresses = [options objectForKey:SyphonServerOptionSuppressDuplicateFrames];
+        if ([suppresses respondsToSelector:@selector(boolValue)])
+        {
+            _suppressesDuplicates = [suppresses boolValue];
+        }
+
         _mdLock = OS_UNFAIR_LOCK_INIT;
+        _registryIndex = -1;
+
+        _surfacePool = [[SyphonSurfacePool alloc] init];
 
         _connectionManager = [[SyphonServerConnectionManager alloc] initWithUUID:_uuid options:options];
 
@@ -102,6 +244,21 @@ static void finalizer(void)
             return nil;
         }
 
+        NSNumber *previewScale = [options objectForKey:SyphonServerOptionPreviewScale];
+        if ([previewScale respondsToSelector:@selector(unsignedIntegerValue)]
+            && [previewScale unsignedIntegerValue] > 1
+            && [SyphonServerPreview supportsPixelFormat:_pixelFormat])
+        {
+            NSNumber *previewRate = [options objectForKey:SyphonServerOptionPreviewFrameRate];
+            double rate = [previewRate respondsToSelector:@selector(doubleValue)] ? [previewRate doubleValue] : 10.0;
+            // A server without its preview is still useful, so failure here isn't fatal
+            _preview = [[SyphonServerPreview alloc] initWithServerUUID:_uuid
+                                                                 scale:[previewScale unsignedIntegerValue]
+                                                             frameRate:rate
+                                                           pixelFormat:_pixelFormat];
+            [_preview.connectionManager addObserver:self forKeyPath:@"hasClients" options:NSKeyValueObservingOptionPrior context:nil];
+        }
+
         if (_broadcasts)
         {
             [[self class] addServerToRetireList:_uuid];
@@ -124,6 +281,10 @@ static void finalizer(void)
     SYPHONLOG(@"Server deallocing, name: %@, UUID: %@", self.name, [self.serverDescription objectForKey:SyphonServerDescriptionUUIDKey]);
     // Don't call anything in the subclass, it has already been dealloc'd
     [self destroyBaseResources];
+    free(_streamSurfaces);
+    free(_surfaceSequences);
+    free(_bandHashes);
+    free(_ring);
 }
 
 - (NSString*)name
@@ -140,9 +301,11 @@ static void finalizer(void)
     {
         newName = @"";
     }
-    [newName copy];
+    newName = [newName copy];
     os_unfair_lock_lock(&_mdLock);
     _name = newName;
+    _serverDescription = nil;
+    _descriptionRevision++;
     os_unfair_lock_unlock(&_mdLock);
     [_connectionManager setName:newName];
     if (_broadcasts)
@@ -151,33 +314,106 @@ static void finalizer(void)
     }
 }
 
-- (NSDictionary<NSString *, id<NSCoding>> *)serverDescription
+static NSString *SyphonServerAppName(void)
 {
-    NSDictionary<NSString *, id<NSCoding>> *surface = _connectionManager.surfaceDescription;
-    if (!surface) surface = [NSDictionary dictionary];
-    /*
-     Getting the app name: helper tasks, command-line tools, etc, don't have a NSRunningApplication instance,
-     so fall back to NSProcessInfo in those cases, then use an empty string as a last resort.
+    static NSString *appName;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        /*
+         Getting the app name: helper tasks, command-line tools, etc, don't have a NSRunningApplication instance,
+         so fall back to NSProcessInfo in those cases, then use an empty string as a last resort.
 
-     http://developer.apple.com/library/mac/qa/qa1544/_index.html
+         http://developer.apple.com/library/mac/qa/qa1544/_index.html
 
-     */
-    NSString *appName = [[NSRunningApplication currentApplication] localizedName];
-    if (!appName) appName = [[NSProcessInfo processInfo] processName];
-    if (!appName) appName = [NSString string];
+         */
+        appName = [[NSRunningApplication currentApplication] localizedName];
+        if (!appName) appName = [[NSProcessInfo processInfo] processName];
+        if (!appName) appName = [NSString string];
+    });
+    return appName;
+}
 
-    return [NSDictionary dictionaryWithObjectsAndKeys:
-            [NSNumber numberWithUnsignedInt:kSyphonDictionaryVersion], SyphonServerDescriptionDictionaryVersionKey,
-            self.name, SyphonServerDescriptionNameKey,
-            _uuid, SyphonServerDescriptionUUIDKey,
-            appName, SyphonServerDescriptionAppNameKey,
-            [NSArray arrayWithObject:surface], SyphonServerDescriptionSurfacesKey,
-            nil];
+- (NSDictionary<NSString *, id<NSCoding>> *)serverDescription
+{
+    // The description is sent with every broadcast, so is built once and rebuilt only when the name changes
+    os_unfair_lock_lock(&_mdLock);
+    if (!_serverDescription)
+    {
+        NSDictionary<NSString *, id<NSCoding>> *surface = _connectionManager.surfaceDescription;
+        if (!surface) surface = [NSDictionary dictionary];
+        // Clients which predate other formats assume BGRA8, so only servers using other formats require a newer version
+        unsigned int version = kSyphonDictionaryVersionBGRA;
+        if (_pixelFormat != SyphonPixelFormatBGRA8)
+        {
+            NSMutableDictionary<NSString *, id<NSCoding>> *formatted = [surface mutableCopy];
+            [formatted setObject:@(_pixelFormat) forKey:SyphonSurfacePixelFormat];
+            surface = formatted;
+            version = kSyphonDictionaryVersion;
+        }
+
+        _serverDescription = [NSDictionary dictionaryWithObjectsAndKeys:
+                              [NSNumber numberWithUnsignedInt:version], SyphonServerDescriptionDictionaryVersionKey,
+                              _name, SyphonServerDescriptionNameKey,
+                              _uuid, SyphonServerDescriptionUUIDKey,
+                              SyphonServerAppName(), SyphonServerDescriptionAppNameKey,
+                              [NSNumber numberWithInt:[[NSProcessInfo processInfo] processIdentifier]], SyphonServerDescriptionProcessIdentifierKey,
+                              [NSArray arrayWithObject:surface], SyphonServerDescriptionSurfacesKey,
+                              [NSNumber numberWithUnsignedLongLong:_descriptionRevision], SyphonServerDescriptionRevisionKey,
+                              nil];
+        if (_preview || _tiles.count || _streamNames.count || _fenceSurface)
+        {
+            NSMutableDictionary<NSString *, id<NSCoding>> *extended = [_serverDescription mutableCopy];
+            if (_preview)
+            {
+                [extended setObject:_preview.previewDescription forKey:SyphonServerDescriptionPreviewKey];
+            }
+            if (_tiles.count)
+            {
+                [extended setObject:[_tiles valueForKey:@"tileDescription"] forKey:SyphonServerDescriptionTilesKey];
+            }
+            if (_streamNames.count)
+            {
+                [extended setObject:_streamNames forKey:SyphonServerDescriptionStreamsKey];
+            }
+            if (_fenceSurface)
+            {
+                [extended setObject:@(IOSurfaceGetID(_fenceSurface)) forKey:SyphonServerDescriptionFenceKey];
+            }
+            _serverDescription = extended;
+        }
+    }
+    NSDictionary<NSString *, id<NSCoding>> *description = _serverDescription;
+    os_unfair_lock_unlock(&_mdLock);
+    return description;
 }
 
 - (BOOL)hasClients
 {
-    return _connectionManager.hasClients;
+    if (_connectionManager.hasClients || _preview.connectionManager.hasClients)
+    {
+        return YES;
+    }
+    os_unfair_lock_lock(&_mdLock);
+    NSArray<SyphonServerTile *> *tiles = _tiles;
+    os_unfair_lock_unlock(&_mdLock);
+    for (SyphonServerTile *tile in tiles)
+    {
+        if (tile.hasClients)
+        {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (SyphonPixelFormat)pixelFormat
+{
+    return _pixelFormat;
+}
+
+- (NSArray<NSString *> *)streamNames
+{
+    return _streamNames;
 }
 
 - (void)stop
@@ -193,6 +429,21 @@ static void finalizer(void)
         [_connectionManager stop];
         _connectionManager = nil;
     }
+    if (_preview)
+    {
+        [_preview.connectionManager removeObserver:self forKeyPath:@"hasClients"];
+        [_preview stop];
+        _preview = nil;
+    }
+    os_unfair_lock_lock(&_mdLock);
+    NSArray<SyphonServerTile *> *tiles = _tiles;
+    _tiles = nil;
+    os_unfair_lock_unlock(&_mdLock);
+    for (SyphonServerTile *tile in tiles)
+    {
+        [tile.connectionManager removeObserver:self forKeyPath:@"hasClients"];
+        [tile stop];
+    }
     if (_broadcasts)
     {
         [self stopBroadcasts];
@@ -208,6 +459,31 @@ static void finalizer(void)
         CFRelease(_surface);
         _surface = NULL;
     }
+    for (NSUInteger i = 0; i < _ringLength && _ring; i++)
+    {
+        if (_ring[i])
+        {
+            CFRelease(_ring[i]);
+            _ring[i] = NULL;
+        }
+    }
+    for (NSUInteger i = 0; i < _streamNames.count; i++)
+    {
+        if (_streamSurfaces[i])
+        {
+            CFRelease(_streamSurfaces[i]);
+            _streamSurfaces[i] = NULL;
+        }
+    }
+    [_surfacePool drain];
+    if (_fenceSurface)
+    {
+        // Clients may still hold the surface, but nothing reads the fence once we stop
+        IOSurfaceUnlock(_fenceSurface, 0, NULL);
+        CFRelease(_fenceSurface);
+        _fenceSurface = NULL;
+        _fence = NULL;
+    }
 }
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
@@ -229,11 +505,29 @@ static void finalizer(void)
     }
 }
 
+- (void)prepareForFrameSize:(NSSize)size
+{
+    size = NSMakeSize(floor(size.width), floor(size.height));
+    // Written so NaN fails too, and so the conversions below are defined
+    if (!(size.width >= 1 && size.height >= 1 && size.width <= UINT32_MAX && size.height <= UINT32_MAX))
+    {
+        return;
+    }
+    [_surfacePool prepareSurfaceForWidth:(size_t)size.width height:(size_t)size.height pixelFormat:_pixelFormat];
+}
+
++ (BOOL)drawsEachFrameToNewSurface
+{
+    return NO;
+}
+
 - (void)destroySurface
 {
     // TODO: are we locking here?
     if (_surface)
     {
+        // Keep the surface in case we return to this size
+        [_surfacePool recycleSurface:_surface];
         CFRelease(_surface);
         _surface = NULL;
     }
@@ -241,20 +535,20 @@ static void finalizer(void)
 
 - (IOSurfaceRef)newSurfaceForWidth:(size_t)width height:(size_t)height options:(NSDictionary<NSString *, id> *)options
 {
+    if (_ringLength > 1)
+    {
+        return [self newRingSurfaceForWidth:width height:height];
+    }
     // TODO: are we locking here?
     if (!_surface || IOSurfaceGetWidth(_surface) != width || IOSurfaceGetHeight(_surface) != height)
     {
         if (_surface)
         {
+            [_surfacePool recycleSurface:_surface];
             CFRelease(_surface);
         }
-        // init our texture and IOSurface
-        NSDictionary<NSString *, id> *surfaceAttributes = @{(NSString*)kIOSurfaceIsGlobal: @(YES),
-                                                            (NSString*)kIOSurfaceWidth: @(width),
-                                                            (NSString*)kIOSurfaceHeight: @(height),
-                                                            (NSString*)kIOSurfaceBytesPerElement: @(4U)};
-
-        _surface =  IOSurfaceCreate((CFDictionaryRef) surfaceAttributes);
+        // Use a pooled surface if we have one for this size, otherwise create one
+        _surface = [_surfacePool newSurfaceForWidth:width height:height pixelFormat:_pixelFormat];
 
         _pushPending = YES;
     }
@@ -266,16 +560,522 @@ static void finalizer(void)
     return _surface;
 }
 
+/*
+ Moves to the next surface in the ring, so clients can keep earlier frames while this one is drawn.
+ */
+- (IOSurfaceRef)newRingSurfaceForWidth:(size_t)width height:(size_t)height
+{
+    // Prefer a surface no client is reading, but draw to the next regardless if there is none
+    NSUInteger free[kSyphonServerMaxSurfaceCount];
+    NSUInteger next = [self getFreeSurfaces:free] ? free[0] : (_ringIndex + 1) % _ringLength;
+    IOSurfaceRef surface = _ring[next];
+    BOOL isNew = NO;
+    if (!surface || IOSurfaceGetWidth(surface) != width || IOSurfaceGetHeight(surface) != height)
+    {
+        if (surface)
+        {
+            [_surfacePool recycleSurface:surface];
+            CFRelease(surface);
+        }
+        surface = [_surfacePool newSurfaceForWidth:width height:height pixelFormat:_pixelFormat];
+        _ring[next] = surface;
+        isNew = YES;
+    }
+    if (surface == NULL)
+    {
+        return NULL;
+    }
+    os_unfair_lock_lock(&_mdLock);
+    _ringIndex = next;
+    os_unfair_lock_unlock(&_mdLock);
+    if (_surface != surface)
+    {
+        if (_surface)
+        {
+            // Still held by the ring, or recycled above
+            CFRelease(_surface);
+        }
+        _surface = (IOSurfaceRef)CFRetain(surface);
+    }
+    // Clients must be told of a new surface before its frame, but find surfaces they know from the frame
+    if (isNew)
+    {
+        _pushPending = YES;
+    }
+    else
+    {
+        _ringAdvancePending = YES;
+    }
+    // Return retained (caller releases)
+    CFRetain(surface);
+    return surface;
+}
+
+- (IOSurfaceRef)newSurfaceForStream:(NSUInteger)stream width:(size_t)width height:(size_t)height
+{
+    if (stream == 0)
+    {
+        return [self newSurfaceForWidth:width height:height options:nil];
+    }
+    if (stream >= _streamNames.count)
+    {
+        return NULL;
+    }
+    IOSurfaceRef surface = _streamSurfaces[stream];
+    if (!surface || IOSurfaceGetWidth(surface) != width || IOSurfaceGetHeight(surface) != height)
+    {
+        if (surface)
+        {
+            [_surfacePool recycleSurface:surface];
+            CFRelease(surface);
+        }
+        surface = [_surfacePool newSurfaceForWidth:width height:height pixelFormat:_pixelFormat];
+        _streamSurfaces[stream] = surface;
+        _streamsPushPending = YES;
+    }
+    if (surface)
+    {
+        // Return retained (caller releases)
+        CFRetain(surface);
+    }
+    return surface;
+}
+
+- (void)setNextFrameCaptureTime:(uint64_t)captureTime userData:(NSData *)userData
+{
+    os_unfair_lock_lock(&_mdLock);
+    _nextCaptureTime = captureTime;
+    _nextUserData = [userData copy];
+    os_unfair_lock_unlock(&_mdLock);
+}
+
+- (SyphonFrameMetadata)metadataForNewFrame
+{
+    // The sequence is assigned when the frame is published, so a suppressed frame leaves no gap
+    SyphonFrameMetadata metadata = {0};
+    os_unfair_lock_lock(&_mdLock);
+    metadata.captureTime = _nextCaptureTime;
+    if (_nextUserData)
+    {
+        metadata.userDataLength = (uint32_t)MIN(_nextUserData.length, SyphonFrameMetadataUserDataCapacity);
+        [_nextUserData getBytes:metadata.userData length:metadata.userDataLength];
+    }
+    metadata.contentVersion = _nextContentVersion;
+    _nextCaptureTime = 0;
+    _nextUserData = nil;
+    _nextContentVersion = 0;
+    os_unfair_lock_unlock(&_mdLock);
+    // Tiled frames are published to each tile rather than through -publishWithFrameMetadata:, so aren't grouped
+    if (_tileSize.width < 1)
+    {
+        [_publishGroup claimFrameFromServer:self];
+    }
+    return metadata;
+}
+
+- (uint64_t)nextFrameSequence
+{
+    os_unfair_lock_lock(&_mdLock);
+    uint64_t sequence = ++_frameSequence;
+    os_unfair_lock_unlock(&_mdLock);
+    return sequence;
+}
+
+- (void)setNextFrameContentVersion:(uint64_t)version
+{
+    os_unfair_lock_lock(&_mdLock);
+    _nextContentVersion = version;
+    os_unfair_lock_unlock(&_mdLock);
+}
+
+static NSUInteger SyphonServerFilterFreeSurfaces(SyphonFenceRef fence, const NSUInteger *candidates, const uint64_t *sequences, NSUInteger count, NSUInteger *free)
+{
+    NSUInteger result = 0;
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        if (sequences[i] == 0 || SyphonFenceGetReaderCount(fence, sequences[i]) == 0)
+        {
+            free[result++] = candidates[i];
+        }
+    }
+    return result;
+}
+
+/*
+ Fills free with the indexes (into _ring, or 0 for _surface) of the surfaces the next frame may be drawn to without
+ disturbing a client, in the order they would be chosen, and returns their number. The surface of the frame last
+ published is only a candidate without a ring, as the next frame always replaces it then. A surface not yet
+ allocated, or not yet published from, has no readers.
+ */
+- (NSUInteger)getFreeSurfaces:(NSUInteger *)free
+{
+    NSUInteger candidates[kSyphonServerMaxSurfaceCount];
+    uint64_t sequences[kSyphonServerMaxSurfaceCount] = {0};
+    NSUInteger candidateCount = _ringLength > 1 ? _ringLength - 1 : 1;
+    // Called from any thread through freeSurfaceCount, while the publishing thread moves through the ring
+    os_unfair_lock_lock(&_mdLock);
+    for (NSUInteger i = 0; i < candidateCount; i++)
+    {
+        candidates[i] = _ringLength > 1 ? (_ringIndex + 1 + i) % _ringLength : 0;
+    }
+    SyphonFenceRef fence = _fence;
+    for (NSUInteger i = 0; fence && i < candidateCount; i++)
+    {
+        sequences[i] = _surfaceSequences[candidates[i]];
+    }
+    os_unfair_lock_unlock(&_mdLock);
+    NSUInteger count = SyphonServerFilterFreeSurfaces(fence, candidates, sequences, candidateCount, free);
+    if (count == 0 && fence)
+    {
+        // Clients which exited while reading would hold surfaces forever, but looking for them costs a system
+        // call per client, so is only done occasionally, when it might help
+        uint64_t now = SyphonFrameTimestampNow();
+        os_unfair_lock_lock(&_mdLock);
+        BOOL sweep = now - _lastFenceSweep >= kSyphonServerFenceSweepInterval;
+        if (sweep)
+        {
+            _lastFenceSweep = now;
+        }
+        os_unfair_lock_unlock(&_mdLock);
+        if (sweep && SyphonFenceReclaimSlots(fence) > 0)
+        {
+            count = SyphonServerFilterFreeSurfaces(fence, candidates, sequences, candidateCount, free);
+        }
+    }
+    return count;
+}
+
+- (NSUInteger)freeSurfaceCount
+{
+    NSUInteger free[kSyphonServerMaxSurfaceCount];
+    return [self getFreeSurfaces:free];
+}
+
+- (BOOL)waitForFreeSurfaceWithTimeout:(NSTimeInterval)timeout
+{
+    // Clients don't signal releases, so poll: a query reads a cache line per client and makes no system calls
+    uint64_t deadline = SyphonFrameTimestampNow() + (uint64_t)(MAX(timeout, 0.0) * NSEC_PER_SEC);
+    while (self.freeSurfaceCount == 0)
+    {
+        if (SyphonFrameTimestampNow() >= deadline)
+        {
+            return NO;
+        }
+        usleep(kSyphonServerFreeSurfacePollInterval);
+    }
+    return YES;
+}
+
+- (NSUInteger)suppressedFrameCount
+{
+    os_unfair_lock_lock(&_mdLock);
+    NSUInteger result = _suppressedFrameCount;
+    os_unfair_lock_unlock(&_mdLock);
+    return result;
+}
+
+static NSUInteger SyphonServerSurfaceBandCount(IOSurfaceRef surface)
+{
+    if (surface == NULL)
+    {
+        return 0;
+    }
+    size_t planeCount = IOSurfaceGetPlaneCount(surface);
+    NSUInteger count = 0;
+    for (size_t plane = 0; plane < MAX(planeCount, 1U); plane++)
+    {
+        size_t rows = planeCount ? IOSurfaceGetHeightOfPlane(surface, plane) : IOSurfaceGetHeight(surface);
+        count += (rows + kSyphonServerHashBandRows - 1) / kSyphonServerHashBandRows;
+    }
+    return count;
+}
+
+static BOOL SyphonServerRectsIntersectRows(const NSRect *rects, NSUInteger count, size_t first, size_t last)
+{
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        if (NSMinY(rects[i]) < last && NSMaxY(rects[i]) > first)
+        {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+/*
+ Compares a surface with the hashes of the same bands of the previous frame, updating them, and returns YES if it is
+ unchanged. Bands which don't intersect rects (in surface rows) are taken to be unchanged, unless their hash is
+ unknown: pass no rects to read every band. Reading stops at the first band which differs, after which the remaining
+ bands become unknown, so a frame which has changed is usually rejected after reading only a little of it. Unknown
+ bands are all read, so content which stops changing is recognised by the second frame after.
+ */
+static BOOL SyphonServerSurfaceMatchesBands(IOSurfaceRef surface, SyphonServerBandHash *bands, const NSRect *rects, NSUInteger rectCount)
+{
+    NSUInteger bandCount = SyphonServerSurfaceBandCount(surface);
+    if (bandCount == 0)
+    {
+        return YES;
+    }
+    if (IOSurfaceLock(surface, kIOSurfaceLockReadOnly, NULL) != kIOReturnSuccess)
+    {
+        for (NSUInteger i = 0; i < bandCount; i++)
+        {
+            bands[i].known = NO;
+        }
+        return NO;
+    }
+    BOOL matches = YES;
+    BOOL changed = NO;
+    size_t planeCount = IOSurfaceGetPlaneCount(surface);
+    size_t height = IOSurfaceGetHeight(surface);
+    NSUInteger band = 0;
+    for (size_t plane = 0; plane < MAX(planeCount, 1U); plane++)
+    {
+        const uint8_t *base = planeCount ? IOSurfaceGetBaseAddressOfPlane(surface, plane) : IOSurfaceGetBaseAddress(surface);
+        size_t bytesPerRow = planeCount ? IOSurfaceGetBytesPerRowOfPlane(surface, plane) : IOSurfaceGetBytesPerRow(surface);
+        size_t rowLength = planeCount ? IOSurfaceGetWidthOfPlane(surface, plane) * IOSurfaceGetBytesPerElementOfPlane(surface, plane)
+                                      : IOSurfaceGetWidth(surface) * IOSurfaceGetBytesPerElement(surface);
+        size_t rows = planeCount ? IOSurfaceGetHeightOfPlane(surface, plane) : height;
+        for (size_t y = 0; y < rows; y += kSyphonServerHashBandRows, band++)
+        {
+            SyphonServerBandHash *entry = &bands[band];
+            if (changed)
+            {
+                entry->known = NO;
+                continue;
+            }
+            size_t bandRows = MIN(kSyphonServerHashBandRows, rows - y);
+            // Subsampled planes have fewer rows than the surface
+            if (entry->known && rectCount
+                && !SyphonServerRectsIntersectRows(rects, rectCount, y * height / rows, ((y + bandRows) * height + rows - 1) / rows))
+            {
+                continue;
+            }
+            uint64_t hash = SyphonPixelHashPlane(base + (y * bytesPerRow), bytesPerRow, rowLength, bandRows, 0);
+            if (!entry->known || entry->hash != hash)
+            {
+                matches = NO;
+                changed = entry->known;
+            }
+            entry->hash = hash;
+            entry->known = YES;
+        }
+    }
+    IOSurfaceUnlock(surface, kIOSurfaceLockReadOnly, NULL);
+    return matches;
+}
+
+- (BOOL)isDuplicateFrame:(const SyphonFrameMetadata *)metadata
+{
+    // The surfaces are only read if the frame has no version, and then only until a change is found
+    BOOL duplicate = _hasPublishedContent && metadata->contentVersion == _publishedContentVersion;
+    NSUInteger bandCount = SyphonServerSurfaceBandCount(_surface);
+    for (NSUInteger i = 1; i < _streamNames.count; i++)
+    {
+        bandCount += SyphonServerSurfaceBandCount(_streamSurfaces[i]);
+    }
+    if (bandCount != _bandHashCount)
+    {
+        // The frame size changed
+        free(_bandHashes);
+        _bandHashes = calloc(bandCount, sizeof(SyphonServerBandHash));
+        _bandHashCount = _bandHashes ? bandCount : 0;
+        duplicate = NO;
+    }
+    if (metadata->contentVersion != 0 || !_hasPublishedContent)
+    {
+        // Bands aren't read for versioned frames, so we no longer know the previous frame's content
+        for (NSUInteger i = 0; i < _bandHashCount; i++)
+        {
+            _bandHashes[i].known = NO;
+        }
+    }
+    if (metadata->contentVersion == 0 && _bandHashes)
+    {
+        // Dirty rects describe the primary stream, so other streams are read in full
+        SyphonServerBandHash *bands = _bandHashes;
+        duplicate = SyphonServerSurfaceMatchesBands(_surface, bands, metadata->dirtyRects, metadata->dirtyRectCount) && duplicate;
+        bands += SyphonServerSurfaceBandCount(_surface);
+        for (NSUInteger i = 1; i < _streamNames.count; i++)
+        {
+            // Every stream must be unchanged for the frame set to be a duplicate
+            duplicate = SyphonServerSurfaceMatchesBands(_streamSurfaces[i], bands, NULL, 0) && duplicate;
+            bands += SyphonServerSurfaceBandCount(_streamSurfaces[i]);
+        }
+    }
+    else if (metadata->contentVersion == 0)
+    {
+        duplicate = NO;
+    }
+    _hasPublishedContent = YES;
+    _publishedContentVersion = metadata->contentVersion;
+    return duplicate;
+}
+
 - (void)publish
 {
+    [self publishWithFrameMetadata:[self metadataForNewFrame]];
+}
+
+- (void)publishWithFrameMetadata:(SyphonFrameMetadata)metadata
+{
+    if (_suppressesDuplicates)
+    {
+        if (!self.hasClients)
+        {
+            // Don't read frames nobody will see, and always publish the first frame after a client connects
+            _hasPublishedContent = NO;
+        }
+        else if ([self isDuplicateFrame:&metadata] && !_pushPending && !_streamsPushPending)
+        {
+            // A new surface is always published, as clients don't have it yet
+            os_unfair_lock_lock(&_mdLock);
+            _suppressedFrameCount++;
+            os_unfair_lock_unlock(&_mdLock);
+            [_publishGroup skipFrameFromServer:self];
+            return;
+        }
+    }
     if (_pushPending)
     {
         // Push the new surface ID to clients
         [_connectionManager setSurfaceID:IOSurfaceGetID(_surface)];
-        _pushPending = NO;
     }
-    [_connectionManager publishNewFrame];
+    else if (_ringAdvancePending)
+    {
+        [_connectionManager setRingSurfaceID:IOSurfaceGetID(_surface)];
+    }
+    _ringAdvancePending = NO;
+    // A frame which brings a new surface is announced directly, after the surface, which clients must receive first
+    BOOL announcesSurface = _pushPending || _streamsPushPending;
+    if (_streamNames.count && (_pushPending || _streamsPushPending))
+    {
+        // Clients receive every stream's surface before the frame which uses them
+        NSMutableArray<NSNumber *> *streamIDs = [NSMutableArray arrayWithCapacity:_streamNames.count];
+        [streamIDs addObject:@(_surface ? IOSurfaceGetID(_surface) : 0)];
+        for (NSUInteger i = 1; i < _streamNames.count; i++)
+        {
+            [streamIDs addObject:@(_streamSurfaces[i] ? IOSurfaceGetID(_streamSurfaces[i]) : 0)];
+        }
+        [_connectionManager setStreamSurfaceIDs:streamIDs];
+        _streamsPushPending = NO;
+    }
+    _pushPending = NO;
+    metadata.sequence = [self nextFrameSequence];
+    metadata.publishTime = SyphonFrameTimestampNow();
+    if (metadata.captureTime == 0)
+    {
+        metadata.captureTime = metadata.publishTime;
+    }
+    if (_surfaceSequences)
+    {
+        os_unfair_lock_lock(&_mdLock);
+        _surfaceSequences[_ring ? _ringIndex : 0] = metadata.sequence;
+        os_unfair_lock_unlock(&_mdLock);
+    }
+    NSData *data = SyphonFrameMetadataCreateData(&metadata, _surface ? IOSurfaceGetID(_surface) : 0);
+    if (![_publishGroup deferFrameMetadata:data fromServer:self deferrable:!announcesSurface])
+    {
+        [_connectionManager publishNewFrameWithMetadata:data];
+    }
+    [_preview publishFromSurface:_surface metadata:metadata];
+}
+
+#pragma mark Publish Groups
+
+- (SyphonServerPublishGroup *)publishGroup
+{
+    return _publishGroup;
+}
+
+- (void)setPublishGroup:(SyphonServerPublishGroup *)publishGroup
+{
+    _publishGroup = publishGroup;
+}
+
+- (void)announceFrameMetadata:(NSData *)metadata batches:(NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSData *> *> *)batches
+{
+    [_connectionManager publishNewFrameWithMetadata:metadata batches:batches];
+}
+
+#pragma mark Tiling
+
+- (NSSize)tileSize
+{
+    return _tileSize;
+}
+
+- (NSArray<SyphonServerTile *> *)tilesForCanvasSize:(NSSize)size
+{
+    // Only called from the publishing thread, so the tiles can't change during this method
+    os_unfair_lock_lock(&_mdLock);
+    NSArray<SyphonServerTile *> *tiles = _tiles;
+    NSSize previous = _canvasSize;
+    os_unfair_lock_unlock(&_mdLock);
+    if (_tileSize.width < 1 || _connectionManager == nil || NSEqualSizes(size, previous))
+    {
+        return tiles ?: @[];
+    }
+
+    NSDictionary<NSString *, id<NSCoding>> *surface = _connectionManager.surfaceDescription;
+    if (_pixelFormat != SyphonPixelFormatBGRA8)
+    {
+        NSMutableDictionary<NSString *, id<NSCoding>> *formatted = [surface mutableCopy];
+        [formatted setObject:@(_pixelFormat) forKey:SyphonSurfacePixelFormat];
+        surface = formatted;
+    }
+
+    // Tiles at positions in both grids are kept, so their clients remain connected
+    NSUInteger previousColumns = ceil(previous.width / _tileSize.width);
+    NSUInteger previousRows = ceil(previous.height / _tileSize.height);
+    NSUInteger columns = ceil(size.width / _tileSize.width);
+    NSUInteger rows = ceil(size.height / _tileSize.height);
+    NSMutableArray<SyphonServerTile *> *updated = [NSMutableArray arrayWithCapacity:columns * rows];
+    NSMutableSet<SyphonServerTile *> *removed = [NSMutableSet setWithArray:tiles ?: @[]];
+    for (NSUInteger row = 0; row < rows; row++)
+    {
+        for (NSUInteger column = 0; column < columns; column++)
+        {
+            SyphonServerTile *tile = nil;
+            if (column < previousColumns && row < previousRows && tiles.count == previousColumns * previousRows)
+            {
+                tile = [tiles objectAtIndex:(row * previousColumns) + column];
+                [removed removeObject:tile];
+            }
+            else
+            {
+                tile = [[SyphonServerTile alloc] initWithServerUUID:_uuid column:column row:row surfaceDescription:surface pixelFormat:_pixelFormat];
+                if (!tile)
+                {
+                    SYPHONLOG(@"Failed to create tile at column %lu, row %lu", (unsigned long)column, (unsigned long)row);
+                    continue;
+                }
+                [tile.connectionManager addObserver:self forKeyPath:@"hasClients" options:NSKeyValueObservingOptionPrior context:nil];
+            }
+            NSRect rect = NSMakeRect(column * _tileSize.width, row * _tileSize.height, _tileSize.width, _tileSize.height);
+            tile.rect = NSIntersectionRect(rect, NSMakeRect(0, 0, floor(size.width), floor(size.height)));
+            [updated addObject:tile];
+        }
+    }
+    for (SyphonServerTile *tile in removed)
+    {
+        [tile.connectionManager removeObserver:self forKeyPath:@"hasClients"];
+        [tile stop];
+    }
+
+    os_unfair_lock_lock(&_mdLock);
+    _tiles = updated;
+    _canvasSize = size;
+    _serverDescription = nil;
+    _descriptionRevision++;
+    os_unfair_lock_unlock(&_mdLock);
+    if (_broadcasts)
+    {
+        [self broadcastServerUpdate];
+    }
+    return updated;
 }
+
 #pragma mark Notification Handling for Server Presence
 /*
  Broadcast and discovery is done via NSDistributedNotificationCenter. Servers notify announce, change (currently only affects name) and retirement.
@@ -333,19 +1133,83 @@ static NSMutableSet *mRetireList = nil;
     }
 }
 
+- (NSData *)registryRecord
+{
+    return [NSPropertyListSerialization dataWithPropertyList:self.serverDescription format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+}
+
 - (void)startBroadcasts
 {
+    // List ourself in the shared registry so directories in new processes see us immediately
+    SyphonRegistryRef registry = SyphonSharedRegistryGet();
+    if (registry)
+    {
+        NSData *record = [self registryRecord];
+        _registryIndex = SyphonRegistryAdd(registry, record.bytes, (uint32_t)record.length);
+    }
+
     // Register for any Announcement Requests.
     [[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleDiscoveryRequest:) name:SyphonServerAnnounceRequest object:nil];
+    // Directories which missed a change ask us alone to announce ourself
+    [[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleDiscoveryRequest:) name:SyphonServerAnnounceRequestForServer object:_uuid];
 
     [self broadcastServerAnnounce];
 }
 
+/*
+ Every server in every process receives every discovery request, so we coalesce requests and answer at most once per
+ interval, after a random delay so that many servers don't all answer at once. Directories allow several seconds for
+ a response.
+ */
+#define kSyphonServerAnnounceInterval (NSEC_PER_SEC / 2)
+#define kSyphonServerAnnounceJitterMS 250
+
+#if SYPHON_LEGACY_UPDATES
+// Set once any directory which predates SyphonServerChange has asked servers to announce themselves
+static atomic_bool SyphonServerHasLegacyDirectories = false;
+#endif
+
 - (void) handleDiscoveryRequest:(NSNotification*) aNotification
 {
     SYPHONLOG(@"Got Discovery Request");
+#if SYPHON_LEGACY_UPDATES
+    if ([aNotification.name isEqualToString:SyphonServerAnnounceRequest]
+        && ![[aNotification.userInfo objectForKey:SyphonServerAnnounceRequestAppliesChangesKey] boolValue])
+    {
+        atomic_store(&SyphonServerHasLegacyDirectories, true);
+    }
+#endif
 
-    [self broadcastServerAnnounce];
+    os_unfair_lock_lock(&_mdLock);
+    BOOL shouldSchedule = !_announcePending;
+    _announcePending = YES;
+    uint64_t earliest = _lastAnnounceTime + kSyphonServerAnnounceInterval;
+    os_unfair_lock_unlock(&_mdLock);
+    if (shouldSchedule)
+    {
+        uint64_t now = SyphonFrameTimestampNow();
+        uint64_t delay = arc4random_uniform(kSyphonServerAnnounceJitterMS) * NSEC_PER_MSEC;
+        if (earliest > now + delay)
+        {
+            delay = earliest - now;
+        }
+        __weak SyphonServerBase *weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, delay), dispatch_get_main_queue(), ^{
+            [weakSelf respondToDiscoveryRequest];
+        });
+    }
+}
+
+- (void)respondToDiscoveryRequest
+{
+    os_unfair_lock_lock(&_mdLock);
+    _announcePending = NO;
+    os_unfair_lock_unlock(&_mdLock);
+    // The server may have been stopped since the request
+    if (_connectionManager)
+    {
+        [self broadcastServerAnnounce];
+    }
 }
 
 - (void)broadcastServerAnnounce
@@ -353,6 +1217,10 @@ static NSMutableSet *mRetireList = nil;
     if (_broadcasts)
     {
         NSDictionary *description = self.serverDescription;
+        os_unfair_lock_lock(&_mdLock);
+        _lastAnnounceTime = SyphonFrameTimestampNow();
+        _broadcastDescription = description;
+        os_unfair_lock_unlock(&_mdLock);
         [[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerAnnounce
                                                                        object:[description objectForKey:SyphonServerDescriptionUUIDKey]
                                                                      userInfo:description
@@ -362,20 +1230,73 @@ static NSMutableSet *mRetireList = nil;
 
 - (void)broadcastServerUpdate
 {
+    if (_registryIndex != -1)
+    {
+        NSData *record = [self registryRecord];
+        if (!SyphonRegistryUpdate(SyphonSharedRegistryGet(), _registryIndex, record.bytes, (uint32_t)record.length))
+        {
+            // The description no longer fits, rely on notifications alone
+            SyphonRegistryRemove(SyphonSharedRegistryGet(), _registryIndex);
+            _registryIndex = -1;
+        }
+    }
+
     NSDictionary *description = self.serverDescription;
-    [[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerUpdate
-                                                                   object:[description objectForKey:SyphonServerDescriptionUUIDKey]
-                                                                 userInfo:description
+    os_unfair_lock_lock(&_mdLock);
+    NSDictionary *previous = _broadcastDescription;
+    _broadcastDescription = description;
+    os_unfair_lock_unlock(&_mdLock);
+
+    // Send only what changed since the description directories last received
+    NSMutableDictionary *change = [NSMutableDictionary dictionaryWithCapacity:4];
+    NSMutableArray *removed = [NSMutableArray array];
+    [description enumerateKeysAndObjectsUsingBlock:^(NSString *key, id obj, BOOL *stop) {
+        if (![obj isEqual:[previous objectForKey:key]])
+        {
+            [change setObject:obj forKey:key];
+        }
+    }];
+    for (NSString *key in previous) {
+        if ([description objectForKey:key] == nil)
+        {
+            [removed addObject:key];
+        }
+    }
+    [change setObject:_uuid forKey:SyphonServerDescriptionUUIDKey];
+    [change setObject:[previous objectForKey:SyphonServerDescriptionRevisionKey] ?: @0 forKey:SyphonServerChangeBaseRevisionKey];
+    if ([removed count] > 0)
+    {
+        [change setObject:removed forKey:SyphonServerChangeRemovedKeysKey];
+    }
+    [[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerChange
+                                                                   object:_uuid
+                                                                 userInfo:change
                                                        deliverImmediately:YES];
+#if SYPHON_LEGACY_UPDATES
+    if (atomic_load(&SyphonServerHasLegacyDirectories))
+    {
+        [[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerUpdate
+                                                                       object:_uuid
+                                                                     userInfo:description
+                                                           deliverImmediately:YES];
+    }
+#endif
 }
 
 - (void)stopBroadcasts
 {
+    if (_registryIndex != -1)
+    {
+        SyphonRegistryRemove(SyphonSharedRegistryGet(), _registryIndex);
+        _registryIndex = -1;
+    }
+
     [[NSDistributedNotificationCenter defaultCenter] removeObserver:self];
-    NSDictionary *description = self.serverDescription;
+    // Directories identify servers by UUID alone, and use their own description in their retire notifications
+    NSDictionary *retirement = [NSDictionary dictionaryWithObject:_uuid forKey:SyphonServerDescriptionUUIDKey];
     [[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerRetire
-                                                                   object:[description objectForKey:SyphonServerDescriptionUUIDKey]
-                                                                 userInfo:description
+                                                                   object:_uuid
+                                                                 userInfo:retirement
                                                        deliverImmediately:YES];
 }
 
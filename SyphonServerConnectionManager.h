@@ -47,7 +47,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 - (BOOL)start;
 - (void)stop;
 @property (readonly) BOOL hasClients;
-- (void)publishNewFrame;
+- (void)publishNewFrameWithMetadata:(NSData *)metadata; // metadata as returned by SyphonFrameMetadataCreateData()
+// As -publishNewFrameWithMetadata:, except that the metadata for clients which accept batches is added to batches,
+// keyed by the name of each client's frame port and then by the client's UUID, for the caller to send
+- (void)publishNewFrameWithMetadata:(NSData *)metadata batches:(NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSData *> *> *)batches;
 - (void)setSurfaceID:(IOSurfaceID)newID;
+// For servers with several surfaces (see SyphonServerOptionSurfaceCount), when a frame is drawn to another existing surface
+- (void)setRingSurfaceID:(IOSurfaceID)newID;
+- (void)setStreamSurfaceIDs:(NSArray<NSNumber *> *)streamIDs; // for servers with several streams, after -setSurfaceID:
 - (void)setName:(NSString *)name;
 @end
@@ -36,6 +36,7 @@
 - (void)removeInfoClient:(NSString *)clientUUID;
 - (void)addFrameClient:(NSString *)clientUUID;
 - (void)removeFrameClient:(NSString *)clientUUID;
+- (void)addFrameBatchClient:(NSString *)clientUUID port:(NSString *)portName;
 - (void)handleDeadConnection;
 @end
 
@@ -44,9 +45,12 @@
     SyphonMessageReceiver *_connection;
     NSMutableDictionary<NSString *, SyphonMessageSender *> *_infoClients;
     NSMutableDictionary<NSString *, SyphonMessageSender *> *_frameClients;
+    NSMutableDictionary<NSString *, NSString *> *_framePorts; // frame port names of frame clients which accept batches
     BOOL _alive;
     NSString *_uuid;
     IOSurfaceID _surfaceID;
+    NSArray<NSNumber *> *_streamSurfaceIDs;
+    NSData *_frameMessage;
     SyphonSafeBool _hasClients;
     dispatch_queue_t _queue;
 }
@@ -91,6 +95,7 @@
 		_uuid = [uuid copy];
 		_infoClients = [[NSMutableDictionary alloc] initWithCapacity:1];
 		_frameClients = [[NSMutableDictionary alloc] initWithCapacity:1];
+		_framePorts = [[NSMutableDictionary alloc] initWithCapacity:1];
 		_queue = dispatch_queue_create([uuid cStringUsingEncoding:NSUTF8StringEncoding], NULL);
 	}
 	return self;
@@ -117,7 +122,12 @@
 
 - (NSDictionary<NSString *, id<NSCoding>> *)surfaceDescription
 {
-	return [NSDictionary dictionaryWithObject:SyphonSurfaceTypeIOSurface forKey:SyphonSurfaceType];
+	static NSDictionary<NSString *, id<NSCoding>> *description;
+	static dispatch_once_t once;
+	dispatch_once(&once, ^{
+		description = [NSDictionary dictionaryWithObject:SyphonSurfaceTypeIOSurface forKey:SyphonSurfaceType];
+	});
+	return description;
 }
 
 - (void)addInfoClient:(NSString *)clientUUID
@@ -140,6 +150,10 @@
 				{
                     [sender send:[NSNumber numberWithUnsignedInt:self->_surfaceID] ofType:SyphonMessageTypeUpdateSurfaceID];
 				}
+                if (self->_streamSurfaceIDs)
+				{
+                    [sender send:self->_streamSurfaceIDs ofType:SyphonMessageTypeUpdateStreamSurfaceIDs];
+				}
                 [self->_infoClients setObject:sender forKey:clientUUID];
 				if (countBefore == 0)
 				{
@@ -205,7 +219,7 @@
 				// If we have a valid surface
 				// then we must have an existing frame
 				// so publish it
-				[sender send:nil ofType:SyphonMessageTypeNewFrame];
+                [sender sendEncodedPayload:self->_frameMessage ofType:SyphonMessageTypeNewFrame];
 			}
 		}
 	});
@@ -218,6 +232,18 @@
         if (self->_alive && clientUUID)
 		{
             [self->_frameClients removeObjectForKey:clientUUID];
+            [self->_framePorts removeObjectForKey:clientUUID];
+		}
+	});
+}
+
+- (void)addFrameBatchClient:(NSString *)clientUUID port:(NSString *)portName
+{
+	dispatch_async(_queue, ^{
+        if (self->_alive && clientUUID && portName && [self->_frameClients objectForKey:clientUUID])
+		{
+			SYPHONLOG(@"Frame client %@ accepts batches at %@", clientUUID, portName);
+            [self->_framePorts setObject:portName forKey:clientUUID];
 		}
 	});
 }
@@ -232,7 +258,7 @@
 	dispatch_sync(_queue, ^{
 		if (!_alive)
 		{
-            NSSet *classes = [NSSet setWithObjects:[NSString class], nil];
+            NSSet *classes = [NSSet setWithObjects:[NSString class], [NSArray class], nil];
 			_connection = [[SyphonMessageReceiver alloc] initForName:_uuid
 															protocol:SyphonMessagingProtocolCFMessage
                                                       allowedClasses:classes
@@ -250,6 +276,12 @@
 																	 case SyphonMessageTypeRemoveClientForFrames:
 																		 [self removeFrameClient:(NSString *)data];
 																		 break;
+																	 case SyphonMessageTypeAddClientForFrameBatches:
+																		 if ([data isKindOfClass:[NSArray class]] && [(NSArray *)data count] == 2)
+																		 {
+																			 [self addFrameBatchClient:[(NSArray *)data objectAtIndex:0] port:[(NSArray *)data objectAtIndex:1]];
+																		 }
+																		 break;
 																	 default:
 																		 SYPHONLOG(@"Unknown message type %u received.", type);
 																		 break;
@@ -291,6 +323,7 @@
 			
 			[_infoClients removeAllObjects];
 			[_frameClients removeAllObjects];
+			[_framePorts removeAllObjects];
 			
 			[_connection invalidate];
 			_connection = nil;
@@ -312,11 +345,40 @@
 
 #pragma mark Serving
 
-- (void)publishNewFrame
+- (void)publishNewFrameWithMetadata:(NSData *)metadata
 {
+	// Encode once for every client
+	NSData *encoded = [SyphonMessageSender encodePayload:metadata];
 	dispatch_sync(_queue, ^{
+		_frameMessage = encoded;
 		[_frameClients enumerateKeysAndObjectsUsingBlock:^(NSString *key, SyphonMessageSender *client, BOOL *stop) {
-			[client send:nil ofType:SyphonMessageTypeNewFrame];
+			[client sendEncodedPayload:encoded ofType:SyphonMessageTypeNewFrame];
+		}];
+	});
+}
+
+- (void)publishNewFrameWithMetadata:(NSData *)metadata batches:(NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSData *> *> *)batches
+{
+	// Clients which don't accept batches, and any which connect later, are sent the frame as usual
+	NSData *encoded = [SyphonMessageSender encodePayload:metadata];
+	dispatch_sync(_queue, ^{
+		_frameMessage = encoded;
+		[_frameClients enumerateKeysAndObjectsUsingBlock:^(NSString *key, SyphonMessageSender *client, BOOL *stop) {
+			NSString *port = [_framePorts objectForKey:key];
+			if (port)
+			{
+				NSMutableDictionary<NSString *, NSData *> *batch = [batches objectForKey:port];
+				if (batch == nil)
+				{
+					batch = [NSMutableDictionary dictionaryWithCapacity:4];
+					[batches setObject:batch forKey:port];
+				}
+				[batch setObject:metadata forKey:key];
+			}
+			else
+			{
+				[client sendEncodedPayload:encoded ofType:SyphonMessageTypeNewFrame];
+			}
 		}];
 	});
 }
@@ -331,6 +393,31 @@
 	});
 }
 
+- (void)setRingSurfaceID:(IOSurfaceID)newID
+{
+	dispatch_sync(_queue, ^{
+		_surfaceID = newID;
+		// Clients with a frame port find the surface in each frame's metadata
+		[_infoClients enumerateKeysAndObjectsUsingBlock:^(NSString * key, SyphonMessageSender * client, BOOL *stop) {
+			if ([_framePorts objectForKey:key] == nil)
+			{
+				[client send:[NSNumber numberWithUnsignedInt:newID] ofType:SyphonMessageTypeUpdateSurfaceID];
+			}
+		}];
+	});
+}
+
+- (void)setStreamSurfaceIDs:(NSArray<NSNumber *> *)streamIDs
+{
+	streamIDs = [streamIDs copy];
+	dispatch_sync(_queue, ^{
+		_streamSurfaceIDs = streamIDs;
+		[_infoClients enumerateKeysAndObjectsUsingBlock:^(NSString * key, SyphonMessageSender * client, BOOL *stop) {
+			[client send:streamIDs ofType:SyphonMessageTypeUpdateStreamSurfaceIDs];
+		}];
+	});
+}
+
 #pragma mark Notification Handling for NSConnection
 
 - (void)handleDeadConnection
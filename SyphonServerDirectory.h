@@ -55,6 +55,18 @@ extern NSString * const SyphonServerDescriptionAppNameKey;
 */
 extern NSString * const SyphonServerDescriptionIconKey;
 
+/*!
+ @relates SyphonServerDirectory
+ The object for this key is a NSArray of NSDictionaries, one for each tile of a server which publishes its frames as tiles (see SyphonServerOptionTileSize), ordered by row then by column. Each dictionary contains ``SyphonServerDescriptionTileRectKey``. To receive one tile, create a client with ``SyphonClientOptionTileIndex`` set to its index in this array. The tiles change if the server's frames change size. This key is not guaranteed to exist in the dictionary.
+*/
+extern NSString * const SyphonServerDescriptionTilesKey;
+
+/*!
+ @relates SyphonServerDirectory
+ The object for this key is a NSArray of four NSNumbers: the x and y position of the tile within the server's frames, and its width and height, in pixels, where the origin is the first pixel of the frame's first row. This key is found in the dictionaries for ``SyphonServerDescriptionTilesKey``.
+*/
+extern NSString * const SyphonServerDescriptionTileRectKey;
+
 /*!
  @relates SyphonServerDirectory
  A new SyphonServer is available on the system. The notification object is the shared SyphonServerDirectory instance. The user info dictionary describes the server and may contain SyphonServerDescription keys.
@@ -73,6 +85,8 @@ extern NSString * const SyphonServerUpdateNotification;
 */
 extern NSString * const SyphonServerRetireNotification;
 
+@class SyphonServerDirectoryQuery;
+
 /*!
  A server directory provides information on available Syphon servers. Servers are represented by dictionaries. Generally you can expect to find some or all of the keys listed in Constants.
 */
@@ -80,7 +94,7 @@ extern NSString * const SyphonServerRetireNotification;
 @interface SyphonServerDirectory : NSObject
 
 /*!
- Returns the shared server directory instance. This object is KVO complaint, and can be used to observe changes in server availability, server names and statuses. 
+ Returns the shared server directory instance. This object is KVO complaint, and can be used to observe changes in server availability, server names and statuses. The directory starts looking for servers the first time this method is called, so you must call it before you expect to receive ``SyphonServerAnnounceNotification``, ``SyphonServerUpdateNotification`` or ``SyphonServerRetireNotification``.
  @returns the shared server instance 
 */
 + (SyphonServerDirectory *)sharedDirectory;
@@ -90,6 +104,21 @@ extern NSString * const SyphonServerRetireNotification;
 */
 @property (readonly) NSArray<NSDictionary<NSString *, id<NSCoding>> *> *servers;
 
+/*!
+ If `YES`, the directory adds ``SyphonServerDescriptionIconKey`` to server descriptions where it can. Icons are found asynchronously, so a server may first appear without an icon and gain one in a subsequent update. Applications which never display icons can set this to `NO` to avoid the cost of finding them. This only affects servers announced or updated after it is changed. Default is `YES`.
+ */
+@property BOOL providesIcons;
+
+/*!
+ A number which increases every time the contents of ``servers`` change. If you keep a copy of ``servers``, you can compare this with the value you saw when you took it to cheaply discover whether it is out of date, without observing the directory. Reading this property and ``servers`` is fast and does not block.
+ */
+@property (readonly) NSUInteger generation;
+
+/*!
+ If greater than zero, the number of seconds for which the directory collects changes to ``servers`` before making them visible. Servers which appear, change or disappear within that time are then reported together: KVO observers of ``servers`` see at most one removal, one replacement and one insertion, rather than a change for every server. ``SyphonServerAnnounceNotification``, ``SyphonServerUpdateNotification`` and ``SyphonServerRetireNotification`` are still posted for each server, once the change is visible. Setting an interval is useful if your application updates its interface in response to changes and many servers may appear at once. Default is 0, in which case every change is visible immediately.
+ */
+@property NSTimeInterval batchInterval;
+
 /*! 
  Use this method to discover servers based soley on their name, or application host name. Both parameters are optional. If you do not specify either, all available Syphon servers will be returned.
  @param name Optional (pass `nil` to not specify) Name of the published Syphon server, matches the key value for ``SyphonServerDescriptionNameKey``
@@ -98,6 +127,44 @@ extern NSString * const SyphonServerRetireNotification;
 */
 - (NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)serversMatchingName:(nullable NSString *)name appName:(nullable NSString *)appname;
 
+/*!
+ Returns a query object which you can keep and use to repeatedly find servers based on their name, or application host name. This is more efficient than repeated calls to ``serversMatchingName:appName:``, as the query's result is reused until the directory's servers change.
+ @param name Optional (pass `nil` to not specify) Name of the published Syphon server, matches the key value for ``SyphonServerDescriptionNameKey``
+ @param appname Optional (pass `nil` to not specify) Application name of the published Syphon server, matches the key value for ``SyphonServerDescriptionAppNameKey``
+ @returns A query for the servers matching the name and application name you specified.
+ */
+- (SyphonServerDirectoryQuery *)queryForServersMatchingName:(nullable NSString *)name appName:(nullable NSString *)appname;
+
+/*!
+ Registers a block to be invoked when the server with the given UUID changes. Unlike observing ``servers``, the block is only invoked for changes to that server, which is more efficient when you are interested in a few servers and many are available.
+
+ The block is invoked with the server's new description when it is announced or updated, and with `nil` when it retires. If the directory already knows the server, the block is also invoked with its current description before this method returns. The block may be invoked on a thread other than that on which it was registered.
+
+ @param uuid The server's ``SyphonServerDescriptionUUIDKey`` value.
+ @param block The block to invoke when the server changes.
+ @returns An opaque object which you must pass to ``removeServerObserver:`` when you no longer want to receive changes.
+ */
+- (id)addObserverForServerUUID:(NSString *)uuid usingBlock:(void (^)(NSDictionary<NSString *, id<NSCoding>> * _Nullable description))block;
+
+/*!
+ Stops the block registered with ``addObserverForServerUUID:usingBlock:`` from being invoked.
+
+ @param observer The object returned when the block was registered.
+ */
+- (void)removeServerObserver:(id)observer;
+
+@end
+
+/*!
+ A query finds servers in a ``SyphonServerDirectory`` matching a name and application name. Create a query using ``SyphonServerDirectory/queryForServersMatchingName:appName:``. It is safe to use a query from any thread.
+ */
+@interface SyphonServerDirectoryQuery : NSObject
+
+/*!
+ An array of dictionaries describing the servers which currently match the query. Accessing this property is fast if the directory's servers haven't changed since it was last accessed.
+ */
+@property (readonly) NSArray<NSDictionary<NSString *, id<NSCoding>> *> *servers;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -29,35 +29,182 @@
 
 #import "SyphonServerDirectory.h"
 #import "SyphonPrivate.h"
+#import "SyphonSharedRegistry.h"
 #import <Cocoa/Cocoa.h>
 #import <pthread.h>
+#import <stdatomic.h>
+#import <os/lock.h>
+#import <signal.h>
+#import <errno.h>
 
 #define kSyphonServerDirectoryAnnounceTimeout 6
+#define kSyphonServerDirectoryRequestInterval 2
 
 NSString * const SyphonServerAnnounceNotification = @"SyphonServerAnnounceNotification";
 NSString * const SyphonServerUpdateNotification = @"SyphonServerUpdateNotification";
 NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotification";
 
-@interface NSDictionary (SyphonServerDirectoryPimpMyDictionary)
-- (NSDictionary *)pimpedVersionForSyphon;
+@interface SyphonServerDirectory (Private)
+- (id)initOnce;
+- (void)requestServerAnnounce;
+- (void)requestAnnounceFromServer:(NSString *)uuid;
 @end
 
-@interface NSArray (SyphonServerDirectoryServerSearch)
-- (NSUInteger)indexOfDescriptionForSyphonServerUUID:(NSString *)uuid;
+@interface SyphonServerDirectorySubscription : NSObject
+@property (readonly) NSString *uuid;
+@property (readonly) void (^handler)(NSDictionary *);
 @end
 
-@interface SyphonServerDirectory (Private)
-- (id)initOnce;
-- (void)requestServerAnnounce;
+@implementation SyphonServerDirectorySubscription
+- (instancetype)initWithServerUUID:(NSString *)uuid handler:(void (^)(NSDictionary *))handler
+{
+	self = [super init];
+	if (self)
+	{
+		_uuid = [uuid copy];
+		_handler = [handler copy];
+	}
+	return self;
+}
+@end
+
+// A change to be announced to subscribers and by NSNotification once it is visible in the snapshot
+@interface SyphonServerDirectoryChange : NSObject
+@property (readonly) NSString *name;
+@property (readonly) NSDictionary *serverDescription;
+@end
+
+@implementation SyphonServerDirectoryChange
+- (instancetype)initWithNotificationName:(NSString *)name serverDescription:(NSDictionary *)description
+{
+	self = [super init];
+	if (self)
+	{
+		_name = name;
+		_serverDescription = description;
+	}
+	return self;
+}
+@end
+
+/*
+ An immutable copy of the directory's servers with indexes by name and app name. A new snapshot is made
+ whenever the servers change, so readers need neither lock nor copy it.
+ */
+@interface SyphonServerDirectorySnapshot : NSObject
+- (instancetype)initWithServers:(NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)servers generation:(NSUInteger)generation;
+@property (readonly) NSArray<NSDictionary<NSString *, id<NSCoding>> *> *servers;
+@property (readonly) NSUInteger generation;
+- (NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)serversMatchingName:(NSString *)name appName:(NSString *)appname;
+@end
+
+@implementation SyphonServerDirectorySnapshot
+{
+	NSDictionary<NSString *, NSArray *> *_byName;
+	NSDictionary<NSString *, NSArray *> *_byAppName;
+}
+
+static NSDictionary<NSString *, NSArray *> *SyphonServerDirectoryIndex(NSArray<NSDictionary *> *servers, NSString *key)
+{
+	NSMutableDictionary<NSString *, NSMutableArray *> *index = [NSMutableDictionary dictionaryWithCapacity:[servers count]];
+	for (NSDictionary *description in servers) {
+		NSString *value = [description objectForKey:key];
+		if ([value isKindOfClass:[NSString class]])
+		{
+			NSMutableArray *matches = [index objectForKey:value];
+			if (matches == nil)
+			{
+				matches = [NSMutableArray arrayWithCapacity:1];
+				[index setObject:matches forKey:value];
+			}
+			[matches addObject:description];
+		}
+	}
+	return index;
+}
+
+- (instancetype)initWithServers:(NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)servers generation:(NSUInteger)generation
+{
+	self = [super init];
+	if (self)
+	{
+		_servers = [servers copy];
+		_generation = generation;
+		_byName = SyphonServerDirectoryIndex(_servers, SyphonServerDescriptionNameKey);
+		_byAppName = SyphonServerDirectoryIndex(_servers, SyphonServerDescriptionAppNameKey);
+	}
+	return self;
+}
+
+- (NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)serversMatchingName:(NSString *)name appName:(NSString *)appname
+{
+	if ([name length] == 0)
+	{
+		name = nil;
+	}
+	if ([appname length] == 0)
+	{
+		appname = nil;
+	}
+	if (name == nil && appname == nil)
+	{
+		return _servers;
+	}
+	NSArray *byName = name ? [_byName objectForKey:name] : nil;
+	NSArray *byAppName = appname ? [_byAppName objectForKey:appname] : nil;
+	if (name && appname)
+	{
+		if (byName == nil || byAppName == nil)
+		{
+			return [NSArray array];
+		}
+		// Filter the shorter list by the other key
+		BOOL filterByName = [byName count] <= [byAppName count];
+		NSArray *candidates = filterByName ? byName : byAppName;
+		NSString *key = filterByName ? SyphonServerDescriptionAppNameKey : SyphonServerDescriptionNameKey;
+		NSString *value = filterByName ? appname : name;
+		NSIndexSet *indexes = [candidates indexesOfObjectsPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop) {
+			return [[obj objectForKey:key] isEqualToString:value];
+		}];
+		return [candidates objectsAtIndexes:indexes];
+	}
+	NSArray *result = name ? byName : byAppName;
+	return result ? result : [NSArray array];
+}
+@end
+
+@interface SyphonServerDirectory ()
+@property (atomic, strong) SyphonServerDirectorySnapshot *snapshot;
+@end
+
+@interface SyphonServerDirectoryQuery ()
+- (instancetype)initWithDirectory:(SyphonServerDirectory *)directory name:(NSString *)name appName:(NSString *)appname;
 @end
 
 @implementation SyphonServerDirectory
 {
 @private
     NSMutableArray<NSDictionary<NSString *, id<NSCoding>> *> *_servers;
+    NSMutableDictionary<NSString *, NSNumber *> *_serverIndexes; // UUID to index in _servers
+    NSUInteger _generation; // protected by _generalLock, readers use the snapshot's
+    NSMutableDictionary<NSString *, NSMutableArray<SyphonServerDirectorySubscription *> *> *_subscriptions; // by UUID
+    pthread_mutex_t _iconLock;
+    NSMutableDictionary<NSString *, id> *_icons; // NSImage or NSNull by app name
+    NSMutableSet<NSString *> *_pendingIcons; // app names being looked up
+    dispatch_queue_t _iconQueue;
+    SyphonSafeBool _providesIcons;
     pthread_mutex_t _generalLock;
     pthread_mutex_t _mutateLock;
-    NSMutableSet *_pings;
+    NSMutableDictionary<NSString *, NSNumber *> *_leases; // UUID to time by which a server must announce itself
+    NSMutableDictionary<NSString *, NSNumber *> *_announceRequests; // UUID to time we last asked the server alone to announce itself, protected by _generalLock
+    dispatch_source_t _leaseTimer;
+    NSTimeInterval _batchInterval;
+    BOOL _flushScheduled;
+    NSMutableArray<SyphonServerDirectoryChange *> *_pendingChanges;
+#if SYPHON_DIRECTORY_CACHE
+    dispatch_queue_t _cacheQueue;
+    NSArray *_cacheServers; // the servers to be written to the cache, protected by _generalLock
+#endif
 }
 
 + (BOOL)automaticallyNotifiesObserversForKey:(NSString *)theKey
@@ -75,12 +222,6 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
 }
 
 #pragma mark Singleton Instance
-+ (void)load
-{
-	// cause our instantiation so we always post notifications
-	[SyphonServerDirectory sharedDirectory];
-}
-
 + (SyphonServerDirectory *)sharedDirectory
 {
     static SyphonServerDirectory *sharedDirectory = nil;
@@ -97,15 +238,36 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
     if (self)
 	{
 		if (pthread_mutex_init(&_generalLock, NULL) != 0
-			|| pthread_mutex_init(&_mutateLock, NULL) != 0)
+			|| pthread_mutex_init(&_mutateLock, NULL) != 0
+			|| pthread_mutex_init(&_iconLock, NULL) != 0)
 		{
 			return nil;
 		}
+		_icons = [[NSMutableDictionary alloc] initWithCapacity:4];
+		_pendingIcons = [[NSMutableSet alloc] initWithCapacity:4];
+		_iconQueue = dispatch_queue_create("info.v002.Syphon.ServerDirectory.icons", DISPATCH_QUEUE_SERIAL);
+		SyphonSafeBoolSet(&_providesIcons, YES);
+		NSNotificationCenter *workspaceCenter = [[NSWorkspace sharedWorkspace] notificationCenter];
+		[workspaceCenter addObserver:self selector:@selector(handleApplicationChange:) name:NSWorkspaceDidLaunchApplicationNotification object:nil];
+		[workspaceCenter addObserver:self selector:@selector(handleApplicationChange:) name:NSWorkspaceDidTerminateApplicationNotification object:nil];
 		_servers = [[NSMutableArray alloc] initWithCapacity:4];
+		_serverIndexes = [[NSMutableDictionary alloc] initWithCapacity:4];
+		_subscriptions = [[NSMutableDictionary alloc] initWithCapacity:4];
+		_leases = [[NSMutableDictionary alloc] initWithCapacity:4];
+		_announceRequests = [[NSMutableDictionary alloc] initWithCapacity:4];
+		_pendingChanges = [[NSMutableArray alloc] initWithCapacity:4];
+		self.snapshot = [[SyphonServerDirectorySnapshot alloc] initWithServers:[NSArray array] generation:0];
 		[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleServerAnnounce:) name:SyphonServerAnnounce object:nil];
 		[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleServerRetire:) name:SyphonServerRetire object:nil];
 		[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleServerUpdate:) name:SyphonServerUpdate object:nil];
+		[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleServerChange:) name:SyphonServerChange object:nil];
 		[[NSDistributedNotificationCenter defaultCenter] addObserver:self selector:@selector(handleAccounceRequest:) name:SyphonServerAnnounceRequest object:nil];
+		[self addServersFromRegistry];
+#if SYPHON_DIRECTORY_CACHE
+		_cacheQueue = dispatch_queue_create("info.v002.Syphon.ServerDirectory.cache", DISPATCH_QUEUE_SERIAL);
+		[self addServersFromCache];
+#endif
+		// Servers found in the registry or cache are removed by the usual lease if they don't answer this
 		[self requestServerAnnounce];
     }
     return self;
@@ -117,46 +279,629 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
 	// but maintain it for completeness, and in case we add dealloc on
 	// framework unload or something later
 	[[NSDistributedNotificationCenter defaultCenter] removeObserver:self];
+	[[[NSWorkspace sharedWorkspace] notificationCenter] removeObserver:self];
 	pthread_mutex_destroy(&_generalLock);
 	pthread_mutex_destroy(&_mutateLock);
+	pthread_mutex_destroy(&_iconLock);
+	if (_leaseTimer) dispatch_source_cancel(_leaseTimer);
 }
 
 - (NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)servers
+{
+	return self.snapshot.servers;
+}
+
+- (NSUInteger)generation
+{
+	return self.snapshot.generation;
+}
+
+- (NSTimeInterval)batchInterval
 {
 	pthread_mutex_lock(&_generalLock);
-	NSArray<NSDictionary<NSString *, id<NSCoding>> *> *array = [NSArray arrayWithArray:_servers];
+	NSTimeInterval interval = _batchInterval;
+	pthread_mutex_unlock(&_generalLock);
+	return interval;
+}
+
+- (void)setBatchInterval:(NSTimeInterval)batchInterval
+{
+	pthread_mutex_lock(&_generalLock);
+	_batchInterval = MAX(batchInterval, 0.0);
 	pthread_mutex_unlock(&_generalLock);
-	return array;
 }
 
 - (NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)serversMatchingName:(NSString *)name appName:(NSString *)appname
 {
-	if ([name length] == 0)
+	return [self.snapshot serversMatchingName:name appName:appname];
+}
+
+- (SyphonServerDirectoryQuery *)queryForServersMatchingName:(NSString *)name appName:(NSString *)appname
+{
+	return [[SyphonServerDirectoryQuery alloc] initWithDirectory:self name:name appName:appname];
+}
+
+#pragma mark Icons
+
+- (BOOL)providesIcons
+{
+	return SyphonSafeBoolGet(&_providesIcons);
+}
+
+- (void)setProvidesIcons:(BOOL)providesIcons
+{
+	SyphonSafeBoolSet(&_providesIcons, providesIcons);
+	if (!providesIcons)
 	{
-		name = nil;
+		pthread_mutex_lock(&_iconLock);
+		[_icons removeAllObjects];
+		pthread_mutex_unlock(&_iconLock);
 	}
-	if ([appname length] == 0)
+}
+
+/*
+ Icons are looked up by app name off the notification thread and cached until that app launches or quits.
+ A description is returned without an icon while its icon is looked up, and updated once it is found.
+ */
+
+- (NSDictionary *)descriptionWithIcon:(NSDictionary *)description
+{
+	NSString *appName = [description objectForKey:SyphonServerDescriptionAppNameKey];
+	if (!self.providesIcons || appName == nil || [description objectForKey:SyphonServerDescriptionIconKey] != nil)
 	{
-		appname = nil;
+		return description;
+	}
+	pthread_mutex_lock(&_iconLock);
+	id icon = [_icons objectForKey:appName];
+	BOOL shouldLookUp = icon == nil && ![_pendingIcons containsObject:appName];
+	if (shouldLookUp)
+	{
+		[_pendingIcons addObject:appName];
+	}
+	pthread_mutex_unlock(&_iconLock);
+	if (shouldLookUp)
+	{
+		NSNumber *pid = [description objectForKey:SyphonServerDescriptionProcessIdentifierKey];
+		dispatch_async(_iconQueue, ^{
+			[self lookUpIconForAppName:appName processIdentifier:pid];
+		});
 	}
+	if ([icon isKindOfClass:[NSImage class]])
+	{
+		NSMutableDictionary *newDictionary = [NSMutableDictionary dictionaryWithDictionary:description];
+		[newDictionary setObject:icon forKey:SyphonServerDescriptionIconKey];
+		return newDictionary;
+	}
+	return description;
+}
+
+- (void)lookUpIconForAppName:(NSString *)appName processIdentifier:(NSNumber *)pid
+{
+	NSRunningApplication *app = nil;
+	// Servers include their process identifier, which saves searching every running application
+	if ([pid isKindOfClass:[NSNumber class]])
+	{
+		app = [NSRunningApplication runningApplicationWithProcessIdentifier:[pid intValue]];
+	}
+	if (app == nil)
+	{
+		for (NSRunningApplication *candidate in [[NSWorkspace sharedWorkspace] runningApplications])
+		{
+			if ([appName isEqualToString:[candidate localizedName]])
+			{
+				app = candidate;
+			}
+		}
+	}
+	NSImage *icon = [app icon];
+	pthread_mutex_lock(&_iconLock);
+	[_pendingIcons removeObject:appName];
+	if (SyphonSafeBoolGet(&_providesIcons))
+	{
+		[_icons setObject:icon ? icon : [NSNull null] forKey:appName];
+	}
+	pthread_mutex_unlock(&_iconLock);
+	if (icon)
+	{
+		// Update any servers which were added while we were looking. Those added within the current batch window
+		// aren't in the published snapshot yet, so look in our own list, and hold the mutate lock so none change
+		pthread_mutex_lock(&_mutateLock);
+		pthread_mutex_lock(&_generalLock);
+		NSMutableArray<NSDictionary *> *lacking = [NSMutableArray arrayWithCapacity:1];
+		for (NSDictionary *description in _servers)
+		{
+			if ([appName isEqualToString:[description objectForKey:SyphonServerDescriptionAppNameKey]]
+				&& [description objectForKey:SyphonServerDescriptionIconKey] == nil)
+			{
+				[lacking addObject:description];
+			}
+		}
+		pthread_mutex_unlock(&_generalLock);
+		for (NSDictionary *description in lacking)
+		{
+			[self updateServerHavingMutateLock:[self descriptionWithIcon:description]];
+		}
+		pthread_mutex_unlock(&_mutateLock);
+	}
+}
+
+- (void)handleApplicationChange:(NSNotification *)aNotification
+{
+	NSString *appName = [[[aNotification userInfo] objectForKey:NSWorkspaceApplicationKey] localizedName];
+	if (appName)
+	{
+		pthread_mutex_lock(&_iconLock);
+		[_icons removeObjectForKey:appName];
+		pthread_mutex_unlock(&_iconLock);
+	}
+}
+
+#pragma mark Subscriptions
+
+- (id)addObserverForServerUUID:(NSString *)uuid usingBlock:(void (^)(NSDictionary<NSString *, id<NSCoding>> *description))block
+{
+	SyphonServerDirectorySubscription *subscription = [[SyphonServerDirectorySubscription alloc] initWithServerUUID:uuid handler:block];
 	pthread_mutex_lock(&_generalLock);
-	NSIndexSet *indexes = [_servers indexesOfObjectsPassingTest:^(id obj, NSUInteger idx, BOOL *stop) {
-		if ((name == nil || [[obj objectForKey:SyphonServerDescriptionNameKey] isEqualToString:name])
-			&& (appname == nil || [[obj objectForKey:SyphonServerDescriptionAppNameKey] isEqualToString:appname]))
+	NSMutableArray *subscriptions = [_subscriptions objectForKey:uuid];
+	if (subscriptions == nil)
+	{
+		subscriptions = [[NSMutableArray alloc] initWithCapacity:1];
+		[_subscriptions setObject:subscriptions forKey:uuid];
+	}
+	[subscriptions addObject:subscription];
+	NSUInteger index = [self indexOfServerHavingLock:uuid];
+	NSDictionary *current = index == NSNotFound ? nil : [_servers objectAtIndex:index];
+	pthread_mutex_unlock(&_generalLock);
+	if (current)
+	{
+		block(current);
+	}
+	return subscription;
+}
+
+- (void)removeServerObserver:(id)observer
+{
+	NSString *uuid = [(SyphonServerDirectorySubscription *)observer uuid];
+	pthread_mutex_lock(&_generalLock);
+	NSMutableArray *subscriptions = [_subscriptions objectForKey:uuid];
+	[subscriptions removeObjectIdenticalTo:observer];
+	if ([subscriptions count] == 0)
+	{
+		[_subscriptions removeObjectForKey:uuid];
+	}
+	pthread_mutex_unlock(&_generalLock);
+}
+
+- (void)notifySubscribersForServerUUID:(NSString *)uuid description:(NSDictionary *)description
+{
+	if (uuid == nil) return;
+	// Take a copy so we don't hold the lock while calling out
+	pthread_mutex_lock(&_generalLock);
+	NSArray<SyphonServerDirectorySubscription *> *subscriptions = [[_subscriptions objectForKey:uuid] copy];
+	pthread_mutex_unlock(&_generalLock);
+	for (SyphonServerDirectorySubscription *subscription in subscriptions) {
+		subscription.handler(description);
+	}
+}
+
+#pragma mark Server List
+
+/*
+ These must be called with _generalLock held. Having made changes to _servers, record each change with
+ -addChangeHavingLock:description: then, having released _generalLock but still holding _mutateLock, call
+ -commitChangesHavingMutateLock to make them visible to readers.
+ */
+
+- (NSUInteger)indexOfServerHavingLock:(NSString *)uuid
+{
+	// UUID is the only sure identity, as other members of a dictionary may change, unhelpfully yeilding a NO for isEqual
+	NSNumber *index = uuid ? [_serverIndexes objectForKey:uuid] : nil;
+	return index ? [index unsignedIntegerValue] : NSNotFound;
+}
+
+static unsigned long long SyphonServerDirectoryRevision(NSDictionary *description)
+{
+	NSNumber *revision = [description objectForKey:SyphonServerDescriptionRevisionKey];
+	return [revision isKindOfClass:[NSNumber class]] ? [revision unsignedLongLongValue] : 0;
+}
+
+// Returns YES if description is newer than the one we have at index, which is always the case for servers without revisions
+- (BOOL)isNewerThanServerHavingLock:(NSDictionary *)description atIndex:(NSUInteger)index
+{
+	if ([description objectForKey:SyphonServerDescriptionRevisionKey] == nil)
+	{
+		return YES;
+	}
+	return SyphonServerDirectoryRevision(description) > SyphonServerDirectoryRevision([_servers objectAtIndex:index]);
+}
+
+- (void)reindexServersHavingLockFromIndex:(NSUInteger)first
+{
+	NSUInteger count = [_servers count];
+	for (NSUInteger i = first; i < count; i++)
+	{
+		NSString *uuid = [[_servers objectAtIndex:i] objectForKey:SyphonServerDescriptionUUIDKey];
+		if (uuid) [_serverIndexes setObject:[NSNumber numberWithUnsignedInteger:i] forKey:uuid];
+	}
+}
+
+- (void)addServerHavingLock:(NSDictionary *)description
+{
+	[_servers addObject:description];
+	[self reindexServersHavingLockFromIndex:[_servers count] - 1];
+}
+
+- (void)removeServersHavingLockAtIndexes:(NSIndexSet *)indexes
+{
+	for (NSDictionary *description in [_servers objectsAtIndexes:indexes]) {
+		NSString *uuid = [description objectForKey:SyphonServerDescriptionUUIDKey];
+		if (uuid)
 		{
-			return YES;
-		} else {
-			return NO;
+			[_serverIndexes removeObjectForKey:uuid];
+			[_leases removeObjectForKey:uuid];
+			[_announceRequests removeObjectForKey:uuid];
 		}
-	}];
-	NSArray<NSDictionary<NSString *, id<NSCoding>> *> *array = [_servers objectsAtIndexes:indexes];
+	}
+	[_servers removeObjectsAtIndexes:indexes];
+	[self reindexServersHavingLockFromIndex:[indexes firstIndex]];
+}
+
+- (void)addChangeHavingLock:(NSString *)notificationName description:(NSDictionary *)description
+{
+	[_pendingChanges addObject:[[SyphonServerDirectoryChange alloc] initWithNotificationName:notificationName serverDescription:description]];
+}
+
+- (void)publishServersHavingLock:(NSArray *)servers
+{
+	_generation++;
+	self.snapshot = [[SyphonServerDirectorySnapshot alloc] initWithServers:servers generation:_generation];
+}
+
+#pragma mark Change Batching
+
+/*
+ Changes to _servers are only visible to readers and observers once they are committed. Without a batch interval
+ that happens immediately, otherwise every change made within the interval is committed together.
+ */
+
+- (void)commitChangesHavingMutateLock
+{
+	pthread_mutex_lock(&_generalLock);
+	NSTimeInterval interval = _batchInterval;
+	BOOL schedule = interval > 0.0 && !_flushScheduled;
+	if (schedule) _flushScheduled = YES;
 	pthread_mutex_unlock(&_generalLock);
-	return array;
+	if (interval <= 0.0)
+	{
+		[self flushChangesHavingMutateLock];
+	}
+	else if (schedule)
+	{
+		__weak SyphonServerDirectory *weakSelf = self;
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+			[weakSelf flushChanges];
+		});
+	}
+}
+
+- (void)flushChanges
+{
+	pthread_mutex_lock(&_mutateLock);
+	[self flushChangesHavingMutateLock];
+	pthread_mutex_unlock(&_mutateLock);
+}
+
+- (void)changeServers:(NSArray *)servers withKind:(NSKeyValueChange)kind atIndexes:(NSIndexSet *)indexes
+{
+	[self willChange:kind valuesAtIndexes:indexes forKey:@"servers"];
+	// lock for access
+	pthread_mutex_lock(&_generalLock);
+	[self publishServersHavingLock:servers];
+	// unlock for access so others can access in response to didChange
+	pthread_mutex_unlock(&_generalLock);
+	[self didChange:kind valuesAtIndexes:indexes forKey:@"servers"];
+}
+
+- (void)flushChangesHavingMutateLock
+{
+	NSArray *previous = self.snapshot.servers;
+	pthread_mutex_lock(&_generalLock);
+	NSArray *current = [_servers copy];
+	NSArray<SyphonServerDirectoryChange *> *changes = [_pendingChanges copy];
+	[_pendingChanges removeAllObjects];
+	_flushScheduled = NO;
+	pthread_mutex_unlock(&_generalLock);
+
+	/*
+	 Servers are only ever removed from _servers, replaced in place, or added at the end, so the change from the
+	 previous snapshot can always be expressed as at most one removal, then one replacement, then one insertion.
+	 
+	 The longest run at the start of current whose servers appear in previous in the same order was kept, everything
+	 else in previous was removed, and everything after the run was inserted. A server removed and added again
+	 within a batch is reported as both.
+	 */
+	NSMutableDictionary<NSString *, NSNumber *> *previousIndexes = [NSMutableDictionary dictionaryWithCapacity:[previous count]];
+	[previous enumerateObjectsUsingBlock:^(NSDictionary *description, NSUInteger idx, BOOL *stop) {
+		NSString *uuid = [description objectForKey:SyphonServerDescriptionUUIDKey];
+		if (uuid) [previousIndexes setObject:[NSNumber numberWithUnsignedInteger:idx] forKey:uuid];
+	}];
+	NSMutableIndexSet *kept = [NSMutableIndexSet indexSet];
+	for (NSDictionary *description in current)
+	{
+		NSString *uuid = [description objectForKey:SyphonServerDescriptionUUIDKey];
+		NSNumber *previousIndex = uuid ? [previousIndexes objectForKey:uuid] : nil;
+		if (previousIndex == nil || ([kept count] > 0 && [previousIndex unsignedIntegerValue] <= [kept lastIndex]))
+		{
+			break;
+		}
+		[kept addIndex:[previousIndex unsignedIntegerValue]];
+	}
+	NSUInteger keptCount = [kept count];
+	NSMutableIndexSet *removed = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, [previous count])];
+	[removed removeIndexes:kept];
+	NSArray *remaining = [previous objectsAtIndexes:kept];
+	NSMutableIndexSet *replaced = [NSMutableIndexSet indexSet];
+	for (NSUInteger i = 0; i < keptCount; i++)
+	{
+		if ([current objectAtIndex:i] != [remaining objectAtIndex:i])
+		{
+			[replaced addIndex:i];
+		}
+	}
+	NSIndexSet *inserted = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(keptCount, [current count] - keptCount)];
+
+	if ([removed count] > 0)
+	{
+		[self changeServers:remaining withKind:NSKeyValueChangeRemoval atIndexes:removed];
+	}
+	if ([replaced count] > 0)
+	{
+		[self changeServers:[current subarrayWithRange:NSMakeRange(0, keptCount)] withKind:NSKeyValueChangeReplacement atIndexes:replaced];
+	}
+	if ([inserted count] > 0)
+	{
+		[self changeServers:current withKind:NSKeyValueChangeInsertion atIndexes:inserted];
+	}
+
+#if SYPHON_DIRECTORY_CACHE
+	if ([changes count] > 0)
+	{
+		[self scheduleCacheWrite:current];
+	}
+#endif
+
+	for (SyphonServerDirectoryChange *change in changes)
+	{
+		NSDictionary *description = change.serverDescription;
+		BOOL retired = [change.name isEqualToString:SyphonServerRetireNotification];
+		[self notifySubscribersForServerUUID:[description objectForKey:SyphonServerDescriptionUUIDKey] description:retired ? nil : description];
+		[[NSNotificationCenter defaultCenter] postNotificationName:change.name object:self userInfo:description];
+	}
 }
 
 - (void)requestServerAnnounce
 {
-	[[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerAnnounceRequest object:nil userInfo:nil deliverImmediately:YES];
+	// Every server answers every request, so don't ask more often than we need to
+	static _Atomic uint64_t lastRequest = 0;
+	uint64_t now = SyphonFrameTimestampNow();
+	uint64_t last = atomic_load(&lastRequest);
+	if ((last == 0 || now - last >= NSEC_PER_SEC * kSyphonServerDirectoryRequestInterval)
+		&& atomic_compare_exchange_strong(&lastRequest, &last, now))
+	{
+		// Servers post complete updates as well as changes only while they see requests without this
+		[[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerAnnounceRequest
+																	   object:nil
+																	 userInfo:@{SyphonServerAnnounceRequestAppliesChangesKey: @YES}
+														   deliverImmediately:YES];
+	}
+}
+
+- (void)requestAnnounceFromServer:(NSString *)uuid
+{
+	// Only the server is asked, so other servers' leases are unaffected, but still not too often
+	uint64_t now = SyphonFrameTimestampNow();
+	pthread_mutex_lock(&_generalLock);
+	NSNumber *last = [_announceRequests objectForKey:uuid];
+	BOOL shouldRequest = last == nil || now - [last unsignedLongLongValue] >= NSEC_PER_SEC * kSyphonServerDirectoryRequestInterval;
+	if (shouldRequest)
+	{
+		[_announceRequests setObject:[NSNumber numberWithUnsignedLongLong:now] forKey:uuid];
+	}
+	pthread_mutex_unlock(&_generalLock);
+	if (shouldRequest)
+	{
+		[[NSDistributedNotificationCenter defaultCenter] postNotificationName:SyphonServerAnnounceRequestForServer
+																	   object:uuid
+																	 userInfo:nil
+														   deliverImmediately:YES];
+	}
+}
+
+#pragma mark Registry
+
+static void SyphonServerDirectoryCollectRecord(const void *data, uint32_t length, void *context)
+{
+	NSMutableArray *records = (__bridge NSMutableArray *)context;
+	[records addObject:[NSData dataWithBytes:data length:length]];
+}
+
+- (void)addServersFromRegistry
+{
+	SyphonRegistryRef registry = SyphonSharedRegistryGet();
+	if (registry)
+	{
+		NSMutableArray<NSData *> *records = [NSMutableArray arrayWithCapacity:4];
+		SyphonRegistryVisit(registry, SyphonServerDirectoryCollectRecord, (__bridge void *)records);
+		for (NSData *record in records) {
+			NSDictionary *description = [NSPropertyListSerialization propertyListWithData:record options:NSPropertyListImmutable format:NULL error:nil];
+			if ([description isKindOfClass:[NSDictionary class]]
+				&& [[description objectForKey:SyphonServerDescriptionUUIDKey] isKindOfClass:[NSString class]])
+			{
+				[self addServer:description];
+			}
+		}
+	}
+}
+
+#pragma mark Cache
+
+#if SYPHON_DIRECTORY_CACHE
+
+/*
+ The servers we last knew about are kept in our caches directory, so a directory created at launch can be populated
+ before servers have answered our announce request. Each cached server is checked to still be running before it is added.
+ */
+
+static NSURL *SyphonServerDirectoryCacheURL(void)
+{
+	NSURL *caches = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+	return [[caches URLByAppendingPathComponent:kSyphonIdentifier isDirectory:YES] URLByAppendingPathComponent:@"ServerDirectory.plist" isDirectory:NO];
+}
+
+static BOOL SyphonServerDirectoryServerIsRunning(NSDictionary *description)
+{
+	NSNumber *pid = [description objectForKey:SyphonServerDescriptionProcessIdentifierKey];
+	if ([pid isKindOfClass:[NSNumber class]] && kill([pid intValue], 0) != 0 && errno == ESRCH)
+	{
+		return NO;
+	}
+	// The server's message port only exists while it is running
+	CFMessagePortRef port = CFMessagePortCreateRemote(kCFAllocatorDefault, (__bridge CFStringRef)[description objectForKey:SyphonServerDescriptionUUIDKey]);
+	if (port)
+	{
+		CFMessagePortInvalidate(port);
+		CFRelease(port);
+		return YES;
+	}
+	return NO;
+}
+
+- (void)addServersFromCache
+{
+	NSData *data = [NSData dataWithContentsOfURL:SyphonServerDirectoryCacheURL()];
+	NSArray *cached = data ? [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil] : nil;
+	if ([cached isKindOfClass:[NSArray class]])
+	{
+		for (NSDictionary *description in cached) {
+			if ([description isKindOfClass:[NSDictionary class]]
+				&& [[description objectForKey:SyphonServerDescriptionUUIDKey] isKindOfClass:[NSString class]]
+				&& SyphonServerDirectoryServerIsRunning(description))
+			{
+				[self addServer:description];
+			}
+		}
+	}
+}
+
+- (void)scheduleCacheWrite:(NSArray *)servers
+{
+	// Writes are coalesced: only the most recent servers are written, at most once a second
+	pthread_mutex_lock(&_generalLock);
+	BOOL schedule = _cacheServers == nil;
+	_cacheServers = servers;
+	pthread_mutex_unlock(&_generalLock);
+	if (schedule)
+	{
+		__weak SyphonServerDirectory *weakSelf = self;
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC), _cacheQueue, ^{
+			[weakSelf writeCache];
+		});
+	}
+}
+
+- (void)writeCache
+{
+	pthread_mutex_lock(&_generalLock);
+	NSArray *servers = _cacheServers;
+	_cacheServers = nil;
+	pthread_mutex_unlock(&_generalLock);
+	NSMutableArray *cached = [NSMutableArray arrayWithCapacity:[servers count]];
+	for (NSDictionary *description in servers) {
+		// Icons aren't property-list types, and are cheap to find again
+		if ([description objectForKey:SyphonServerDescriptionIconKey])
+		{
+			NSMutableDictionary *stripped = [description mutableCopy];
+			[stripped removeObjectForKey:SyphonServerDescriptionIconKey];
+			description = stripped;
+		}
+		[cached addObject:description];
+	}
+	NSData *data = [NSPropertyListSerialization dataWithPropertyList:cached format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+	if (data)
+	{
+		NSURL *url = SyphonServerDirectoryCacheURL();
+		[[NSFileManager defaultManager] createDirectoryAtURL:[url URLByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+		if (![data writeToURL:url atomically:YES])
+		{
+			SYPHONLOG(@"Failed to write server directory cache.");
+		}
+	}
+}
+
+#endif
+
+#pragma mark Leases
+
+/*
+ When any process requests servers announce themselves, each server we know about is given a lease which expires if it
+ doesn't announce within the timeout. One timer fires at the earliest expiry and removes servers whose leases have expired.
+ */
+
+- (void)scheduleLeaseTimerHavingLock
+{
+	uint64_t earliest = UINT64_MAX;
+	for (NSNumber *expiry in [_leases objectEnumerator]) {
+		earliest = MIN(earliest, [expiry unsignedLongLongValue]);
+	}
+	if (earliest == UINT64_MAX)
+	{
+		if (_leaseTimer) dispatch_source_set_timer(_leaseTimer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+		return;
+	}
+	if (_leaseTimer == NULL)
+	{
+		_leaseTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0));
+		__weak SyphonServerDirectory *weakSelf = self;
+		dispatch_source_set_event_handler(_leaseTimer, ^{
+			[weakSelf expireLeases];
+		});
+		dispatch_resume(_leaseTimer);
+	}
+	uint64_t now = SyphonFrameTimestampNow();
+	int64_t delta = earliest > now ? (int64_t)(earliest - now) : 0;
+	dispatch_source_set_timer(_leaseTimer, dispatch_time(DISPATCH_TIME_NOW, delta), DISPATCH_TIME_FOREVER, NSEC_PER_SEC / 10);
+}
+
+- (void)expireLeases
+{
+	// Lock so nobody mutates for the duration
+	pthread_mutex_lock(&_mutateLock);
+	// Lock for access
+	pthread_mutex_lock(&_generalLock);
+	uint64_t now = SyphonFrameTimestampNow();
+	// Get the servers we know about which haven't responded to an announce request in time
+	NSIndexSet *indices = [_servers indexesOfObjectsPassingTest:^(id obj, NSUInteger idx, BOOL *stop) {
+		NSString *uuid = [obj objectForKey:SyphonServerDescriptionUUIDKey];
+		NSNumber *expiry = uuid ? [self->_leases objectForKey:uuid] : nil;
+		return (BOOL)(expiry && [expiry unsignedLongLongValue] <= now);
+	}];
+	if ([indices count] > 0)
+	{
+		SYPHONLOG(@"Removing servers which didn't respond to an announce request.");
+		for (NSDictionary *description in [_servers objectsAtIndexes:indices]) {
+			[self addChangeHavingLock:SyphonServerRetireNotification description:description];
+		}
+		// Make the removal, which also removes their leases
+		[self removeServersHavingLockAtIndexes:indices];
+	}
+	[self scheduleLeaseTimerHavingLock];
+	// Unlock for access so others can access in response to the change
+	pthread_mutex_unlock(&_generalLock);
+	if ([indices count] > 0)
+	{
+		[self commitChangesHavingMutateLock];
+	}
+	pthread_mutex_unlock(&_mutateLock);
 }
 
 #pragma mark Notification Handling
@@ -167,59 +912,24 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
 	 We watch for a global announce request to check the servers we know about are still alive.
 	 This could have come from any application.
 	 
-	 When we get this notification we dispatch a block to be invoked at timeout, and then check that all the
-	 servers we know about responded. If they didn't we remove them from our array and post retirement notifications for them.
+	 When we get this notification every server we know about which doesn't already hold a lease is given one.
+	 Servers which don't announce before their lease expires are removed and we post retirement notifications for them.
 	 */
 	
 	pthread_mutex_lock(&_generalLock);
-	// If _pings != nil then we're already in the process of doing this, do nothing
-	if (_pings == nil)
-	{
-		_pings = [[NSMutableSet alloc] initWithCapacity:[_servers count]];
-		dispatch_time_t when = dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC * kSyphonServerDirectoryAnnounceTimeout);
-		dispatch_after(when, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
-			// Lock so nobody mutates for the duration
-            pthread_mutex_lock(&self->_mutateLock);
-			// Lock for access
-            pthread_mutex_lock(&self->_generalLock);
-			// Get the servers we know about which haven't responded to our announce request
-            NSIndexSet *indices = [self->_servers indexesOfObjectsPassingTest:^(id obj, NSUInteger idx, BOOL *stop) {
-                if ([self->_pings containsObject:[obj objectForKey:SyphonServerDescriptionUUIDKey]])
-				{
-					return NO;
-				}
-				else
-				{
-					return YES;
-				}
-
-			}];
-			// Unlock for access as we're either finished or about to post a change, in which case others need access
-            pthread_mutex_unlock(&self->_generalLock);
-			NSArray *retired = nil;
-			if ([indices count] > 0)
-			{
-				SYPHONLOG(@"Removing servers which didn't respond to an announce request.");
-				[self willChange:NSKeyValueChangeRemoval valuesAtIndexes:indices forKey:@"servers"];
-				// Lock for access
-                pthread_mutex_lock(&self->_generalLock);
-				// Save server descriptions for the notifications we will post
-                retired = [self->_servers objectsAtIndexes:indices];
-				// Make the removal
-                [self->_servers removeObjectsAtIndexes:indices];
-				// Unlock for access so others can access in response to didChange
-                pthread_mutex_unlock(&self->_generalLock);
-				[self didChange:NSKeyValueChangeRemoval valuesAtIndexes:indices forKey:@"servers"];
-			}
-            pthread_mutex_lock(&self->_generalLock);
-			// Reset _pings so we will handle the next announce request
-            self->_pings = nil;
-            pthread_mutex_unlock(&self->_generalLock);
-            pthread_mutex_unlock(&self->_mutateLock);
-			for (NSDictionary *description in retired) {
-				[[NSNotificationCenter defaultCenter] postNotificationName:SyphonServerRetireNotification object:self userInfo:description];
-			}
-		});		
+	NSNumber *expiry = [NSNumber numberWithUnsignedLongLong:SyphonFrameTimestampNow() + NSEC_PER_SEC * kSyphonServerDirectoryAnnounceTimeout];
+	BOOL added = NO;
+	for (NSDictionary *description in _servers) {
+		NSString *uuid = [description objectForKey:SyphonServerDescriptionUUIDKey];
+		if (uuid && [_leases objectForKey:uuid] == nil)
+		{
+			[_leases setObject:expiry forKey:uuid];
+			added = YES;
+		}
+	}
+	if (added)
+	{
+		[self scheduleLeaseTimerHavingLock];
 	}
 	pthread_mutex_unlock(&_generalLock);
 }
@@ -229,30 +939,39 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
 	
 //	SYPHONLOG(@"new server description: %@", serverInfo);
 	
-	NSDictionary* serverInfo = [[aNotification userInfo] pimpedVersionForSyphon];
+	[self addServer:[aNotification userInfo]];
+}
+
+- (void)addServer:(NSDictionary *)description
+{
+	NSDictionary* serverInfo = [self descriptionWithIcon:description];
 	NSString *uuid = [serverInfo objectForKey:SyphonServerDescriptionUUIDKey];
 	// Lock so nobody mutates for the duration
 	pthread_mutex_lock(&_mutateLock);
 	// Lock for access
 	pthread_mutex_lock(&_generalLock);
-	NSUInteger index = [_servers indexOfDescriptionForSyphonServerUUID:uuid];
-	NSUInteger count = [_servers count];
-	// Add the UUID to _pings so we know the server is alive
-	if (uuid) [_pings addObject:uuid];
-	// Unlock for access, so others can access in response to the willChange
-	pthread_mutex_unlock(&_generalLock);
+	NSUInteger index = [self indexOfServerHavingLock:uuid];
+	// The server is alive, so release it from any lease
+	if (uuid) [_leases removeObjectForKey:uuid];
+	BOOL changed = NO;
 	if (index == NSNotFound)
 	{
-		NSIndexSet *indexSet = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(count, 1)];
-		[self willChange:NSKeyValueChangeInsertion valuesAtIndexes:indexSet forKey:@"servers"];
-		// lock for access
-		pthread_mutex_lock(&_generalLock);
-		[_servers addObject:serverInfo];
-		// unlock for access so others can access in response to the didChange
-		pthread_mutex_unlock(&_generalLock);
-		[self didChange:NSKeyValueChangeInsertion valuesAtIndexes:indexSet forKey:@"servers"];
-		
-		[[NSNotificationCenter defaultCenter] postNotificationName:SyphonServerAnnounceNotification object:self userInfo:serverInfo];
+		[self addServerHavingLock:serverInfo];
+		[self addChangeHavingLock:SyphonServerAnnounceNotification description:serverInfo];
+		changed = YES;
+	}
+	else if ([serverInfo objectForKey:SyphonServerDescriptionRevisionKey] && [self isNewerThanServerHavingLock:serverInfo atIndex:index])
+	{
+		// We missed a change, which the complete description replaces
+		[_servers replaceObjectAtIndex:index withObject:serverInfo];
+		[self addChangeHavingLock:SyphonServerUpdateNotification description:serverInfo];
+		changed = YES;
+	}
+	// Unlock for access, so others can access in response to the change
+	pthread_mutex_unlock(&_generalLock);
+	if (changed)
+	{
+		[self commitChangesHavingMutateLock];
 	}
 	// unlock mutate lock
 	pthread_mutex_unlock(&_mutateLock);
@@ -262,27 +981,24 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
 {
 //	SYPHONLOG(@"retire server description: %@", serverInfo);
 	
-	NSDictionary* serverInfo = [[aNotification userInfo] pimpedVersionForSyphon];
+	NSDictionary* serverInfo = [aNotification userInfo];
 	NSString *uuid = [serverInfo objectForKey:SyphonServerDescriptionUUIDKey];
 	// Lock so nobody mutates for the duration
 	pthread_mutex_lock(&_mutateLock);
 	// lock for access
 	pthread_mutex_lock(&_generalLock);
-	NSUInteger index = [_servers indexOfDescriptionForSyphonServerUUID:uuid];
-	// unlock for access so others can access in response to willChange
+	NSUInteger index = [self indexOfServerHavingLock:uuid];
+	if (index != NSNotFound)
+	{
+		// Use our stored description, which may have an icon, for the notification
+		[self addChangeHavingLock:SyphonServerRetireNotification description:[_servers objectAtIndex:index]];
+		[self removeServersHavingLockAtIndexes:[NSIndexSet indexSetWithIndex:index]];
+	}
+	// unlock for access so others can access in response to the change
 	pthread_mutex_unlock(&_generalLock);
-	if(index != NSNotFound)
+	if (index != NSNotFound)
 	{
-		NSIndexSet *indexSet = [NSIndexSet indexSetWithIndex:index];
-		[self willChange:NSKeyValueChangeRemoval valuesAtIndexes:indexSet forKey:@"servers"];
-		// lock for access
-		pthread_mutex_lock(&_generalLock);
-		[_servers removeObjectAtIndex:index];
-		// unlock for access so others can access in response to didChange
-		pthread_mutex_unlock(&_generalLock);
-		[self didChange:NSKeyValueChangeRemoval valuesAtIndexes:indexSet forKey:@"servers"];
-		
-		[[NSNotificationCenter defaultCenter] postNotificationName:SyphonServerRetireNotification object:self userInfo:serverInfo];
+		[self commitChangesHavingMutateLock];
 	}
 	// unlock mutate lock
 	pthread_mutex_unlock(&_mutateLock);
@@ -292,86 +1008,118 @@ NSString * const SyphonServerRetireNotification = @"SyphonServerRetireNotificati
 {
 //	SYPHONLOG(@"updated server description: %@", serverInfo);
 
-	NSDictionary* serverInfo = [[aNotification userInfo] pimpedVersionForSyphon];
-	NSString *uuid = [serverInfo objectForKey:SyphonServerDescriptionUUIDKey];
+	NSDictionary* serverInfo = [self descriptionWithIcon:[aNotification userInfo]];
 	// Lock so nobody mutates for the duration
 	pthread_mutex_lock(&_mutateLock);
-	// lock for access
 	pthread_mutex_lock(&_generalLock);
-	NSUInteger index = [_servers indexOfDescriptionForSyphonServerUUID:uuid];
-	// unlock for access so others can access in response to willChange
+	NSUInteger index = [self indexOfServerHavingLock:[serverInfo objectForKey:SyphonServerDescriptionUUIDKey]];
+	// Servers which send changes also send these for older directories, so we will usually have applied it already
+	BOOL isNewer = index == NSNotFound || [self isNewerThanServerHavingLock:serverInfo atIndex:index];
 	pthread_mutex_unlock(&_generalLock);
-	if(index != NSNotFound)
+	if (isNewer)
 	{
-		NSIndexSet *indexSet = [NSIndexSet indexSetWithIndex:index];
-		[self willChange:NSKeyValueChangeReplacement valuesAtIndexes:indexSet forKey:@"servers"];
-		// lock for access
-		pthread_mutex_lock(&_generalLock);
-		[_servers replaceObjectAtIndex:index withObject:serverInfo];
-		// unlock for access so others can access in response to didChange
-		pthread_mutex_unlock(&_generalLock);
-		[self didChange:NSKeyValueChangeReplacement valuesAtIndexes:indexSet forKey:@"servers"];
-				
-		[[NSNotificationCenter defaultCenter] postNotificationName:SyphonServerUpdateNotification object:self userInfo:serverInfo];
+		[self updateServerHavingMutateLock:serverInfo];
 	}
 	pthread_mutex_unlock(&_mutateLock);
 }
-@end
-
-@implementation NSDictionary (SyphonServerDirectoryPimpMyDictionary)
-/*
- 
- This all seems a bit silly, and it is probably easier and has no performance penalty to pass the NSImage through the notification.
- NSImage is NSCoding compliant, so that should work and save us a bit of hassle and this bit of code.
-  */
 
-- (NSDictionary *)pimpedVersionForSyphon
+- (void)handleServerChange:(NSNotification *)aNotification
 {
-	if ([self objectForKey:SyphonServerDescriptionIconKey] == nil)
+	NSDictionary *change = [aNotification userInfo];
+	NSString *uuid = [change objectForKey:SyphonServerDescriptionUUIDKey];
+	// Lock so nobody mutates for the duration
+	pthread_mutex_lock(&_mutateLock);
+	pthread_mutex_lock(&_generalLock);
+	NSUInteger index = [self indexOfServerHavingLock:uuid];
+	NSDictionary *current = index == NSNotFound ? nil : [_servers objectAtIndex:index];
+	pthread_mutex_unlock(&_generalLock);
+	NSMutableDictionary *merged = nil;
+	if (current
+		&& SyphonServerDirectoryRevision(change) > SyphonServerDirectoryRevision(current)
+		&& [[change objectForKey:SyphonServerChangeBaseRevisionKey] unsignedLongLongValue] == SyphonServerDirectoryRevision(current))
 	{
-		NSString *appName = [self objectForKey:SyphonServerDescriptionAppNameKey];
-		NSImage *appImage = nil;
-		for(NSRunningApplication* app in [[NSWorkspace sharedWorkspace] runningApplications])
-		{
-			if([appName isEqualToString:[app localizedName]])
+		// Apply the change in place, keeping anything we added, such as the icon
+		merged = [current mutableCopy];
+		[change enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+			if (![key isEqual:SyphonServerChangeBaseRevisionKey] && ![key isEqual:SyphonServerChangeRemovedKeysKey])
 			{
-				appImage = [app icon];
+				[merged setObject:obj forKey:key];
 			}
-		}
-		
-		if(appImage != nil)
+		}];
+		NSArray *removed = [change objectForKey:SyphonServerChangeRemovedKeysKey];
+		if ([removed isKindOfClass:[NSArray class]])
 		{
-			NSMutableDictionary *newDictionary = [NSMutableDictionary dictionaryWithDictionary:self];
-			[newDictionary setObject:appImage forKey:SyphonServerDescriptionIconKey];
-			return newDictionary;
+			[merged removeObjectsForKeys:removed];
 		}
-	}	
-	return self;
+	}
+	if (merged)
+	{
+		[self updateServerHavingMutateLock:[self descriptionWithIcon:merged]];
+	}
+	pthread_mutex_unlock(&_mutateLock);
+	if (current && merged == nil && SyphonServerDirectoryRevision(change) > SyphonServerDirectoryRevision(current))
+	{
+		// We missed an earlier change, so can't apply this one: the server's next announce will bring us up to date
+		[self requestAnnounceFromServer:uuid];
+	}
+}
+
+- (void)updateServerHavingMutateLock:(NSDictionary *)serverInfo
+{
+	NSString *uuid = [serverInfo objectForKey:SyphonServerDescriptionUUIDKey];
+	// lock for access
+	pthread_mutex_lock(&_generalLock);
+	NSUInteger index = [self indexOfServerHavingLock:uuid];
+	// An update shows the server is alive
+	if (uuid) [_leases removeObjectForKey:uuid];
+	if (index != NSNotFound)
+	{
+		[_servers replaceObjectAtIndex:index withObject:serverInfo];
+		[self addChangeHavingLock:SyphonServerUpdateNotification description:serverInfo];
+	}
+	// unlock for access so others can access in response to the change
+	pthread_mutex_unlock(&_generalLock);
+	if (index != NSNotFound)
+	{
+		[self commitChangesHavingMutateLock];
+	}
 }
 @end
 
-@implementation NSArray (SyphonServerDirectoryServerSearch)
-/*
- 
- UUID is the only sure identity, as other members of a dictionary may change, unhelpfully yeilding a NO for isEqual
- 
- */
-- (NSUInteger)indexOfDescriptionForSyphonServerUUID:(NSString *)uuid
+@implementation SyphonServerDirectoryQuery
 {
-	if (uuid == nil)
+	SyphonServerDirectory *_directory;
+	NSString *_name;
+	NSString *_appName;
+	os_unfair_lock _lock;
+	SyphonServerDirectorySnapshot *_snapshot;
+	NSArray<NSDictionary<NSString *, id<NSCoding>> *> *_servers;
+}
+
+- (instancetype)initWithDirectory:(SyphonServerDirectory *)directory name:(NSString *)name appName:(NSString *)appname
+{
+	self = [super init];
+	if (self)
 	{
-		return NSNotFound;
+		_directory = directory;
+		_name = [name copy];
+		_appName = [appname copy];
+		_lock = OS_UNFAIR_LOCK_INIT;
 	}
-	else
+	return self;
+}
+
+- (NSArray<NSDictionary<NSString *, id<NSCoding>> *> *)servers
+{
+	SyphonServerDirectorySnapshot *snapshot = _directory.snapshot;
+	os_unfair_lock_lock(&_lock);
+	if (_snapshot != snapshot)
 	{
-		return [self indexOfObjectPassingTest:^(id obj, NSUInteger idx, BOOL *stop) {
-			if ([[obj objectForKey:SyphonServerDescriptionUUIDKey] isEqualToString:uuid])
-			{
-				return YES;
-			} else {
-				return NO;
-			}
-		}];
+		_servers = [snapshot serversMatchingName:_name appName:_appName];
+		_snapshot = snapshot;
 	}
+	NSArray<NSDictionary<NSString *, id<NSCoding>> *> *result = _servers;
+	os_unfair_lock_unlock(&_lock);
+	return result;
 }
 @end
@@ -0,0 +1,69 @@
+/*
+    SyphonServerPreview.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <Foundation/Foundation.h>
+#import <IOSurface/IOSurface.h>
+#import "SyphonFrameMetadata.h"
+
+@class SyphonServerConnectionManager;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ SyphonServerPreview
+
+ Publishes a reduced copy of a server's frames as a separate stream, so clients which only display small images
+ don't read every full-size frame. The preview has its own connection, named for the server's UUID with a suffix,
+ and its own surface, which is refreshed from the server's surface at a capped rate and only while the preview has
+ clients. Frames are reduced using a box filter on a background queue: frames published while one is being reduced
+ are skipped.
+
+ Only 8-bit formats (SyphonPixelFormatBGRA8 and SyphonPixelFormatYCbCr420) can be previewed.
+ */
+
+@interface SyphonServerPreview : NSObject
++ (BOOL)supportsPixelFormat:(OSType)format;
+- (nullable instancetype)initWithServerUUID:(NSString *)uuid scale:(NSUInteger)scale frameRate:(double)frameRate pixelFormat:(OSType)format;
+/*
+ The dictionary advertised with SyphonServerDescriptionPreviewKey in the server's description.
+ */
+@property (readonly) NSDictionary<NSString *, id<NSCoding>> *previewDescription;
+@property (readonly) SyphonServerConnectionManager *connectionManager;
+/*
+ - (void)publishFromSurface:(IOSurfaceRef)surface metadata:(SyphonFrameMetadata)metadata
+
+ Called with each frame the server publishes. Reduces the frame into the preview's surface and publishes it if the
+ preview has clients and is due to be refreshed.
+ */
+- (void)publishFromSurface:(IOSurfaceRef)surface metadata:(SyphonFrameMetadata)metadata;
+- (void)stop;
+@end
+
+NS_ASSUME_NONNULL_END
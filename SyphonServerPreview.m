@@ -0,0 +1,225 @@
+/*
+    SyphonServerPreview.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SyphonServerPreview.h"
+#import "SyphonServerConnectionManager.h"
+#import "SyphonPixelKernels.h"
+#import "SyphonPixelFormat.h"
+#import "SyphonPrivate.h"
+#import <os/lock.h>
+
+static void *SyphonServerPreviewPlane(IOSurfaceRef surface, size_t plane, size_t *bytesPerRow, size_t *width, size_t *height, size_t *components)
+{
+    if (IOSurfaceGetPlaneCount(surface) == 0)
+    {
+        *bytesPerRow = IOSurfaceGetBytesPerRow(surface);
+        *width = IOSurfaceGetWidth(surface);
+        *height = IOSurfaceGetHeight(surface);
+        *components = IOSurfaceGetBytesPerElement(surface);
+        return IOSurfaceGetBaseAddress(surface);
+    }
+    *bytesPerRow = IOSurfaceGetBytesPerRowOfPlane(surface, plane);
+    *width = IOSurfaceGetWidthOfPlane(surface, plane);
+    *height = IOSurfaceGetHeightOfPlane(surface, plane);
+    *components = IOSurfaceGetBytesPerElementOfPlane(surface, plane);
+    return IOSurfaceGetBaseAddressOfPlane(surface, plane);
+}
+
+@implementation SyphonServerPreview
+{
+    SyphonServerConnectionManager *_connectionManager;
+    NSDictionary<NSString *, id<NSCoding>> *_previewDescription;
+    NSUInteger _scale;
+    uint64_t _interval;
+    OSType _pixelFormat;
+    dispatch_queue_t _queue;
+    os_unfair_lock _lock;
+    uint64_t _nextTime; // guarded by _lock
+    BOOL _busy; // guarded by _lock
+    IOSurfaceRef _surface; // only accessed on _queue
+    BOOL _pushPending; // only accessed on _queue
+}
+
++ (BOOL)supportsPixelFormat:(OSType)format
+{
+    return format == SyphonPixelFormatBGRA8 || format == SyphonPixelFormatYCbCr420;
+}
+
+- (instancetype)initWithServerUUID:(NSString *)uuid scale:(NSUInteger)scale frameRate:(double)frameRate pixelFormat:(OSType)format
+{
+    self = [super init];
+    if (self)
+    {
+        if (scale < 2 || scale > 256 || ![[self class] supportsPixelFormat:format])
+        {
+            return nil;
+        }
+        _scale = scale;
+        _interval = frameRate > 0.0 ? (uint64_t)(1000000000.0 / frameRate) : 0;
+        _pixelFormat = format;
+        _lock = OS_UNFAIR_LOCK_INIT;
+
+        NSString *previewUUID = [uuid stringByAppendingString:@".preview"];
+        _connectionManager = [[SyphonServerConnectionManager alloc] initWithUUID:previewUUID options:nil];
+        if (![_connectionManager start])
+        {
+            return nil;
+        }
+        NSDictionary<NSString *, id<NSCoding>> *surface = _connectionManager.surfaceDescription;
+        if (format != SyphonPixelFormatBGRA8)
+        {
+            NSMutableDictionary<NSString *, id<NSCoding>> *formatted = [surface mutableCopy];
+            [formatted setObject:@(format) forKey:SyphonSurfacePixelFormat];
+            surface = formatted;
+        }
+        _previewDescription = @{SyphonServerDescriptionUUIDKey: previewUUID,
+                                SyphonServerDescriptionSurfacesKey: @[surface],
+                                SyphonServerDescriptionPreviewScaleKey: @(scale)};
+        _queue = dispatch_queue_create("info.v002.Syphon.preview", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+    if (_surface)
+    {
+        CFRelease(_surface);
+    }
+}
+
+- (NSDictionary<NSString *, id<NSCoding>> *)previewDescription
+{
+    return _previewDescription;
+}
+
+- (SyphonServerConnectionManager *)connectionManager
+{
+    return _connectionManager;
+}
+
+- (void)stop
+{
+    [_connectionManager stop];
+}
+
+- (void)publishFromSurface:(IOSurfaceRef)surface metadata:(SyphonFrameMetadata)metadata
+{
+    if (surface == NULL || !_connectionManager.hasClients)
+    {
+        return;
+    }
+    uint64_t now = SyphonFrameTimestampNow();
+    os_unfair_lock_lock(&_lock);
+    BOOL due = !_busy && now >= _nextTime;
+    if (due)
+    {
+        _busy = YES;
+        _nextTime = now + _interval;
+    }
+    os_unfair_lock_unlock(&_lock);
+    if (!due)
+    {
+        return;
+    }
+    CFRetain(surface);
+    dispatch_async(_queue, ^{
+        BOOL published = [self reduceSurface:surface metadata:metadata];
+        CFRelease(surface);
+        os_unfair_lock_lock(&self->_lock);
+        self->_busy = NO;
+        if (!published)
+        {
+            // Try again with the next frame
+            self->_nextTime = 0;
+        }
+        os_unfair_lock_unlock(&self->_lock);
+    });
+}
+
+- (BOOL)reduceSurface:(IOSurfaceRef)source metadata:(SyphonFrameMetadata)metadata
+{
+    size_t width = (IOSurfaceGetWidth(source) + _scale - 1) / _scale;
+    size_t height = (IOSurfaceGetHeight(source) + _scale - 1) / _scale;
+    if (!_surface || IOSurfaceGetWidth(_surface) != width || IOSurfaceGetHeight(_surface) != height)
+    {
+        if (_surface)
+        {
+            CFRelease(_surface);
+        }
+        _surface = SyphonSurfaceCreate(width, height, _pixelFormat);
+        if (!_surface)
+        {
+            return NO;
+        }
+        // Clients are told of the surface with the first frame published to it, which may not be this one
+        _pushPending = YES;
+    }
+
+    uint32_t seed;
+    if (IOSurfaceLock(source, kIOSurfaceLockReadOnly, &seed) != kIOReturnSuccess)
+    {
+        return NO;
+    }
+    IOSurfaceLock(_surface, 0, NULL);
+    BOOL reduced = YES;
+    // Surfaces without planes have a plane count of zero but are handled as one plane
+    size_t planeCount = MAX(IOSurfaceGetPlaneCount(source), 1U);
+    for (size_t plane = 0; plane < planeCount && reduced; plane++)
+    {
+        // Each plane of the preview is a reduction of the same plane of the source
+        size_t srcBytesPerRow, width, height, components;
+        size_t dstBytesPerRow, dstWidth, dstHeight, dstComponents;
+        const void *src = SyphonServerPreviewPlane(source, plane, &srcBytesPerRow, &width, &height, &components);
+        void *dst = SyphonServerPreviewPlane(_surface, plane, &dstBytesPerRow, &dstWidth, &dstHeight, &dstComponents);
+        reduced = SyphonPixelDownscaleBox(dst, dstBytesPerRow, src, srcBytesPerRow, width, height, components, _scale);
+    }
+    IOSurfaceUnlock(_surface, 0, NULL);
+    uint32_t seedAfter;
+    IOSurfaceUnlock(source, kIOSurfaceLockReadOnly, &seedAfter);
+    if (!reduced || seed != seedAfter)
+    {
+        // The server drew the next frame while we were reading this one
+        return NO;
+    }
+
+    if (_pushPending)
+    {
+        [_connectionManager setSurfaceID:IOSurfaceGetID(_surface)];
+        _pushPending = NO;
+    }
+    // Dirty rects describe the full-size frame
+    metadata.dirtyRectCount = 0;
+    [_connectionManager publishNewFrameWithMetadata:SyphonFrameMetadataCreateData(&metadata, 0)];
+    return YES;
+}
+
+@end
@@ -0,0 +1,77 @@
+/*
+    SyphonServerPublishGroup.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#import <Foundation/Foundation.h>
+
+@class SyphonServerBase;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*!
+ A publish group announces frames from several servers in the same process together. Applications with many outputs, which publish a frame from every server each time they render, can publish them within ``publishUsingBlock:``, and clients are told of all the new frames at once: each client process receives one message for the frames of every server in the group, rather than one message for each server.
+
+ Servers publish frames as usual within the block. Only the announcement of frames to clients is deferred until the block returns. Frames submitted within the block to servers which finish drawing them later, such as SyphonMetalServer, whose frames are published when their command buffers complete, are announced once every frame submitted within the block has been published. Batches are announced in the order their blocks ran. A frame which brings a new surface, for instance because the server's frame size changed, is announced as usual, so clients never receive a frame before its surface. Clients of older versions of Syphon are also sent frames as usual. Clients' new frame handlers for grouped frames run asynchronously, each on its own client's queue, so a slow handler doesn't delay other clients or the servers: a handler still busy when further frames arrive is called once more for the latest of them.
+
+ A server may belong to one group at a time. The group doesn't retain its servers.
+
+ It is safe to access instances of this class across threads. Frames submitted on any thread to a server in the group while a block is running are announced with that block's frames.
+ */
+@interface SyphonServerPublishGroup : NSObject
+
+/*!
+ The servers in the group.
+ */
+@property (readonly) NSArray<SyphonServerBase *> *servers;
+
+/*!
+ Adds a server to the group, removing it from any other group it belongs to.
+
+ @param server The server to add.
+ */
+- (void)addServer:(SyphonServerBase *)server;
+
+/*!
+ Removes a server from the group. Any of its frames waiting to be announced are announced immediately.
+
+ @param server The server to remove.
+ */
+- (void)removeServer:(SyphonServerBase *)server;
+
+/*!
+ Runs a block in which you publish frames from servers in the group, then announces the new frames to clients together, once any still being drawn have been published. Calls to this method may be nested, in which case frames are announced with those of the outermost block.
+
+ @param block A block which publishes frames.
+ */
+- (void)publishUsingBlock:(void (NS_NOESCAPE ^)(void))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
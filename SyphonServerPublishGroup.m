@@ -0,0 +1,347 @@
+/*
+    SyphonServerPublishGroup.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#import "SyphonServerPublishGroup.h"
+#import "SyphonServerPublishGroupPrivate.h"
+#import "SyphonPrivate.h"
+#import "SyphonMessaging.h"
+#import <os/lock.h>
+
+/*
+ The frames collected by one outermost call to -publishUsingBlock:, including those submitted during the call by
+ servers which publish them later, once they are drawn.
+ */
+@interface SyphonServerPublishBatch : NSObject
+@property (readonly) NSMapTable<SyphonServerBase *, NSData *> *frames; // the metadata of each server's latest frame
+@property NSUInteger outstanding; // the number of frames claimed for the batch which haven't been published
+@property BOOL open; // YES while the block collecting the batch runs
+@end
+
+@implementation SyphonServerPublishBatch
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        _frames = [NSMapTable mapTableWithKeyOptions:NSMapTableStrongMemory | NSMapTableObjectPointerPersonality
+                                        valueOptions:NSMapTableStrongMemory];
+        _open = YES;
+    }
+    return self;
+}
+
+@end
+
+@implementation SyphonServerPublishGroup
+{
+    os_unfair_lock _lock;
+    dispatch_queue_t _announceQueue; // announces batches in the order they were taken, so messages aren't sent while a lock is held
+    NSCountedSet<SyphonServerBase *> *_queued; // servers with frames waiting on _announceQueue
+    NSHashTable<SyphonServerBase *> *_servers;
+    NSUInteger _depth; // the number of calls to -publishUsingBlock: running
+    SyphonServerPublishBatch *_current; // the batch of the running block, nil if none is running
+    NSMutableArray<SyphonServerPublishBatch *> *_batches; // batches not yet announced, oldest first
+    NSMapTable<SyphonServerBase *, NSMutableArray *> *_claims; // for each server, the batch (or NSNull for none) of each of its unpublished frames, oldest first
+    NSMutableDictionary<NSString *, SyphonMessageSender *> *_senders; // keyed by the name of each frame port
+}
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self)
+    {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _announceQueue = dispatch_queue_create("info.v002.Syphon.publishgroup", DISPATCH_QUEUE_SERIAL);
+        _queued = [[NSCountedSet alloc] initWithCapacity:4];
+        _servers = [NSHashTable weakObjectsHashTable];
+        _batches = [[NSMutableArray alloc] initWithCapacity:2];
+        _claims = [NSMapTable mapTableWithKeyOptions:NSMapTableStrongMemory | NSMapTableObjectPointerPersonality
+                                        valueOptions:NSMapTableStrongMemory];
+        _senders = [[NSMutableDictionary alloc] initWithCapacity:4];
+    }
+    return self;
+}
+
+- (NSArray<SyphonServerBase *> *)servers
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<SyphonServerBase *> *servers = _servers.allObjects;
+    os_unfair_lock_unlock(&_lock);
+    return servers;
+}
+
+- (void)addServer:(SyphonServerBase *)server
+{
+    SyphonServerPublishGroup *previous = server.publishGroup;
+    if (previous == self)
+    {
+        return;
+    }
+    [previous removeServer:server];
+    os_unfair_lock_lock(&_lock);
+    [_servers addObject:server];
+    os_unfair_lock_unlock(&_lock);
+    server.publishGroup = self;
+}
+
+- (void)removeServer:(SyphonServerBase *)server
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL isMember = [_servers containsObject:server];
+    [_servers removeObject:server];
+    // The server's frames no longer hold up batches, and the latest of any waiting is announced now
+    for (id batch in [_claims objectForKey:server])
+    {
+        if (batch != [NSNull null])
+        {
+            ((SyphonServerPublishBatch *)batch).outstanding--;
+        }
+    }
+    [_claims removeObjectForKey:server];
+    NSData *pending = nil;
+    for (SyphonServerPublishBatch *batch in _batches)
+    {
+        pending = [batch.frames objectForKey:server] ?: pending;
+        [batch.frames removeObjectForKey:server];
+    }
+    if (pending)
+    {
+        NSMapTable<SyphonServerBase *, NSData *> *frames = [NSMapTable strongToStrongObjectsMapTable];
+        [frames setObject:pending forKey:server];
+        [self queueFramesHavingLock:frames];
+    }
+    [self queueBatchesHavingLock:[self takeReadyBatchesHavingLock]];
+    os_unfair_lock_unlock(&_lock);
+    if (isMember && server.publishGroup == self)
+    {
+        server.publishGroup = nil;
+    }
+}
+
+- (void)publishUsingBlock:(void (NS_NOESCAPE ^)(void))block
+{
+    os_unfair_lock_lock(&_lock);
+    if (_depth++ == 0)
+    {
+        _current = [[SyphonServerPublishBatch alloc] init];
+        [_batches addObject:_current];
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    block();
+
+    os_unfair_lock_lock(&_lock);
+    if (--_depth == 0)
+    {
+        // Frames still being drawn are announced with the batch once they are published
+        _current.open = NO;
+        _current = nil;
+    }
+    [self queueBatchesHavingLock:[self takeReadyBatchesHavingLock]];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)claimFrameFromServer:(SyphonServerBase *)server
+{
+    // Frames claimed outside a block are recorded too, so the server's claims stay in step with its frames
+    os_unfair_lock_lock(&_lock);
+    NSMutableArray *claims = [_claims objectForKey:server];
+    if (!claims)
+    {
+        claims = [NSMutableArray arrayWithCapacity:2];
+        [_claims setObject:claims forKey:server];
+    }
+    [claims addObject:_current ?: [NSNull null]];
+    _current.outstanding++;
+    os_unfair_lock_unlock(&_lock);
+}
+
+/*
+ Returns the batch a frame being published by the server belongs to, if any, releasing its claim. Servers publish
+ frames in the order they claimed them.
+ */
+- (SyphonServerPublishBatch *)takeBatchForServerHavingLock:(SyphonServerBase *)server
+{
+    NSMutableArray *claims = [_claims objectForKey:server];
+    if (claims.count == 0)
+    {
+        // An unclaimed frame published within a block joins its batch
+        return _current;
+    }
+    id claim = claims.firstObject;
+    [claims removeObjectAtIndex:0];
+    if (claims.count == 0)
+    {
+        [_claims removeObjectForKey:server];
+    }
+    if (claim == [NSNull null])
+    {
+        return nil;
+    }
+    SyphonServerPublishBatch *batch = claim;
+    batch.outstanding--;
+    return batch;
+}
+
+/*
+ Removes and returns the batches which can be announced: those, oldest first, whose blocks have returned and whose
+ frames have all been published. A batch waits for any older batch, so each server's frames are announced in order.
+ */
+- (NSArray<SyphonServerPublishBatch *> *)takeReadyBatchesHavingLock
+{
+    NSUInteger count = 0;
+    while (count < _batches.count && !_batches[count].open && _batches[count].outstanding == 0)
+    {
+        count++;
+    }
+    NSArray<SyphonServerPublishBatch *> *ready = [_batches subarrayWithRange:NSMakeRange(0, count)];
+    [_batches removeObjectsInRange:NSMakeRange(0, count)];
+    return ready;
+}
+
+- (BOOL)deferFrameMetadata:(NSData *)metadata fromServer:(SyphonServerBase *)server deferrable:(BOOL)deferrable
+{
+    os_unfair_lock_lock(&_lock);
+    SyphonServerPublishBatch *batch = [self takeBatchForServerHavingLock:server];
+    BOOL defers = deferrable && batch != nil;
+    if (defers)
+    {
+        [batch.frames setObject:metadata forKey:server];
+    }
+    else
+    {
+        // The server announces this frame now, so its earlier frames waiting here would arrive after it
+        for (SyphonServerPublishBatch *waiting in _batches)
+        {
+            [waiting.frames removeObjectForKey:server];
+        }
+    }
+    [self queueBatchesHavingLock:[self takeReadyBatchesHavingLock]];
+    BOOL inFlight = !defers && [_queued countForObject:server] != 0;
+    os_unfair_lock_unlock(&_lock);
+    if (inFlight)
+    {
+        // The server's earlier frames already taken for announcement must reach clients before this one
+        dispatch_sync(_announceQueue, ^{});
+    }
+    return defers;
+}
+
+- (void)skipFrameFromServer:(SyphonServerBase *)server
+{
+    os_unfair_lock_lock(&_lock);
+    [self takeBatchForServerHavingLock:server];
+    [self queueBatchesHavingLock:[self takeReadyBatchesHavingLock]];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)queueBatchesHavingLock:(NSArray<SyphonServerPublishBatch *> *)batches
+{
+    for (SyphonServerPublishBatch *batch in batches)
+    {
+        if (batch.frames.count)
+        {
+            [self queueFramesHavingLock:batch.frames];
+        }
+    }
+}
+
+/*
+ Announces frames on _announceQueue. Frames are queued with the lock held, so they are announced in the order they
+ were taken, but sent without it, so a client process slow to receive them holds up only the queue.
+ */
+- (void)queueFramesHavingLock:(NSMapTable<SyphonServerBase *, NSData *> *)frames
+{
+    for (SyphonServerBase *server in frames)
+    {
+        [_queued addObject:server];
+    }
+    dispatch_async(_announceQueue, ^{
+        [self announceFrames:frames];
+        os_unfair_lock_lock(&self->_lock);
+        for (SyphonServerBase *server in frames)
+        {
+            [self->_queued removeObject:server];
+        }
+        os_unfair_lock_unlock(&self->_lock);
+    });
+}
+
+- (void)announceFrames:(NSMapTable<SyphonServerBase *, NSData *> *)frames
+{
+    // Each server adds its clients' frames to the batch for their process' frame port
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSData *> *> *batches = [NSMutableDictionary dictionaryWithCapacity:4];
+    for (SyphonServerBase *server in frames)
+    {
+        [server announceFrameMetadata:[frames objectForKey:server] batches:batches];
+    }
+    [batches enumerateKeysAndObjectsUsingBlock:^(NSString *port, NSMutableDictionary<NSString *, NSData *> *batch, BOOL *stop) {
+        [[self senderForFramePort:port] send:batch ofType:SyphonMessageTypeNewFrameBatch];
+    }];
+}
+
+- (SyphonMessageSender *)senderForFramePort:(NSString *)port
+{
+    os_unfair_lock_lock(&_lock);
+    SyphonMessageSender *sender = [_senders objectForKey:port];
+    os_unfair_lock_unlock(&_lock);
+    if (sender == nil)
+    {
+        __weak SyphonServerPublishGroup *weakSelf = self;
+        sender = [[SyphonMessageSender alloc] initForName:port
+                                                 protocol:SyphonMessagingProtocolCFMessage
+                                      invalidationHandler:^(void){
+            // The client process has gone
+            [weakSelf removeSenderForFramePort:port];
+        }];
+        if (sender)
+        {
+            os_unfair_lock_lock(&_lock);
+            [_senders setObject:sender forKey:port];
+            os_unfair_lock_unlock(&_lock);
+        }
+        else
+        {
+            SYPHONLOG(@"Failed to create connection to frame port %@", port);
+        }
+    }
+    return sender;
+}
+
+- (void)removeSenderForFramePort:(NSString *)port
+{
+    os_unfair_lock_lock(&_lock);
+    [_senders removeObjectForKey:port];
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
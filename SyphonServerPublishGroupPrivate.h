@@ -0,0 +1,79 @@
+/*
+    SyphonServerPublishGroupPrivate.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#import <Foundation/Foundation.h>
+#import "SyphonServerBase.h"
+#import "SyphonServerPublishGroup.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SyphonServerPublishGroup (Private)
+/*
+ - (void)claimFrameFromServer:(SyphonServerBase *)server
+
+ Called by a server in the group when it claims metadata for a frame (see -metadataForNewFrame). A frame claimed
+ within -publishUsingBlock: belongs to that call's batch even if it is published after the block returns, as frames
+ drawn asynchronously are, and the batch is announced once all its frames are published. The server must follow each
+ claim with -deferFrameMetadata:fromServer:deferrable: or -skipFrameFromServer:, in the same order.
+ */
+- (void)claimFrameFromServer:(SyphonServerBase *)server;
+/*
+ - (BOOL)deferFrameMetadata:(NSData *)metadata fromServer:(SyphonServerBase *)server deferrable:(BOOL)deferrable
+
+ Called by a server in the group when it publishes a frame. Returns YES if the frame belongs to a batch, in which
+ case the group announces it with the batch, replacing any earlier frame from the same server in the batch. Returns NO
+ if the server should announce the frame itself, as it must if the frame isn't deferrable, for instance because it
+ brings a new surface, in which case it first waits for any of the server's earlier frames the group is announcing.
+ Batches are announced on a queue of the group's, so this never waits for a client otherwise.
+ */
+- (BOOL)deferFrameMetadata:(NSData *)metadata fromServer:(SyphonServerBase *)server deferrable:(BOOL)deferrable;
+/*
+ - (void)skipFrameFromServer:(SyphonServerBase *)server
+
+ Called by a server in the group in place of -deferFrameMetadata:fromServer:deferrable: for a frame it doesn't publish.
+ */
+- (void)skipFrameFromServer:(SyphonServerBase *)server;
+@end
+
+/*
+ Publish group support for SyphonServerBase.
+ */
+@interface SyphonServerBase (SyphonPublishGroup)
+@property (weak, nullable) SyphonServerPublishGroup *publishGroup;
+/*
+ - (void)announceFrameMetadata:(NSData *)metadata batches:(NSMutableDictionary *)batches
+
+ Announces a frame deferred by the server's group. See -[SyphonServerConnectionManager publishNewFrameWithMetadata:batches:].
+ */
+- (void)announceFrameMetadata:(NSData *)metadata batches:(NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSData *> *> *)batches;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -206,7 +206,7 @@
     if(self.MSAASampleCount > 0)
     {
         // Color MSAA Attachment
-        _msaaColorBuffer = [self newRenderbufferForInternalFormat:GL_RGBA];
+        _msaaColorBuffer = [self newRenderbufferForInternalFormat:self.colorBufferFormat];
 
         // attach color, depth and stencil to our MSAA FBO
         glGenFramebuffers(1, &_msaaFBO);
@@ -358,7 +358,7 @@
 }
 
 
-- (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped
+- (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped dirtyRects:(const NSRect *)rects count:(NSUInteger)count
 {
     if (_vertices == nil)
     {
@@ -421,7 +421,29 @@
 
     [_shader useProgram];
     [_vertices bind];
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    if (count == 0)
+    {
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    }
+    else
+    {
+#ifdef SYPHON_CORE_RESTORE
+        GLboolean prevScissorTest = glIsEnabled(GL_SCISSOR_TEST);
+        GLint prevScissorBox[4];
+        glGetIntegerv(GL_SCISSOR_BOX, prevScissorBox);
+#endif
+        glEnable(GL_SCISSOR_TEST);
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            glScissor(rects[i].origin.x, rects[i].origin.y, rects[i].size.width, rects[i].size.height);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+#ifdef SYPHON_CORE_RESTORE
+        glScissor(prevScissorBox[0], prevScissorBox[1], prevScissorBox[2], prevScissorBox[3]);
+        if (!prevScissorTest)
+#endif
+        glDisable(GL_SCISSOR_TEST);
+    }
     [_vertices unbind];
     [_shader endProgram];
 
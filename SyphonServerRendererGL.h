@@ -37,6 +37,7 @@
 @property (readonly) GLuint MSAASampleCount;
 @property (readonly) GLenum depthBufferFormat;
 @property (readonly) GLenum stencilBufferFormat;
+@property (readwrite) GLenum colorBufferFormat; // The internal format used for intermediate color buffers, defaults to GL_RGBA
 @property (readonly) GLsizei width;
 @property (readonly) GLsizei height;
 - (void)beginInContext; // Called once before any number of the following are called
@@ -49,4 +50,6 @@
 - (void)unbind;
 - (void)flush;
 - (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped;
+// Only draws within rects (in the coordinates of the FBO), leaving the rest untouched. If count is 0 the entire FBO is drawn.
+- (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped dirtyRects:(const NSRect *)rects count:(NSUInteger)count;
 @end
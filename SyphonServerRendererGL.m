@@ -40,6 +40,7 @@
 #define SYPHON_GL_STENCIL_INDEX4    0x8D47
 #define SYPHON_GL_STENCIL_INDEX8    0x8D48
 #define SYPHON_GL_STENCIL_INDEX16   0x8D49
+#define SYPHON_GL_RGBA              0x1908
 
 @implementation SyphonServerRendererGL
 {
@@ -48,6 +49,7 @@
     GLuint  _MSAASampleCount;
     GLenum  _depthBufferFormat;
     GLenum  _stencilBufferFormat;
+    GLenum  _colorBufferFormat;
     GLsizei _width;
     GLsizei _height;
 }
@@ -59,6 +61,7 @@
     {
         _context = CGLRetainContext(context);
         _MSAASampleCount = msc;
+        _colorBufferFormat = SYPHON_GL_RGBA;
         if (dbr == 0) _depthBufferFormat = 0;
         else if (dbr < 20) _depthBufferFormat = SYPHON_GL_DEPTH_COMPONENT16;
         else if (dbr < 28) _depthBufferFormat = SYPHON_GL_DEPTH_COMPONENT24;
@@ -102,6 +105,16 @@
     return _stencilBufferFormat;
 }
 
+- (GLenum)colorBufferFormat
+{
+    return _colorBufferFormat;
+}
+
+- (void)setColorBufferFormat:(GLenum)colorBufferFormat
+{
+    _colorBufferFormat = colorBufferFormat;
+}
+
 - (GLsizei)width
 {
     return _width;
@@ -159,6 +172,11 @@
 }
 
 - (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped
+{
+    [self drawFrameTexture:texID textureTarget:target imageRegion:region textureDimensions:size flipped:isFlipped dirtyRects:NULL count:0];
+}
+
+- (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped dirtyRects:(const NSRect *)rects count:(NSUInteger)count
 {
 
 }
@@ -183,7 +183,7 @@
     if(self.MSAASampleCount > 0)
     {
         // Color MSAA Attachment
-        _msaaColorBuffer = [self newRenderbufferForInternalFormat:GL_RGBA];
+        _msaaColorBuffer = [self newRenderbufferForInternalFormat:self.colorBufferFormat];
 
         // attach color, depth and stencil to our MSAA FBO
         glGenFramebuffersEXT(1, &_msaaFBO);
@@ -326,7 +326,7 @@
     glFlush();
 }
 
-- (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped
+- (void)drawFrameTexture:(GLuint)texID textureTarget:(GLenum)target imageRegion:(NSRect)region textureDimensions:(NSSize)size flipped:(BOOL)isFlipped dirtyRects:(const NSRect *)rects count:(NSUInteger)count
 {
     // render to our FBO with an IOSurface backed texture attachment (whew!)
 
@@ -421,7 +421,20 @@
     glTexCoordPointer(2, GL_FLOAT, 0, tex_coords );
     glEnableClientState(GL_VERTEX_ARRAY);
     glVertexPointer(2, GL_FLOAT, 0, verts );
-    glDrawArrays( GL_TRIANGLE_FAN, 0, 4 );
+    if (count == 0)
+    {
+        glDrawArrays( GL_TRIANGLE_FAN, 0, 4 );
+    }
+    else
+    {
+        // Scissor state is restored by glPopAttrib() below
+        glEnable(GL_SCISSOR_TEST);
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            glScissor(rects[i].origin.x, rects[i].origin.y, rects[i].size.width, rects[i].size.height);
+            glDrawArrays( GL_TRIANGLE_FAN, 0, 4 );
+        }
+    }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementArrayBuffer);
     glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
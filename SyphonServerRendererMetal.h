@@ -30,10 +30,15 @@
 #import <Foundation/Foundation.h>
 #import <Metal/Metal.h>
 
+// Returns the MTLPixelFormat for a single-plane SyphonPixelFormat, or MTLPixelFormatInvalid if there is none
+MTLPixelFormat SyphonMetalPixelFormatForPixelFormat(OSType format);
+
 @interface SyphonServerRendererMetal : NSObject
 
 - (instancetype) initWithDevice:(id<MTLDevice>)device colorPixelFormat:(MTLPixelFormat)colorPixelFormat;
 - (void)renderFromTexture:(id<MTLTexture>)offScreenTexture inTexture:(id<MTLTexture>)texture region:(NSRect)region onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer flip:(BOOL)flip;
+// Only draws within rects (in the coordinates of texture), preserving the rest of texture. If count is 0 the entire texture is drawn.
+- (void)renderFromTexture:(id<MTLTexture>)offScreenTexture inTexture:(id<MTLTexture>)texture region:(NSRect)region dirtyRects:(const NSRect *)rects count:(NSUInteger)count onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer flip:(BOOL)flip;
 
 
 @end
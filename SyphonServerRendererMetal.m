@@ -30,6 +30,22 @@
 #import "SyphonServerRendererMetal.h"
 #include <simd/simd.h>
 #include "SyphonServerMetalTypes.h"
+#import "SyphonPixelFormat.h"
+
+MTLPixelFormat SyphonMetalPixelFormatForPixelFormat(OSType format)
+{
+    switch (format) {
+        case 0: // Surfaces from older servers don't set a format
+        case SyphonPixelFormatBGRA8:
+            return MTLPixelFormatBGRA8Unorm;
+        case SyphonPixelFormatRGBA16Float:
+            return MTLPixelFormatRGBA16Float;
+        case SyphonPixelFormatRGB10A2:
+            return MTLPixelFormatBGR10A2Unorm;
+        default:
+            return MTLPixelFormatInvalid;
+    }
+}
 
 @implementation SyphonServerRendererMetal
 {
@@ -75,6 +91,11 @@
 
 
 - (void)renderFromTexture:(id<MTLTexture>)offScreenTexture inTexture:(id<MTLTexture>)texture region:(NSRect)region onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer flip:(BOOL)flip
+{
+    [self renderFromTexture:offScreenTexture inTexture:texture region:region dirtyRects:NULL count:0 onCommandBuffer:commandBuffer flip:flip];
+}
+
+- (void)renderFromTexture:(id<MTLTexture>)offScreenTexture inTexture:(id<MTLTexture>)texture region:(NSRect)region dirtyRects:(const NSRect *)rects count:(NSUInteger)count onCommandBuffer:(id<MTLCommandBuffer>)commandBuffer flip:(BOOL)flip
 {
     if( texture == nil )
     {
@@ -102,7 +123,8 @@
     
     const NSUInteger numberOfVertices = sizeof(quadVertices) / sizeof(SYPHONTextureVertex);
     MTLRenderPassDescriptor *renderPassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
-    renderPassDescriptor.colorAttachments[0].loadAction = MTLLoadActionClear;
+    // Partial updates must preserve the previous content outside the dirty rects
+    renderPassDescriptor.colorAttachments[0].loadAction = count ? MTLLoadActionLoad : MTLLoadActionClear;
     renderPassDescriptor.colorAttachments[0].clearColor = MTLClearColorMake(0, 0, 0, 0);
     renderPassDescriptor.colorAttachments[0].texture = texture;
     renderPassDescriptor.colorAttachments[0].storeAction = MTLStoreActionStore;
@@ -115,7 +137,16 @@
     [renderEncoder setVertexBytes:quadVertices length:sizeof(quadVertices) atIndex:SYPHONVertexInputIndexVertices];
     [renderEncoder setVertexBytes:&viewportSize length:sizeof(viewportSize) atIndex:SYPHONVertexInputIndexViewportSize];
     [renderEncoder setFragmentTexture:offScreenTexture atIndex:SYPHONTextureIndexZero];
-    [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:numberOfVertices];
+    if (count == 0)
+    {
+        [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:numberOfVertices];
+    }
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        MTLScissorRect scissor = { rects[i].origin.x, rects[i].origin.y, rects[i].size.width, rects[i].size.height };
+        [renderEncoder setScissorRect:scissor];
+        [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle vertexStart:0 vertexCount:numberOfVertices];
+    }
     [renderEncoder endEncoding];
 }
 
@@ -0,0 +1,104 @@
+/*
+    SyphonServerTile.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import <Foundation/Foundation.h>
+#import <IOSurface/IOSurface.h>
+#import "SyphonServerBase.h"
+#import "SyphonFrameMetadata.h"
+
+@class SyphonServerConnectionManager;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ SyphonServerTile
+
+ One tile of a tiled server's canvas (see SyphonServerOptionTileSize), published as a separate stream so clients
+ which only need part of the canvas receive only that part. Each tile has its own connection, named for the server's
+ UUID with a suffix for its position in the grid, and its own surface, sized to the tile.
+
+ A tile's rect may change if the canvas changes size, but its connection is kept.
+ */
+
+@interface SyphonServerTile : NSObject
+- (nullable instancetype)initWithServerUUID:(NSString *)uuid column:(NSUInteger)column row:(NSUInteger)row surfaceDescription:(NSDictionary<NSString *, id<NSCoding>> *)surface pixelFormat:(OSType)format;
+@property (readonly) NSUInteger column;
+@property (readonly) NSUInteger row;
+/*
+ The tile's position within the canvas, in pixels, where the origin is the first pixel of the canvas' first row.
+ */
+@property NSRect rect;
+/*
+ The dictionary advertised in the server description's SyphonServerDescriptionTilesKey array.
+ */
+@property (readonly) NSDictionary<NSString *, id<NSCoding>> *tileDescription;
+@property (readonly) SyphonServerConnectionManager *connectionManager;
+@property (readonly) BOOL hasClients;
+/*
+ YES if the tile has missed changes to the canvas because it had no clients, and must be redrawn in full before it is
+ next published. Set and cleared by the server.
+ */
+@property BOOL needsRedraw;
+/*
+ - (IOSurfaceRef)newSurfaceIsNew:(BOOL *)isNew
+
+ Returns the tile's surface, sized to its rect, creating it if necessary, in which case isNew is set to YES and the
+ surface must be drawn in full. The caller is responsible for releasing the result.
+ */
+- (nullable IOSurfaceRef)newSurfaceIsNew:(BOOL *)isNew CF_RETURNS_RETAINED;
+- (void)publishWithFrameMetadata:(SyphonFrameMetadata)metadata;
+- (void)stop;
+@end
+
+/*
+ Tiling support for subclasses of SyphonServerBase.
+ */
+@interface SyphonServerBase (SyphonTiling)
+/*
+ The size of tiles set with SyphonServerOptionTileSize, or NSZeroSize if the server isn't tiled.
+ */
+@property (readonly) NSSize tileSize;
+/*
+ - (NSArray<SyphonServerTile *> *)tilesForCanvasSize:(NSSize)size
+
+ Returns the tiles covering a canvas of the given size, creating and removing tiles and updating the server's
+ description if the size has changed. Tiles are ordered by row, then by column.
+ */
+- (NSArray<SyphonServerTile *> *)tilesForCanvasSize:(NSSize)size;
+/*
+ - (uint64_t)nextFrameSequence
+
+ Claims the sequence number of the next frame. Tiled frames aren't published through -publishWithFrameMetadata:,
+ which otherwise assigns it.
+ */
+- (uint64_t)nextFrameSequence;
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,175 @@
+/*
+    SyphonServerTile.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#import "SyphonServerTile.h"
+#import "SyphonServerConnectionManager.h"
+#import "SyphonPrivate.h"
+#import <os/lock.h>
+
+@implementation SyphonServerTile
+{
+    SyphonServerConnectionManager *_connectionManager;
+    NSString *_uuid;
+    NSDictionary<NSString *, id<NSCoding>> *_surfaceDescription;
+    OSType _pixelFormat;
+    os_unfair_lock _lock;
+    NSRect _rect; // guarded by _lock
+    NSDictionary<NSString *, id<NSCoding>> *_tileDescription; // guarded by _lock
+    BOOL _needsRedraw; // guarded by _lock
+    IOSurfaceRef _surface; // only accessed by the server's publishing thread
+    BOOL _pushPending;
+}
+
+- (instancetype)initWithServerUUID:(NSString *)uuid column:(NSUInteger)column row:(NSUInteger)row surfaceDescription:(NSDictionary<NSString *, id<NSCoding>> *)surface pixelFormat:(OSType)format
+{
+    self = [super init];
+    if (self)
+    {
+        _column = column;
+        _row = row;
+        _uuid = [uuid stringByAppendingFormat:@".tile.%lu.%lu", (unsigned long)column, (unsigned long)row];
+        _surfaceDescription = surface;
+        _pixelFormat = format;
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _connectionManager = [[SyphonServerConnectionManager alloc] initWithUUID:_uuid options:nil];
+        if (![_connectionManager start])
+        {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+    if (_surface)
+    {
+        CFRelease(_surface);
+    }
+}
+
+- (NSRect)rect
+{
+    os_unfair_lock_lock(&_lock);
+    NSRect result = _rect;
+    os_unfair_lock_unlock(&_lock);
+    return result;
+}
+
+- (void)setRect:(NSRect)rect
+{
+    os_unfair_lock_lock(&_lock);
+    if (!NSEqualRects(rect, _rect))
+    {
+        _rect = rect;
+        _tileDescription = nil;
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSDictionary<NSString *, id<NSCoding>> *)tileDescription
+{
+    os_unfair_lock_lock(&_lock);
+    if (!_tileDescription)
+    {
+        _tileDescription = @{SyphonServerDescriptionUUIDKey: _uuid,
+                             SyphonServerDescriptionSurfacesKey: @[_surfaceDescription],
+                             SyphonServerDescriptionTileRectKey: @[@(_rect.origin.x), @(_rect.origin.y), @(_rect.size.width), @(_rect.size.height)]};
+    }
+    NSDictionary<NSString *, id<NSCoding>> *result = _tileDescription;
+    os_unfair_lock_unlock(&_lock);
+    return result;
+}
+
+- (BOOL)needsRedraw
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL result = _needsRedraw;
+    os_unfair_lock_unlock(&_lock);
+    return result;
+}
+
+- (void)setNeedsRedraw:(BOOL)needsRedraw
+{
+    os_unfair_lock_lock(&_lock);
+    _needsRedraw = needsRedraw;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (SyphonServerConnectionManager *)connectionManager
+{
+    return _connectionManager;
+}
+
+- (BOOL)hasClients
+{
+    return _connectionManager.hasClients;
+}
+
+- (IOSurfaceRef)newSurfaceIsNew:(BOOL *)isNew
+{
+    NSRect rect = self.rect;
+    size_t width = rect.size.width;
+    size_t height = rect.size.height;
+    *isNew = NO;
+    if (!_surface || IOSurfaceGetWidth(_surface) != width || IOSurfaceGetHeight(_surface) != height)
+    {
+        if (_surface)
+        {
+            CFRelease(_surface);
+        }
+        _surface = SyphonSurfaceCreate(width, height, _pixelFormat);
+        _pushPending = YES;
+        *isNew = YES;
+    }
+    if (_surface)
+    {
+        CFRetain(_surface);
+    }
+    return _surface;
+}
+
+- (void)publishWithFrameMetadata:(SyphonFrameMetadata)metadata
+{
+    if (_pushPending && _surface)
+    {
+        [_connectionManager setSurfaceID:IOSurfaceGetID(_surface)];
+        _pushPending = NO;
+    }
+    [_connectionManager publishNewFrameWithMetadata:SyphonFrameMetadataCreateData(&metadata, 0)];
+}
+
+- (void)stop
+{
+    [_connectionManager stop];
+}
+
+@end
@@ -0,0 +1,351 @@
+/*
+    SyphonSharedRegistry.c
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Declares shm_open(), kill() and friends when built as strict C11
+#define _POSIX_C_SOURCE 200809L
+
+#include "SyphonSharedRegistry.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SYPHON_REGISTRY_MAGIC 0x53795267U // 'SyRg'
+#define SYPHON_REGISTRY_VERSION 2U
+#define SYPHON_REGISTRY_READ_ATTEMPTS 8
+#define SYPHON_REGISTRY_INIT_WAIT_NS 1000000L // 1ms
+#define SYPHON_REGISTRY_INIT_WAITS 50 // how long a creator has to prepare the segment before it is taken over
+
+typedef struct SyphonRegistryRecord {
+    _Atomic uint32_t owner;     // pid of the owning process, 0 if free
+    _Atomic uint32_t sequence;  // odd while the record is being written
+    uint32_t length;
+    uint32_t reserved;
+    uint8_t data[SYPHON_REGISTRY_RECORD_SIZE];
+} SyphonRegistryRecord;
+
+typedef struct SyphonRegistryHeader {
+    _Atomic uint32_t magic;     // set last by the initializer, once the segment is sized
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t recordSize;
+    _Atomic uint32_t initializer; // pid of the process preparing the segment, 0 until one claims it
+    uint32_t reserved;
+    _Atomic uint64_t generation;
+    SyphonRegistryRecord records[SYPHON_REGISTRY_CAPACITY];
+} SyphonRegistryHeader;
+
+struct SyphonRegistry {
+    SyphonRegistryHeader *header;
+};
+
+static bool SyphonRegistryProcessIsAlive(uint32_t pid)
+{
+    // EPERM means the process exists but belongs to another user
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+}
+
+static void SyphonRegistryWait(void)
+{
+    struct timespec interval = {0, SYPHON_REGISTRY_INIT_WAIT_NS};
+    nanosleep(&interval, NULL);
+}
+
+/*
+ Waits for the segment to be sized, sizing it ourselves if its creator exited before it could.
+ Returns false if the segment can't be used.
+ */
+static bool SyphonRegistryWaitForSize(int fd, bool created)
+{
+    off_t size = (off_t)sizeof(SyphonRegistryHeader);
+    for (int wait = 0; ; wait++)
+    {
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            return false;
+        }
+        if (info.st_size >= size)
+        {
+            return true;
+        }
+        if (info.st_size != 0)
+        {
+            // A segment from an incompatible version
+            return false;
+        }
+        if (created || wait == SYPHON_REGISTRY_INIT_WAITS)
+        {
+            // Segments can only be sized once, so if this fails another process has just sized it
+            if (ftruncate(fd, size) == 0)
+            {
+                continue;
+            }
+            if (created)
+            {
+                return false;
+            }
+        }
+        else if (wait > SYPHON_REGISTRY_INIT_WAITS)
+        {
+            return false;
+        }
+        SyphonRegistryWait();
+    }
+}
+
+/*
+ Waits for the mapped segment to be initialized, initializing it ourselves if we created it or if the process
+ which claimed it exited before finishing. Returns false if the segment can't be used.
+ */
+static bool SyphonRegistryWaitForInitialization(SyphonRegistryHeader *header, bool created)
+{
+    uint32_t pid = (uint32_t)getpid();
+    for (int wait = 0; ; wait++)
+    {
+        if (atomic_load_explicit(&header->magic, memory_order_acquire) == SYPHON_REGISTRY_MAGIC)
+        {
+            return header->version == SYPHON_REGISTRY_VERSION
+                && header->capacity == SYPHON_REGISTRY_CAPACITY
+                && header->recordSize == SYPHON_REGISTRY_RECORD_SIZE;
+        }
+        // An unclaimed segment is only taken over once its creator has had time to claim it
+        uint32_t initializer = atomic_load(&header->initializer);
+        bool abandoned = initializer != 0 ? !SyphonRegistryProcessIsAlive(initializer) : (created || wait >= SYPHON_REGISTRY_INIT_WAITS);
+        if (abandoned && atomic_compare_exchange_strong(&header->initializer, &initializer, pid))
+        {
+            // No records are written before the magic is set, so only the header needs preparing
+            header->version = SYPHON_REGISTRY_VERSION;
+            header->capacity = SYPHON_REGISTRY_CAPACITY;
+            header->recordSize = SYPHON_REGISTRY_RECORD_SIZE;
+            atomic_store_explicit(&header->magic, SYPHON_REGISTRY_MAGIC, memory_order_release);
+            continue;
+        }
+        if (wait >= SYPHON_REGISTRY_INIT_WAITS * 2)
+        {
+            // A live process is taking too long, so try again later
+            return false;
+        }
+        SyphonRegistryWait();
+    }
+}
+
+SyphonRegistryRef SyphonRegistryOpen(const char *name)
+{
+    size_t size = sizeof(SyphonRegistryHeader);
+    bool created = true;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd == -1 && errno == EEXIST)
+    {
+        created = false;
+        fd = shm_open(name, O_RDWR, 0);
+    }
+    if (fd == -1)
+    {
+        return NULL;
+    }
+    // A creator which exits part way leaves the segment for the next process to finish, rather than
+    // unlinking it, which could race with another process recreating it
+    if (!SyphonRegistryWaitForSize(fd, created))
+    {
+        if (created)
+        {
+            shm_unlink(name);
+        }
+        close(fd);
+        return NULL;
+    }
+    SyphonRegistryHeader *header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if (!SyphonRegistryWaitForInitialization(header, created))
+    {
+        munmap(header, size);
+        return NULL;
+    }
+    SyphonRegistryRef registry = malloc(sizeof(struct SyphonRegistry));
+    if (registry == NULL)
+    {
+        munmap(header, size);
+        return NULL;
+    }
+    registry->header = header;
+    return registry;
+}
+
+void SyphonRegistryClose(SyphonRegistryRef registry)
+{
+    if (registry)
+    {
+        munmap(registry->header, sizeof(SyphonRegistryHeader));
+        free(registry);
+    }
+}
+
+static void SyphonRegistryWrite(SyphonRegistryHeader *header, SyphonRegistryRecord *record, const void *data, uint32_t length)
+{
+    // A writer which died part way leaves the sequence odd, so start from the next odd value
+    // rather than assuming it's even, which would leave torn data with an even sequence
+    uint32_t sequence = atomic_load_explicit(&record->sequence, memory_order_relaxed) | 1;
+    atomic_store_explicit(&record->sequence, sequence, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    record->length = length;
+    if (length)
+    {
+        memcpy(record->data, data, length);
+    }
+    atomic_store_explicit(&record->sequence, sequence + 1, memory_order_release);
+    atomic_fetch_add_explicit(&header->generation, 1, memory_order_release);
+}
+
+int32_t SyphonRegistryAdd(SyphonRegistryRef registry, const void *data, uint32_t length)
+{
+    if (registry == NULL || length > SYPHON_REGISTRY_RECORD_SIZE)
+    {
+        return -1;
+    }
+    uint32_t pid = (uint32_t)getpid();
+    for (int32_t i = 0; i < SYPHON_REGISTRY_CAPACITY; i++)
+    {
+        SyphonRegistryRecord *record = &registry->header->records[i];
+        uint32_t expected = 0;
+        if (atomic_compare_exchange_strong(&record->owner, &expected, pid))
+        {
+            SyphonRegistryWrite(registry->header, record, data, length);
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool SyphonRegistryUpdate(SyphonRegistryRef registry, int32_t index, const void *data, uint32_t length)
+{
+    if (registry == NULL || index < 0 || index >= SYPHON_REGISTRY_CAPACITY || length > SYPHON_REGISTRY_RECORD_SIZE)
+    {
+        return false;
+    }
+    SyphonRegistryRecord *record = &registry->header->records[index];
+    if (atomic_load(&record->owner) != (uint32_t)getpid())
+    {
+        return false;
+    }
+    SyphonRegistryWrite(registry->header, record, data, length);
+    return true;
+}
+
+static void SyphonRegistryRelease(SyphonRegistryHeader *header, SyphonRegistryRecord *record, uint32_t owner)
+{
+    // Empty the record before freeing it, so readers never see the old data as a new owner's
+    SyphonRegistryWrite(header, record, NULL, 0);
+    atomic_compare_exchange_strong(&record->owner, &owner, 0);
+}
+
+void SyphonRegistryRemove(SyphonRegistryRef registry, int32_t index)
+{
+    if (registry && index >= 0 && index < SYPHON_REGISTRY_CAPACITY)
+    {
+        SyphonRegistryRecord *record = &registry->header->records[index];
+        uint32_t pid = (uint32_t)getpid();
+        if (atomic_load(&record->owner) == pid)
+        {
+            SyphonRegistryRelease(registry->header, record, pid);
+        }
+    }
+}
+
+uint32_t SyphonRegistryVisit(SyphonRegistryRef registry, SyphonRegistryVisitor visitor, void *context)
+{
+    if (registry == NULL)
+    {
+        return 0;
+    }
+    uint32_t visited = 0;
+    uint8_t buffer[SYPHON_REGISTRY_RECORD_SIZE];
+    for (int32_t i = 0; i < SYPHON_REGISTRY_CAPACITY; i++)
+    {
+        SyphonRegistryRecord *record = &registry->header->records[i];
+        uint32_t owner = atomic_load(&record->owner);
+        if (owner == 0)
+        {
+            continue;
+        }
+        if (!SyphonRegistryProcessIsAlive(owner))
+        {
+            // The owner crashed or exited without removing its record
+            uint32_t expected = owner;
+            if (atomic_compare_exchange_strong(&record->owner, &expected, (uint32_t)getpid()))
+            {
+                SyphonRegistryRelease(registry->header, record, (uint32_t)getpid());
+            }
+            continue;
+        }
+        for (int attempt = 0; attempt < SYPHON_REGISTRY_READ_ATTEMPTS; attempt++)
+        {
+            uint32_t before = atomic_load_explicit(&record->sequence, memory_order_acquire);
+            if (before & 1)
+            {
+                continue;
+            }
+            uint32_t length = record->length;
+            if (length > SYPHON_REGISTRY_RECORD_SIZE)
+            {
+                continue;
+            }
+            memcpy(buffer, record->data, length);
+            atomic_thread_fence(memory_order_acquire);
+            uint32_t after = atomic_load_explicit(&record->sequence, memory_order_relaxed);
+            if (before == after)
+            {
+                if (length)
+                {
+                    visitor(buffer, length, context);
+                    visited++;
+                }
+                break;
+            }
+        }
+    }
+    return visited;
+}
+
+uint64_t SyphonRegistryGetGeneration(SyphonRegistryRef registry)
+{
+    return registry ? atomic_load_explicit(&registry->header->generation, memory_order_acquire) : 0;
+}
@@ -0,0 +1,107 @@
+/*
+    SyphonSharedRegistry.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+/*
+ Syphon Shared Registry is a table of server records in a named POSIX shared-memory segment, so that a process
+ can find every running server without waiting for them to answer a discovery request.
+
+ - Records are fixed-size, opaque to the registry, and written and read without locks: each has a sequence number
+   which is odd while the record is being written, so readers can retry torn reads
+ - Each record belongs to the process which registered it, and records of processes which have exited are reclaimed
+ - A segment whose creator exited before preparing it is prepared by the next process to open it
+ - Any failure (eg the segment can't be created in a sandbox) leaves the registry unavailable, and callers should
+   fall back to notifications
+
+ The registry uses only POSIX and C11 atomics.
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYPHON_REGISTRY_NAME "/info.v002.Syphon.registry"
+#define SYPHON_REGISTRY_CAPACITY 256
+#define SYPHON_REGISTRY_RECORD_SIZE 1024
+
+/*
+ SyphonRegistryRef
+	Opaque reference to an open registry.
+ */
+typedef struct SyphonRegistry *SyphonRegistryRef;
+
+/*
+ SyphonRegistryOpen
+	Opens the registry with the given name, creating it if necessary. May wait briefly for another process
+	which is creating it. Returns NULL on failure, which may be temporary.
+ */
+SyphonRegistryRef SyphonRegistryOpen(const char *name);
+
+/*
+ SyphonRegistryClose
+	Closes the registry. Records registered through it are not removed.
+ */
+void SyphonRegistryClose(SyphonRegistryRef registry);
+
+/*
+ SyphonRegistryAdd
+	Claims a record for the calling process and writes data to it. Returns the index of the record,
+	or -1 if the registry is full or length exceeds SYPHON_REGISTRY_RECORD_SIZE.
+ */
+int32_t SyphonRegistryAdd(SyphonRegistryRef registry, const void *data, uint32_t length);
+
+/*
+ SyphonRegistryUpdate
+	Replaces the data of a record previously returned by SyphonRegistryAdd(). Returns false on failure.
+ */
+bool SyphonRegistryUpdate(SyphonRegistryRef registry, int32_t index, const void *data, uint32_t length);
+
+/*
+ SyphonRegistryRemove
+	Releases a record previously returned by SyphonRegistryAdd().
+ */
+void SyphonRegistryRemove(SyphonRegistryRef registry, int32_t index);
+
+/*
+ SyphonRegistryVisitor
+	Invoked with a consistent copy of a record's data. The data is only valid for the duration of the call.
+ */
+typedef void (*SyphonRegistryVisitor)(const void *data, uint32_t length, void *context);
+
+/*
+ SyphonRegistryVisit
+	Invokes visitor for every record belonging to a running process, reclaiming any records belonging to
+	processes which have exited. Returns the number of records visited.
+ */
+uint32_t SyphonRegistryVisit(SyphonRegistryRef registry, SyphonRegistryVisitor visitor, void *context);
+
+/*
+ SyphonRegistryGetGeneration
+	Returns a number which changes whenever a record is added, updated or removed.
+ */
+uint64_t SyphonRegistryGetGeneration(SyphonRegistryRef registry);
@@ -0,0 +1,180 @@
+/*
+    SyphonSharedRegistryTests.c
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ Standalone checks of the shared registry, including processes which exit part way through using it.
+ The registry is included directly so the checks can reach its records. Builds on macOS or Linux:
+
+    cc -std=c11 -Wall -Wextra -o registry-tests SyphonSharedRegistryTests.c && ./registry-tests
+
+ (older Linux C libraries also need -lrt). Exits with a non-zero status if a check fails.
+*/
+
+#include "SyphonSharedRegistry.c"
+#include <stdio.h>
+#include <sys/wait.h>
+
+#define SYPHON_REGISTRY_TEST_NAME "/info.v002.Syphon.registry.test"
+
+static int failures = 0;
+
+#define CHECK(condition) do { if (!(condition)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); failures++; } } while (0)
+
+typedef struct {
+    uint32_t count;
+    bool found;
+    const char *wanted;
+} SyphonRegistryTestVisit;
+
+static void SyphonRegistryTestVisitor(const void *data, uint32_t length, void *context)
+{
+    SyphonRegistryTestVisit *visit = context;
+    visit->count++;
+    if (visit->wanted && length == strlen(visit->wanted) && memcmp(data, visit->wanted, length) == 0)
+    {
+        visit->found = true;
+    }
+}
+
+static SyphonRegistryTestVisit SyphonRegistryTestVisitFor(SyphonRegistryRef registry, const char *wanted)
+{
+    SyphonRegistryTestVisit visit = {0, false, wanted};
+    SyphonRegistryVisit(registry, SyphonRegistryTestVisitor, &visit);
+    return visit;
+}
+
+// Runs body in a child process which exits without cleaning up, and waits for it
+#define IN_EXITING_CHILD(body) do { pid_t child = fork(); if (child == 0) { body; _exit(0); } waitpid(child, NULL, 0); } while (0)
+
+static void TestAddUpdateRemove(void)
+{
+    SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+    CHECK(registry != NULL);
+    uint64_t generation = SyphonRegistryGetGeneration(registry);
+    int32_t index = SyphonRegistryAdd(registry, "first", 5);
+    CHECK(index >= 0);
+    CHECK(SyphonRegistryGetGeneration(registry) != generation);
+    CHECK(SyphonRegistryTestVisitFor(registry, "first").found);
+    CHECK(SyphonRegistryUpdate(registry, index, "second", 6));
+    SyphonRegistryTestVisit visit = SyphonRegistryTestVisitFor(registry, "second");
+    CHECK(visit.found && visit.count == 1);
+    CHECK(SyphonRegistryAdd(registry, "x", SYPHON_REGISTRY_RECORD_SIZE + 1) == -1);
+    SyphonRegistryRemove(registry, index);
+    CHECK(SyphonRegistryTestVisitFor(registry, NULL).count == 0);
+    SyphonRegistryClose(registry);
+}
+
+static void TestOwnerExitsWithoutRemoving(void)
+{
+    IN_EXITING_CHILD({
+        SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+        SyphonRegistryAdd(registry, "orphan", 6);
+    });
+    SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+    CHECK(registry != NULL);
+    CHECK(SyphonRegistryTestVisitFor(registry, NULL).count == 0);
+    for (int32_t i = 0; i < SYPHON_REGISTRY_CAPACITY; i++)
+    {
+        CHECK(atomic_load(&registry->header->records[i].owner) == 0);
+    }
+    SyphonRegistryClose(registry);
+}
+
+static void TestOwnerExitsWhileWriting(void)
+{
+    IN_EXITING_CHILD({
+        SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+        int32_t index = SyphonRegistryAdd(registry, "complete", 8);
+        // Stop part way through an update, as SyphonRegistryWrite() would if the process were killed
+        SyphonRegistryRecord *record = &registry->header->records[index];
+        atomic_store(&record->sequence, atomic_load(&record->sequence) + 1);
+        memcpy(record->data, "torn", 4);
+    });
+    SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+    CHECK(registry != NULL);
+    // Reclaims the record
+    CHECK(SyphonRegistryTestVisitFor(registry, NULL).count == 0);
+    for (int32_t i = 0; i < SYPHON_REGISTRY_CAPACITY; i++)
+    {
+        CHECK((atomic_load(&registry->header->records[i].sequence) & 1) == 0);
+    }
+    // The reclaimed record is reused, and is visible once written
+    int32_t index = SyphonRegistryAdd(registry, "again", 5);
+    CHECK(index >= 0);
+    SyphonRegistryTestVisit visit = SyphonRegistryTestVisitFor(registry, "again");
+    CHECK(visit.found && visit.count == 1);
+    SyphonRegistryRemove(registry, index);
+    SyphonRegistryClose(registry);
+}
+
+static void TestCreatorExitsBeforeSizing(void)
+{
+    shm_unlink(SYPHON_REGISTRY_TEST_NAME);
+    IN_EXITING_CHILD({
+        shm_open(SYPHON_REGISTRY_TEST_NAME, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    });
+    SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+    CHECK(registry != NULL);
+    SyphonRegistryClose(registry);
+}
+
+static void TestCreatorExitsBeforeInitializing(void)
+{
+    shm_unlink(SYPHON_REGISTRY_TEST_NAME);
+    IN_EXITING_CHILD({
+        int fd = shm_open(SYPHON_REGISTRY_TEST_NAME, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if (ftruncate(fd, sizeof(SyphonRegistryHeader)) == 0)
+        {
+            SyphonRegistryHeader *header = mmap(NULL, sizeof(SyphonRegistryHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            atomic_store(&header->initializer, (uint32_t)getpid());
+        }
+    });
+    SyphonRegistryRef registry = SyphonRegistryOpen(SYPHON_REGISTRY_TEST_NAME);
+    CHECK(registry != NULL);
+    CHECK(SyphonRegistryAdd(registry, "usable", 6) >= 0);
+    SyphonRegistryClose(registry);
+}
+
+int main(void)
+{
+    shm_unlink(SYPHON_REGISTRY_TEST_NAME);
+    TestAddUpdateRemove();
+    TestOwnerExitsWithoutRemoving();
+    TestOwnerExitsWhileWriting();
+    TestCreatorExitsBeforeSizing();
+    TestCreatorExitsBeforeInitializing();
+    shm_unlink(SYPHON_REGISTRY_TEST_NAME);
+    if (failures)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    printf("All registry checks passed\n");
+    return 0;
+}
@@ -35,7 +35,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface SyphonServerBase (SyphonSubclassing)
 /*!
- Subclasses call this to obtain a new IOSurface to draw to. The surface will always be in a BGRA8 format, other formats are not currently supported.
+ Subclasses call this to obtain a new IOSurface to draw to. The surface will always be in the server's pixelFormat. If the server has several surfaces (see SyphonServerOptionSurfaceCount), each call moves to the next of them, which holds an earlier frame and must be drawn in full. Only subclasses which return YES from +drawsEachFrameToNewSurface have several surfaces.
  @param width the width of the IOSurface in pixels
  @param height the height of the IOSurface in pixels
  @param options currently ignored, pass nil
@@ -43,16 +43,40 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable IOSurfaceRef)newSurfaceForWidth:(size_t)width height:(size_t)height options:(nullable NSDictionary<NSString *, id> *)options;
 
+/*!
+ Subclasses of servers with several streams (see SyphonServerOptionStreamNames) call this to obtain a new IOSurface to draw each stream to. Stream 0 is the surface returned by -newSurfaceForWidth:height:options:. Each stream's surface will always be in the server's pixelFormat. Clients see the surfaces of every stream when the next frame is published.
+ @param stream the index of the stream in the server's streamNames
+ @param width the width of the IOSurface in pixels
+ @param height the height of the IOSurface in pixels
+ @returns an existing or new IOSurface sized for the given dimensions - to be released by the caller using CFRelease
+ */
+- (nullable IOSurfaceRef)newSurfaceForStream:(NSUInteger)stream width:(size_t)width height:(size_t)height;
+
+/*!
+ Subclasses which call -newSurfaceForWidth:height:options: for every frame override this to return YES, so they may use several surfaces (see SyphonServerOptionSurfaceCount). SyphonServerBase's implementation returns NO, in which case the server uses one surface whatever its options.
+ */
++ (BOOL)drawsEachFrameToNewSurface;
+
 /*!
  Subclasses may call this to release any current IOSurface
  */
 - (void)destroySurface;
 
 /*!
- Subclasses call this to have the server publish a new frame once the subclass has updated the IOSurface.
+ Subclasses call this to have the server publish a new frame once the subclass has updated the IOSurface. This is equivalent to calling -publishWithFrameMetadata: with the result of -metadataForNewFrame.
  */
 - (void)publish;
 
+/*!
+ Subclasses which complete frames asynchronously call this when a frame is submitted to claim any capture time, user data and content version set for it. Each call consumes the values set by -setNextFrameCaptureTime:userData: and -setNextFrameContentVersion:. The sequence number is left zero: it is assigned when the frame is published, so that frames which aren't published leave no gap. Every frame claimed must be passed to -publishWithFrameMetadata:, in the order claimed, as servers in a SyphonServerPublishGroup wait for frames they have claimed.
+ */
+- (SyphonFrameMetadata)metadataForNewFrame;
+
+/*!
+ Subclasses call this in place of -publish to publish a frame with metadata previously obtained from -metadataForNewFrame. The sequence number and publish time are set for you.
+ */
+- (void)publishWithFrameMetadata:(SyphonFrameMetadata)metadata;
+
 @end
 
 @interface SyphonClientBase (SyphonSubclassing)
@@ -69,11 +93,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)updateFrameID;
 
+/*!
+ Subclasses which support servers with several streams use this method in place of -newSurface to acquire an IOSurface for each stream (see -streamNames), all from the same frame. Subclasses may consider the returned values valid until the next call to -invalidateFrame.
+
+ @param surfaces An array of count IOSurfaceRefs, which on return holds the surface for each stream in order, or NULL for a stream without one. YOU ARE RESPONSIBLE FOR RELEASING EACH SURFACE using CFRelease() when you are finished with it.
+ @param count The number of surfaces to return.
+ @returns The number of streams for which surfaces were returned. Servers with one stream return one.
+ */
+- (NSUInteger)getRetainedSurfaces:(IOSurfaceRef _Nullable * _Nonnull)surfaces count:(NSUInteger)count;
+
+/*!
+ Subclasses which support a frame history (see SyphonClientOptionFrameHistoryLength) use this method in place of -newSurface to acquire the IOSurface of the frame to present at a given time, chosen from the history. Without a history, this returns the same surface as -newSurface. After this method returns, -frameMetadata describes the frame chosen.
+
+ @param time The time the frame will be presented, on the clock used by SyphonFrameTimestampNow().
+ @returns A retained IOSurfaceRef, or NULL if none is available. YOU ARE RESPONSIBLE FOR RELEASING THIS OBJECT using CFRelease() when you are finished with it.
+ */
+- (nullable IOSurfaceRef)newSurfaceForPresentationTime:(uint64_t)time;
+
 /*!
  Subclasses override this method to invalidate their output when the server's surface backing changes. Do not call this method directly -
  it will be called for you when necessary.
  */
 - (void)invalidateFrame;
+
+/*!
+ Subclasses override this method to list the pixel formats (as NSNumbers with SyphonPixelFormat values) they are able to present. SyphonClientBase's implementation returns SyphonPixelFormatBGRA8 only. A client can only be created for a server which publishes a format listed here.
+ */
++ (NSArray<NSNumber *> *)supportedPixelFormats;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,77 @@
+/*
+    SyphonSurfacePool.h
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import <Foundation/Foundation.h>
+#import <IOSurface/IOSurface.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*
+ SyphonSurfacePool
+
+ Keeps a small number of recently-used IOSurfaces so a server which changes frame size can switch back to a
+ previous size without calling IOSurfaceCreate() on its publishing thread. Surfaces are matched by their dimensions
+ and pixel format, and the least-recently-used surface is released when the pool exceeds its capacity.
+
+ Surfaces can be allocated ahead of need on a background queue using -prepareSurfaceForWidth:height:.
+
+ Thread-safe.
+ */
+
+@interface SyphonSurfacePool : NSObject
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+/*
+ - (IOSurfaceRef)newSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format
+
+ Returns a surface with the given dimensions and format, removing it from the pool if a matching surface is present
+ and otherwise creating a new one. The caller is responsible for releasing the result.
+ */
+- (nullable IOSurfaceRef)newSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format;
+/*
+ - (void)recycleSurface:(IOSurfaceRef)surface
+
+ Returns a surface to the pool for later reuse. The pool takes its own reference to the surface.
+ */
+- (void)recycleSurface:(IOSurfaceRef)surface;
+/*
+ - (void)prepareSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format
+
+ Allocates a surface with the given dimensions and format on a background queue and adds it to the pool,
+ unless a matching surface is already present or being prepared.
+ */
+- (void)prepareSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format;
+/*
+ - (void)drain
+
+ Releases every surface in the pool. Surfaces being prepared in the background when this is called are discarded.
+ */
+- (void)drain;
+@end
+
+NS_ASSUME_NONNULL_END
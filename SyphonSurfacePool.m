@@ -0,0 +1,172 @@
+/*
+    SyphonSurfacePool.m
+    Syphon
+
+    Copyright 2026 bangnoise (Tom Butterworth) & vade (Anton Marini).
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+    ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+    WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+    (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+    ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+    SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#import "SyphonSurfacePool.h"
+#import "SyphonPrivate.h"
+#import <os/lock.h>
+
+#define kSyphonSurfacePoolDefaultCapacity 2U
+
+static BOOL SyphonSurfacePoolSurfaceMatches(IOSurfaceRef surface, size_t width, size_t height, OSType format)
+{
+    return IOSurfaceGetWidth(surface) == width
+    && IOSurfaceGetHeight(surface) == height
+    && IOSurfaceGetPixelFormat(surface) == format ? YES : NO;
+}
+
+@implementation SyphonSurfacePool
+{
+    os_unfair_lock _lock;
+    NSUInteger _capacity;
+    // Ordered least- to most-recently used
+    NSMutableArray *_surfaces;
+    NSCountedSet<NSString *> *_pending;
+    // Incremented by -drain so late background allocations are discarded
+    NSUInteger _generation;
+}
+
+- (instancetype)init
+{
+    return [self initWithCapacity:kSyphonSurfacePoolDefaultCapacity];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    self = [super init];
+    if (self)
+    {
+        _lock = OS_UNFAIR_LOCK_INIT;
+        _capacity = capacity;
+        _surfaces = [[NSMutableArray alloc] initWithCapacity:capacity + 1];
+        _pending = [[NSCountedSet alloc] initWithCapacity:1];
+    }
+    return self;
+}
+
+- (NSUInteger)indexOfSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format
+{
+    // The pool is always small, so a reverse scan finds the most recently used match cheaply
+    for (NSUInteger i = _surfaces.count; i > 0; i--)
+    {
+        if (SyphonSurfacePoolSurfaceMatches((__bridge IOSurfaceRef)_surfaces[i - 1], width, height, format))
+        {
+            return i - 1;
+        }
+    }
+    return NSNotFound;
+}
+
+- (IOSurfaceRef)newSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format
+{
+    IOSurfaceRef surface = NULL;
+    os_unfair_lock_lock(&_lock);
+    NSUInteger index = [self indexOfSurfaceForWidth:width height:height pixelFormat:format];
+    if (index != NSNotFound)
+    {
+        surface = (IOSurfaceRef)CFRetain((__bridge IOSurfaceRef)_surfaces[index]);
+        [_surfaces removeObjectAtIndex:index];
+    }
+    os_unfair_lock_unlock(&_lock);
+    if (surface == NULL)
+    {
+        surface = SyphonSurfaceCreate(width, height, format);
+    }
+    return surface;
+}
+
+- (void)recycleSurface:(IOSurfaceRef)surface
+{
+    if (surface == NULL)
+    {
+        return;
+    }
+    NSArray *evicted = nil;
+    os_unfair_lock_lock(&_lock);
+    [_surfaces addObject:(__bridge id)surface];
+    if (_surfaces.count > _capacity)
+    {
+        NSRange range = NSMakeRange(0, _surfaces.count - _capacity);
+        evicted = [_surfaces subarrayWithRange:range];
+        [_surfaces removeObjectsInRange:range];
+    }
+    os_unfair_lock_unlock(&_lock);
+    // Release evicted surfaces outside the lock
+    evicted = nil;
+}
+
+- (void)prepareSurfaceForWidth:(size_t)width height:(size_t)height pixelFormat:(OSType)format
+{
+    if (width == 0 || height == 0)
+    {
+        return;
+    }
+    NSString *key = [NSString stringWithFormat:@"%zux%zu:%u", width, height, (unsigned int)format];
+    NSUInteger generation;
+    os_unfair_lock_lock(&_lock);
+    BOOL needed = [_pending countForObject:key] == 0 && [self indexOfSurfaceForWidth:width height:height pixelFormat:format] == NSNotFound;
+    if (needed)
+    {
+        [_pending addObject:key];
+    }
+    generation = _generation;
+    os_unfair_lock_unlock(&_lock);
+
+    if (needed)
+    {
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            IOSurfaceRef surface = SyphonSurfaceCreate(width, height, format);
+            os_unfair_lock_lock(&self->_lock);
+            [self->_pending removeObject:key];
+            BOOL current = generation == self->_generation;
+            os_unfair_lock_unlock(&self->_lock);
+            if (surface)
+            {
+                if (current)
+                {
+                    [self recycleSurface:surface];
+                }
+                CFRelease(surface);
+            }
+        });
+    }
+}
+
+- (void)drain
+{
+    NSArray *released;
+    os_unfair_lock_lock(&_lock);
+    released = [_surfaces copy];
+    [_surfaces removeAllObjects];
+    _generation++;
+    os_unfair_lock_unlock(&_lock);
+    // Release surfaces outside the lock
+    released = nil;
+}
+
+@end